@@ -0,0 +1,262 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQLiteArrayFunction.h"
+#include "IncludeSQLite.h"
+
+#include "Containers/StringConv.h"
+#include "Serialization/MemoryWriter.h"
+
+FSQLiteArrayBinding::FSQLiteArrayBinding(TConstArrayView<int64> InValues)
+	: ValueType(EValueType::Integer)
+	, NumValues(InValues.Num())
+	, IntegerValues(InValues)
+{
+}
+
+FSQLiteArrayBinding::FSQLiteArrayBinding(TConstArrayView<FString> InValues)
+	: ValueType(EValueType::Text)
+	, NumValues(InValues.Num())
+{
+	ValueOffsets.Reserve(NumValues + 1);
+	for (const FString& Value : InValues)
+	{
+		ValueOffsets.Add(ValueData.Num());
+
+		const FTCHARToUTF8 ValueUTF8(*Value, Value.Len());
+		ValueData.Append((const uint8*)ValueUTF8.Get(), ValueUTF8.Length());
+	}
+	ValueOffsets.Add(ValueData.Num());
+}
+
+FSQLiteArrayBinding::FSQLiteArrayBinding(TConstArrayView<FGuid> InValues)
+	: ValueType(EValueType::Blob)
+	, NumValues(InValues.Num())
+{
+	// Each GUID is serialized the same way as a single bound FGuid, so that they compare equal to the stored values
+	FMemoryWriter GuidWriter(ValueData);
+	ValueOffsets.Reserve(NumValues + 1);
+	for (const FGuid& Value : InValues)
+	{
+		ValueOffsets.Add(ValueData.Num());
+		GuidWriter << const_cast<FGuid&>(Value);
+	}
+	ValueOffsets.Add(ValueData.Num());
+}
+
+void FSQLiteArrayBinding::Destroy(void* InArrayBinding)
+{
+	delete (FSQLiteArrayBinding*)InArrayBinding;
+}
+
+/**
+ * Cursor used to walk the values of an array.
+ * @note SQLite allocates and frees these via xOpen and xClose, and relies on sqlite3_vtab_cursor being the first member.
+ */
+struct FSQLiteArrayCursor
+{
+	sqlite3_vtab_cursor Base;
+	const FSQLiteArrayBinding* ArrayBinding;
+	int32 ValueIndex;
+};
+
+/**
+ * Virtual table methods for the carray function (see sqlite3_module).
+ * The function is eponymous-only (ie, it always exists, and can't be created as a table).
+ */
+struct FSQLiteArrayFunctionFuncs
+{
+	/** Column indices of the virtual table */
+	enum EColumn
+	{
+		Column_Value = 0,
+		Column_Pointer = 1,
+	};
+
+	/** Index plan numbers returned by BestIndex */
+	enum EIndexPlan
+	{
+		IndexPlan_Empty = 0,
+		IndexPlan_Array = 1,
+	};
+
+	static int Connect(sqlite3* InDatabase, void* InAux, int InArgc, const char* const* InArgv, sqlite3_vtab** OutVTab, char** OutError)
+	{
+		// The hidden pointer column is what the function argument is bound to
+		const int Result = sqlite3_declare_vtab(InDatabase, "CREATE TABLE x(value, pointer HIDDEN)");
+		if (Result != SQLITE_OK)
+		{
+			return Result;
+		}
+
+		sqlite3_vtab* VTab = (sqlite3_vtab*)sqlite3_malloc(sizeof(sqlite3_vtab));
+		if (!VTab)
+		{
+			return SQLITE_NOMEM;
+		}
+		FMemory::Memzero(VTab, sizeof(sqlite3_vtab));
+
+		sqlite3_vtab_config(InDatabase, SQLITE_VTAB_INNOCUOUS);
+
+		*OutVTab = VTab;
+		return SQLITE_OK;
+	}
+
+	static int Disconnect(sqlite3_vtab* InVTab)
+	{
+		sqlite3_free(InVTab);
+		return SQLITE_OK;
+	}
+
+	static int BestIndex(sqlite3_vtab* InVTab, sqlite3_index_info* InOutIndexInfo)
+	{
+		for (int ConstraintIndex = 0; ConstraintIndex < InOutIndexInfo->nConstraint; ++ConstraintIndex)
+		{
+			const sqlite3_index_info::sqlite3_index_constraint& Constraint = InOutIndexInfo->aConstraint[ConstraintIndex];
+			if (Constraint.iColumn == Column_Pointer && Constraint.op == SQLITE_INDEX_CONSTRAINT_EQ)
+			{
+				if (!Constraint.usable)
+				{
+					// The array argument exists, but isn't available for this plan, so steer SQLite towards a plan where it is
+					return SQLITE_CONSTRAINT;
+				}
+
+				InOutIndexInfo->aConstraintUsage[ConstraintIndex].argvIndex = 1;
+				InOutIndexInfo->aConstraintUsage[ConstraintIndex].omit = 1;
+				InOutIndexInfo->idxNum = IndexPlan_Array;
+				InOutIndexInfo->estimatedCost = 1.0;
+				InOutIndexInfo->estimatedRows = 100;
+				return SQLITE_OK;
+			}
+		}
+
+		// Without an array argument the function returns no rows
+		InOutIndexInfo->idxNum = IndexPlan_Empty;
+		InOutIndexInfo->estimatedCost = 2147483647.0;
+		InOutIndexInfo->estimatedRows = 2147483647;
+		return SQLITE_OK;
+	}
+
+	static int OpenCursor(sqlite3_vtab* InVTab, sqlite3_vtab_cursor** OutCursor)
+	{
+		FSQLiteArrayCursor* Cursor = (FSQLiteArrayCursor*)sqlite3_malloc(sizeof(FSQLiteArrayCursor));
+		if (!Cursor)
+		{
+			return SQLITE_NOMEM;
+		}
+		FMemory::Memzero(Cursor, sizeof(FSQLiteArrayCursor));
+
+		*OutCursor = &Cursor->Base;
+		return SQLITE_OK;
+	}
+
+	static int CloseCursor(sqlite3_vtab_cursor* InCursor)
+	{
+		sqlite3_free(InCursor);
+		return SQLITE_OK;
+	}
+
+	static int Filter(sqlite3_vtab_cursor* InCursor, int InIndexNum, const char* InIndexStr, int InArgc, sqlite3_value** InArgv)
+	{
+		FSQLiteArrayCursor* Cursor = (FSQLiteArrayCursor*)InCursor;
+
+		// Anything other than an array bound via SetBindingArrayByIndex (eg, NULL, or a plain value) yields no rows
+		Cursor->ArrayBinding = InIndexNum == IndexPlan_Array && InArgc == 1
+			? (const FSQLiteArrayBinding*)sqlite3_value_pointer(InArgv[0], FSQLiteArrayBinding::PointerType)
+			: nullptr;
+		Cursor->ValueIndex = 0;
+
+		return SQLITE_OK;
+	}
+
+	static int Next(sqlite3_vtab_cursor* InCursor)
+	{
+		FSQLiteArrayCursor* Cursor = (FSQLiteArrayCursor*)InCursor;
+		++Cursor->ValueIndex;
+		return SQLITE_OK;
+	}
+
+	static int Eof(sqlite3_vtab_cursor* InCursor)
+	{
+		const FSQLiteArrayCursor* Cursor = (const FSQLiteArrayCursor*)InCursor;
+		return !Cursor->ArrayBinding || Cursor->ValueIndex >= Cursor->ArrayBinding->NumValues;
+	}
+
+	static int Column(sqlite3_vtab_cursor* InCursor, sqlite3_context* InContext, int InColumnIndex)
+	{
+		const FSQLiteArrayCursor* Cursor = (const FSQLiteArrayCursor*)InCursor;
+		if (InColumnIndex != Column_Value)
+		{
+			// The hidden pointer column is only used to receive the argument
+			sqlite3_result_null(InContext);
+			return SQLITE_OK;
+		}
+
+		// The array outlives the statement step, so values can be returned without SQLite taking a copy
+		const FSQLiteArrayBinding* ArrayBinding = Cursor->ArrayBinding;
+		const int32 ValueIndex = Cursor->ValueIndex;
+		switch (ArrayBinding->ValueType)
+		{
+		case FSQLiteArrayBinding::EValueType::Integer:
+			sqlite3_result_int64(InContext, ArrayBinding->IntegerValues[ValueIndex]);
+			break;
+
+		case FSQLiteArrayBinding::EValueType::Text:
+			sqlite3_result_text(InContext, (const char*)ArrayBinding->ValueData.GetData() + ArrayBinding->ValueOffsets[ValueIndex], ArrayBinding->ValueOffsets[ValueIndex + 1] - ArrayBinding->ValueOffsets[ValueIndex], SQLITE_STATIC);
+			break;
+
+		case FSQLiteArrayBinding::EValueType::Blob:
+			sqlite3_result_blob(InContext, ArrayBinding->ValueData.GetData() + ArrayBinding->ValueOffsets[ValueIndex], ArrayBinding->ValueOffsets[ValueIndex + 1] - ArrayBinding->ValueOffsets[ValueIndex], SQLITE_STATIC);
+			break;
+
+		default:
+			sqlite3_result_null(InContext);
+			break;
+		}
+
+		return SQLITE_OK;
+	}
+
+	static int RowId(sqlite3_vtab_cursor* InCursor, sqlite3_int64* OutRowId)
+	{
+		const FSQLiteArrayCursor* Cursor = (const FSQLiteArrayCursor*)InCursor;
+		*OutRowId = Cursor->ValueIndex + 1;
+		return SQLITE_OK;
+	}
+
+	static int RegisterWithConnection(sqlite3* InDatabase, char** OutError, const sqlite3_api_routines* InApi)
+	{
+		static const sqlite3_module ArrayFunctionModule = {
+			0,				// iVersion
+			nullptr,		// xCreate (eponymous-only)
+			&Connect,		// xConnect
+			&BestIndex,		// xBestIndex
+			&Disconnect,	// xDisconnect
+			nullptr,		// xDestroy (eponymous-only)
+			&OpenCursor,	// xOpen
+			&CloseCursor,	// xClose
+			&Filter,		// xFilter
+			&Next,			// xNext
+			&Eof,			// xEof
+			&Column,		// xColumn
+			&RowId,			// xRowid
+			nullptr,		// xUpdate
+			nullptr,		// xBegin
+			nullptr,		// xSync
+			nullptr,		// xCommit
+			nullptr,		// xRollback
+			nullptr,		// xFindFunction
+			nullptr,		// xRename
+			nullptr,		// xSavepoint
+			nullptr,		// xRelease
+			nullptr,		// xRollbackTo
+			nullptr,		// xShadowName
+		};
+
+		return sqlite3_create_module(InDatabase, "carray", &ArrayFunctionModule, nullptr);
+	}
+};
+
+void FSQLiteArrayFunction::Register()
+{
+	sqlite3_auto_extension((void(*)(void))&FSQLiteArrayFunctionFuncs::RegisterWithConnection);
+}
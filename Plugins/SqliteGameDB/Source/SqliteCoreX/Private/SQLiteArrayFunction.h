@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+#include "Containers/UnrealString.h"
+#include "Misc/Guid.h"
+
+/**
+ * An array of values bound to a single statement parameter, to be expanded into rows by the carray table-valued function.
+ * The values are converted into the form SQLite returns them in when the array is created, so the function can return each row without any conversion.
+ */
+struct FSQLiteArrayBinding
+{
+	/** Pointer type name used when binding an array to a parameter (see sqlite3_bind_pointer) */
+	static constexpr const char* PointerType = "ue_carray";
+
+	/** SQLite type of the values in the array */
+	enum class EValueType : uint8
+	{
+		Integer,
+		Text,
+		Blob,
+	};
+
+	explicit FSQLiteArrayBinding(TConstArrayView<int64> InValues);
+	explicit FSQLiteArrayBinding(TConstArrayView<FString> InValues);
+	explicit FSQLiteArrayBinding(TConstArrayView<FGuid> InValues);
+
+	/** Destructor passed to sqlite3_bind_pointer, so that SQLite can free the array once it's no longer bound */
+	static void Destroy(void* InArrayBinding);
+
+	/** Type of the values in the array */
+	EValueType ValueType;
+
+	/** Number of values in the array */
+	int32 NumValues = 0;
+
+	/** Values of an Integer array */
+	TArray<int64> IntegerValues;
+
+	/** Data of a Text (UTF-8) or Blob array, with each value found via ValueOffsets */
+	TArray<uint8> ValueData;
+
+	/** Offset of each value in ValueData, plus a final entry for the end of the data (so the size of value N is ValueOffsets[N+1] - ValueOffsets[N]) */
+	TArray<int32> ValueOffsets;
+};
+
+/**
+ * The carray table-valued function, which expands an array bound to a single parameter into one row per value.
+ * Usage: "SELECT * FROM Items WHERE Id IN carray(?1)", binding the array with FSQLitePreparedStatement::SetBindingArrayByIndex (or ByName).
+ */
+struct FSQLiteArrayFunction
+{
+	/** Register the function with every database connection that is opened - called from FSqliteCoreX::StaticInitializeSQLite, once SQLite is initialized */
+	static void Register();
+};
@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQLiteBlobArchive.h"
+#include "SQLiteDatabase.h"
+#include "IncludeSQLite.h"
+
+#include "Containers/StringConv.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSQLiteBlobArchive, Log, All);
+
+FSQLiteBlobArchive::FSQLiteBlobArchive(FSQLiteDatabase& InDatabase, const TCHAR* InTableName, const TCHAR* InColumnName, const int64 InRowId, const bool bInIsSaving, const TCHAR* InSchemaName)
+	: RowId(InRowId)
+{
+	SetIsLoading(!bInIsSaving);
+	SetIsSaving(bInIsSaving);
+	SetIsPersistent(true);
+
+	if (!InDatabase.Database)
+	{
+		SetError();
+		return;
+	}
+
+	if (sqlite3_blob_open(InDatabase.Database, TCHAR_TO_UTF8(InSchemaName), TCHAR_TO_UTF8(InTableName), TCHAR_TO_UTF8(InColumnName), RowId, bInIsSaving ? 1 : 0, &Blob) != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteBlobArchive, Warning, TEXT("Failed to open blob '%s.%s' for row %lld: %s"), InTableName, InColumnName, RowId, *InDatabase.GetLastError());
+
+		// sqlite3_blob_open may still allocate a handle on failure, which must be closed
+		sqlite3_blob_close(Blob);
+		Blob = nullptr;
+		SetError();
+		return;
+	}
+
+	BlobSizeBytes = sqlite3_blob_bytes(Blob);
+}
+
+FSQLiteBlobArchive::~FSQLiteBlobArchive()
+{
+	Close();
+}
+
+bool FSQLiteBlobArchive::Reopen(const int64 InRowId)
+{
+	if (!Blob)
+	{
+		return false;
+	}
+
+	RowId = InRowId;
+	Offset = 0;
+	ClearError();
+
+	if (sqlite3_blob_reopen(Blob, RowId) != SQLITE_OK)
+	{
+		// The handle stays open (but aborted), so it can still be pointed at another row
+		BlobSizeBytes = 0;
+		SetError();
+		return false;
+	}
+
+	BlobSizeBytes = sqlite3_blob_bytes(Blob);
+	return true;
+}
+
+void FSQLiteBlobArchive::Serialize(void* Data, int64 Num)
+{
+	if (Num <= 0 || IsError())
+	{
+		return;
+	}
+
+	if (!Blob || Offset + Num > BlobSizeBytes)
+	{
+		if (!Blob)
+		{
+			UE_LOG(LogSQLiteBlobArchive, Error, TEXT("Attempted to serialize data using an invalid blob archive"));
+		}
+		else
+		{
+			UE_LOG(LogSQLiteBlobArchive, Error, TEXT("Attempted to serialize %lld bytes at offset %lld of a %lld byte blob (row %lld)"), Num, Offset, BlobSizeBytes, RowId);
+		}
+
+		if (IsLoading())
+		{
+			FMemory::Memzero(Data, Num);
+		}
+		SetError();
+		return;
+	}
+
+	// Blobs are limited to SQLITE_MAX_LENGTH, so the bounds check above guarantees that Num and Offset fit in an int
+	const int Result = IsLoading()
+		? sqlite3_blob_read(Blob, Data, (int)Num, (int)Offset)
+		: sqlite3_blob_write(Blob, Data, (int)Num, (int)Offset);
+
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteBlobArchive, Error, TEXT("Failed to %s %lld bytes at offset %lld of blob (row %lld): %s"), IsLoading() ? TEXT("read") : TEXT("write"), Num, Offset, RowId, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+
+		if (IsLoading())
+		{
+			FMemory::Memzero(Data, Num);
+		}
+		SetError();
+		return;
+	}
+
+	Offset += Num;
+}
+
+int64 FSQLiteBlobArchive::Tell()
+{
+	return Offset;
+}
+
+int64 FSQLiteBlobArchive::TotalSize()
+{
+	return BlobSizeBytes;
+}
+
+void FSQLiteBlobArchive::Seek(int64 InPos)
+{
+	if (InPos < 0 || InPos > BlobSizeBytes)
+	{
+		UE_LOG(LogSQLiteBlobArchive, Error, TEXT("Attempted to seek to offset %lld of a %lld byte blob (row %lld)"), InPos, BlobSizeBytes, RowId);
+		SetError();
+		return;
+	}
+
+	Offset = InPos;
+}
+
+bool FSQLiteBlobArchive::Close()
+{
+	if (Blob)
+	{
+		if (sqlite3_blob_close(Blob) != SQLITE_OK)
+		{
+			SetError();
+		}
+		Blob = nullptr;
+		BlobSizeBytes = 0;
+		Offset = 0;
+	}
+
+	return !IsError();
+}
+
+FString FSQLiteBlobArchive::GetArchiveName() const
+{
+	return FString::Printf(TEXT("FSQLiteBlobArchive (row %lld)"), RowId);
+}
@@ -6,13 +6,363 @@
 
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Templates/UniquePtr.h"
 #include "Misc/AssertionMacros.h"
 #include "Containers/StringConv.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogSQLiteDatabase, Log, All);
 
+namespace SQLiteDatabaseImpl
+{
+
+/** The default memory mapping limit for databases opened as ESQLiteDatabaseOpenMode::ReadOnly (see SetMemoryMapSizeLimit) */
+const int64 DefaultReadOnlyMemoryMapSizeLimit = 256 * 1024 * 1024;
+
+/** Get the sqlite3_open_v2 flags for the given threading mode */
+int32 ThreadingModeToOpenFlags(const ESQLiteDatabaseThreadingMode InThreadingMode)
+{
+	switch (InThreadingMode)
+	{
+	case ESQLiteDatabaseThreadingMode::MultiThread:
+		return SQLITE_OPEN_NOMUTEX;
+	case ESQLiteDatabaseThreadingMode::Serialized:
+		return SQLITE_OPEN_FULLMUTEX;
+	default:
+		checkf(false, TEXT("Unknown ESQLiteDatabaseThreadingMode!"));
+		break;
+	}
+	return SQLITE_OPEN_FULLMUTEX;
+}
+
+/** Get the sqlite3_create_function_v2 flags for the given function flags */
+int32 FunctionFlagsToCreateFlags(const ESQLiteFunctionFlags InFlags)
+{
+	int32 CreateFlags = 0;
+	if (EnumHasAnyFlags(InFlags, ESQLiteFunctionFlags::Deterministic))
+	{
+		CreateFlags |= SQLITE_DETERMINISTIC;
+	}
+	if (EnumHasAnyFlags(InFlags, ESQLiteFunctionFlags::DirectOnly))
+	{
+		CreateFlags |= SQLITE_DIRECTONLY;
+	}
+	if (EnumHasAnyFlags(InFlags, ESQLiteFunctionFlags::Innocuous))
+	{
+		CreateFlags |= SQLITE_INNOCUOUS;
+	}
+	return CreateFlags;
+}
+
+/** User data of a scalar function registered via RegisterScalarFunction */
+struct FScalarFunctionData
+{
+	TFunction<void(const FSQLiteFunctionArgs&, FSQLiteFunctionResult&)> Function;
+	bool bUseUTF16Text;
+};
+
+/** User data of an aggregate function registered via RegisterAggregateFunction */
+struct FAggregateFunctionData
+{
+	TFunction<TUniquePtr<ISQLiteAggregateState>()> CreateState;
+	bool bUseUTF16Text;
+};
+
+/** Callbacks given to sqlite3_create_function_v2 */
+struct FFunctionFuncs
+{
+	static void ScalarFunc(sqlite3_context* InContext, int InNumArgs, sqlite3_value** InArgs)
+	{
+		const FScalarFunctionData* FunctionData = (const FScalarFunctionData*)sqlite3_user_data(InContext);
+
+		FSQLiteFunctionArgs Args(InArgs, InNumArgs, FunctionData->bUseUTF16Text);
+		FSQLiteFunctionResult Result(InContext, FunctionData->bUseUTF16Text);
+		FunctionData->Function(Args, Result);
+	}
+
+	static void DestroyScalar(void* InFunctionData)
+	{
+		delete (FScalarFunctionData*)InFunctionData;
+	}
+
+	static void AggregateStep(sqlite3_context* InContext, int InNumArgs, sqlite3_value** InArgs)
+	{
+		const FAggregateFunctionData* FunctionData = (const FAggregateFunctionData*)sqlite3_user_data(InContext);
+
+		// The aggregate context is zeroed on allocation, and only holds a pointer to the state, as the state may not be trivially constructible
+		ISQLiteAggregateState** StatePtr = (ISQLiteAggregateState**)sqlite3_aggregate_context(InContext, sizeof(ISQLiteAggregateState*));
+		if (!StatePtr)
+		{
+			sqlite3_result_error_nomem(InContext);
+			return;
+		}
+		if (!*StatePtr)
+		{
+			*StatePtr = FunctionData->CreateState().Release();
+		}
+
+		FSQLiteFunctionArgs Args(InArgs, InNumArgs, FunctionData->bUseUTF16Text);
+		FSQLiteFunctionResult Result(InContext, FunctionData->bUseUTF16Text);
+		(*StatePtr)->Step(Args, Result);
+	}
+
+	static void AggregateFinal(sqlite3_context* InContext)
+	{
+		const FAggregateFunctionData* FunctionData = (const FAggregateFunctionData*)sqlite3_user_data(InContext);
+
+		// No aggregate context exists if no rows were stepped, in which case a fresh state provides the result
+		ISQLiteAggregateState** StatePtr = (ISQLiteAggregateState**)sqlite3_aggregate_context(InContext, 0);
+		TUniquePtr<ISQLiteAggregateState> State(StatePtr ? *StatePtr : nullptr);
+		if (!State)
+		{
+			State = FunctionData->CreateState();
+		}
+
+		FSQLiteFunctionResult Result(InContext, FunctionData->bUseUTF16Text);
+		State->Final(Result);
+	}
+
+	static void DestroyAggregate(void* InFunctionData)
+	{
+		delete (FAggregateFunctionData*)InFunctionData;
+	}
+};
+
+/** User data of a virtual table registered via RegisterVirtualTable */
+struct FVirtualTableData
+{
+	TSharedRef<ISQLiteVirtualTableSource> Source;
+	bool bUseUTF16Text;
+};
+
+/**
+ * Instance of a virtual table registered via RegisterVirtualTable.
+ * @note SQLite relies on sqlite3_vtab being the first member.
+ */
+struct FVirtualTable
+{
+	sqlite3_vtab Base;
+	const FVirtualTableData* TableData;
+};
+
+/**
+ * Cursor used to walk the rows of a virtual table registered via RegisterVirtualTable.
+ * @note SQLite relies on sqlite3_vtab_cursor being the first member.
+ */
+struct FVirtualTableCursor
+{
+	sqlite3_vtab_cursor Base;
+	TArray<const void*> Rows;
+	int32 RowIndex = 0;
+
+	/** Number of key lookups made by this cursor, and the index built for them once there was more than one */
+	int32 NumKeyLookups = 0;
+	TUniquePtr<ISQLiteVirtualTableKeyIndex> KeyIndex;
+};
+
+/**
+ * Virtual table methods for tables registered via RegisterVirtualTable (see sqlite3_module).
+ * The tables are eponymous-only and read-only.
+ */
+struct FVirtualTableFuncs
+{
+	/** Index plan numbers returned by BestIndex */
+	enum EIndexPlan
+	{
+		IndexPlan_Scan = 0,
+		IndexPlan_Key = 1,
+	};
+
+	static int Connect(sqlite3* InDatabase, void* InAux, int InArgc, const char* const* InArgv, sqlite3_vtab** OutVTab, char** OutError)
+	{
+		const FVirtualTableData* TableData = (const FVirtualTableData*)InAux;
+
+		TArray<FString> ColumnDefs;
+		for (const FSQLiteVirtualTableColumn& Column : TableData->Source->GetColumns())
+		{
+			ColumnDefs.Add(FString::Printf(TEXT("\"%s\" %s"), *Column.Name.Replace(TEXT("\""), TEXT("\"\"")), *Column.Type));
+		}
+		if (ColumnDefs.Num() == 0)
+		{
+			*OutError = sqlite3_mprintf("virtual table has no columns");
+			return SQLITE_ERROR;
+		}
+
+		const FString TableDef = FString::Printf(TEXT("CREATE TABLE x(%s)"), *FString::Join(ColumnDefs, TEXT(", ")));
+		const int Result = sqlite3_declare_vtab(InDatabase, TCHAR_TO_UTF8(*TableDef));
+		if (Result != SQLITE_OK)
+		{
+			return Result;
+		}
+
+		FVirtualTable* VTab = new FVirtualTable();
+		FMemory::Memzero(&VTab->Base, sizeof(sqlite3_vtab));
+		VTab->TableData = TableData;
+
+		*OutVTab = &VTab->Base;
+		return SQLITE_OK;
+	}
+
+	static int Disconnect(sqlite3_vtab* InVTab)
+	{
+		delete (FVirtualTable*)InVTab;
+		return SQLITE_OK;
+	}
+
+	static int BestIndex(sqlite3_vtab* InVTab, sqlite3_index_info* InOutIndexInfo)
+	{
+		const FVirtualTable* VTab = (const FVirtualTable*)InVTab;
+		const int32 KeyColumnIndex = VTab->TableData->Source->GetKeyColumnIndex();
+
+		for (int ConstraintIndex = 0; ConstraintIndex < InOutIndexInfo->nConstraint; ++ConstraintIndex)
+		{
+			const sqlite3_index_info::sqlite3_index_constraint& Constraint = InOutIndexInfo->aConstraint[ConstraintIndex];
+			if (KeyColumnIndex != INDEX_NONE && Constraint.iColumn == KeyColumnIndex && Constraint.op == SQLITE_INDEX_CONSTRAINT_EQ && Constraint.usable)
+			{
+				// SQLite still tests the constraint, as the source may return more rows than match
+				InOutIndexInfo->aConstraintUsage[ConstraintIndex].argvIndex = 1;
+				InOutIndexInfo->aConstraintUsage[ConstraintIndex].omit = 0;
+				InOutIndexInfo->idxNum = IndexPlan_Key;
+				InOutIndexInfo->estimatedCost = 10.0;
+				InOutIndexInfo->estimatedRows = 1;
+				return SQLITE_OK;
+			}
+		}
+
+		InOutIndexInfo->idxNum = IndexPlan_Scan;
+		InOutIndexInfo->estimatedCost = 100000.0;
+		InOutIndexInfo->estimatedRows = 10000;
+		return SQLITE_OK;
+	}
+
+	static int OpenCursor(sqlite3_vtab* InVTab, sqlite3_vtab_cursor** OutCursor)
+	{
+		FVirtualTableCursor* Cursor = new FVirtualTableCursor();
+		FMemory::Memzero(&Cursor->Base, sizeof(sqlite3_vtab_cursor));
+
+		*OutCursor = &Cursor->Base;
+		return SQLITE_OK;
+	}
+
+	static int CloseCursor(sqlite3_vtab_cursor* InCursor)
+	{
+		delete (FVirtualTableCursor*)InCursor;
+		return SQLITE_OK;
+	}
+
+	static int Filter(sqlite3_vtab_cursor* InCursor, int InIndexNum, const char* InIndexStr, int InArgc, sqlite3_value** InArgv)
+	{
+		FVirtualTableCursor* Cursor = (FVirtualTableCursor*)InCursor;
+		const FVirtualTableData* TableData = ((const FVirtualTable*)InCursor->pVtab)->TableData;
+
+		Cursor->Rows.Reset();
+		Cursor->RowIndex = 0;
+
+		FString ReadError;
+		if (!TableData->Source->CanRead(ReadError))
+		{
+			sqlite3_free(InCursor->pVtab->zErrMsg);
+			InCursor->pVtab->zErrMsg = sqlite3_mprintf("%s", TCHAR_TO_UTF8(*ReadError));
+			return SQLITE_MISUSE;
+		}
+
+		if (InIndexNum == IndexPlan_Key && InArgc == 1)
+		{
+			// A single lookup (eg, WHERE Key = ?) isn't worth indexing, but a cursor that is filtered again is likely the inner table of a join
+			if (++Cursor->NumKeyLookups == 2)
+			{
+				Cursor->KeyIndex = TableData->Source->CreateKeyIndex();
+			}
+
+			const FSQLiteFunctionArgs Key(InArgv, InArgc, TableData->bUseUTF16Text);
+			if (Cursor->KeyIndex)
+			{
+				Cursor->KeyIndex->FindRows(Key, Cursor->Rows);
+			}
+			else
+			{
+				TableData->Source->FindRows(Key, Cursor->Rows);
+			}
+		}
+		else
+		{
+			TableData->Source->GetRows(Cursor->Rows);
+		}
+
+		return SQLITE_OK;
+	}
+
+	static int Next(sqlite3_vtab_cursor* InCursor)
+	{
+		FVirtualTableCursor* Cursor = (FVirtualTableCursor*)InCursor;
+		++Cursor->RowIndex;
+		return SQLITE_OK;
+	}
+
+	static int Eof(sqlite3_vtab_cursor* InCursor)
+	{
+		const FVirtualTableCursor* Cursor = (const FVirtualTableCursor*)InCursor;
+		return !Cursor->Rows.IsValidIndex(Cursor->RowIndex);
+	}
+
+	static int Column(sqlite3_vtab_cursor* InCursor, sqlite3_context* InContext, int InColumnIndex)
+	{
+		const FVirtualTableCursor* Cursor = (const FVirtualTableCursor*)InCursor;
+		const FVirtualTableData* TableData = ((const FVirtualTable*)InCursor->pVtab)->TableData;
+
+		FSQLiteFunctionResult Result(InContext, TableData->bUseUTF16Text);
+		TableData->Source->GetColumnValue(Cursor->Rows[Cursor->RowIndex], InColumnIndex, Result);
+		return SQLITE_OK;
+	}
+
+	static int RowId(sqlite3_vtab_cursor* InCursor, sqlite3_int64* OutRowId)
+	{
+		// Rows have no identity of their own, so the rowid is only stable for the duration of a single scan
+		const FVirtualTableCursor* Cursor = (const FVirtualTableCursor*)InCursor;
+		*OutRowId = Cursor->RowIndex + 1;
+		return SQLITE_OK;
+	}
+
+	static void DestroyTableData(void* InTableData)
+	{
+		delete (FVirtualTableData*)InTableData;
+	}
+
+	static const sqlite3_module Module;
+};
+
+const sqlite3_module FVirtualTableFuncs::Module = {
+	0,				// iVersion
+	nullptr,		// xCreate (eponymous-only)
+	&Connect,		// xConnect
+	&BestIndex,		// xBestIndex
+	&Disconnect,	// xDisconnect
+	nullptr,		// xDestroy (eponymous-only)
+	&OpenCursor,	// xOpen
+	&CloseCursor,	// xClose
+	&Filter,		// xFilter
+	&Next,			// xNext
+	&Eof,			// xEof
+	&Column,		// xColumn
+	&RowId,			// xRowid
+	nullptr,		// xUpdate (read-only)
+	nullptr,		// xBegin
+	nullptr,		// xSync
+	nullptr,		// xCommit
+	nullptr,		// xRollback
+	nullptr,		// xFindFunction
+	nullptr,		// xRename
+	nullptr,		// xSavepoint
+	nullptr,		// xRelease
+	nullptr,		// xRollbackTo
+	nullptr,		// xShadowName
+};
+
+} // namespace SQLiteDatabaseImpl
+
 FSQLiteDatabase::FSQLiteDatabase()
 	: Database(nullptr)
+	, TextEncoding(ESQLiteDatabaseTextEncoding::UTF8)
 {
 	// Ensure SQLite is initialized (as our module may not have loaded yet)
 	FSqliteCoreX::StaticInitializeSQLite();
@@ -25,8 +375,10 @@ FSQLiteDatabase::~FSQLiteDatabase()
 
 FSQLiteDatabase::FSQLiteDatabase(FSQLiteDatabase&& Other)
 	: Database(Other.Database)
+	, TextEncoding(Other.TextEncoding)
 {
 	Other.Database = nullptr;
+	Other.TextEncoding = ESQLiteDatabaseTextEncoding::UTF8;
 }
 
 FSQLiteDatabase& FSQLiteDatabase::operator=(FSQLiteDatabase&& Other)
@@ -37,6 +389,9 @@ FSQLiteDatabase& FSQLiteDatabase::operator=(FSQLiteDatabase&& Other)
 
 		Database = Other.Database;
 		Other.Database = nullptr;
+
+		TextEncoding = Other.TextEncoding;
+		Other.TextEncoding = ESQLiteDatabaseTextEncoding::UTF8;
 	}
 	return *this;
 }
@@ -46,7 +401,7 @@ bool FSQLiteDatabase::IsValid() const
 	return Database != nullptr;
 }
 
-bool FSQLiteDatabase::Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode)
+bool FSQLiteDatabase::Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode, const ESQLiteDatabaseThreadingMode InThreadingMode)
 {
 	if (Database)
 	{
@@ -67,6 +422,7 @@ bool FSQLiteDatabase::Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMod
 		break;
 	}
 	checkf(OpenFlags != 0, TEXT("SQLite open flags were zero! Unhandled ESQLiteDatabaseOpenMode?"));
+	OpenFlags |= SQLiteDatabaseImpl::ThreadingModeToOpenFlags(InThreadingMode);
 
 	if (OpenFlags & SQLITE_OPEN_CREATE)
 	{
@@ -87,6 +443,148 @@ bool FSQLiteDatabase::Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMod
 		return false;
 	}
 
+	CacheTextEncoding();
+
+	// Read-only databases can't be modified underneath the mapping, so let SQLite serve their pages straight from it
+	if (InOpenMode == ESQLiteDatabaseOpenMode::ReadOnly)
+	{
+		SetMemoryMapSizeLimit(SQLiteDatabaseImpl::DefaultReadOnlyMemoryMapSizeLimit);
+	}
+
+	return true;
+}
+
+bool FSQLiteDatabase::OpenFromMemory(TArrayView<const uint8> InDatabaseImage, const ESQLiteDatabaseOpenMode InOpenMode, const ESQLiteDatabaseThreadingMode InThreadingMode)
+{
+	if (Database)
+	{
+		return false;
+	}
+
+	// SQLite takes ownership of the image, so it needs to be allocated with its allocator
+	uint8* DatabaseImage = nullptr;
+	if (InDatabaseImage.Num() > 0)
+	{
+		DatabaseImage = (uint8*)sqlite3_malloc64(InDatabaseImage.Num());
+		if (!DatabaseImage)
+		{
+			return false;
+		}
+		FMemory::Memcpy(DatabaseImage, InDatabaseImage.GetData(), InDatabaseImage.Num());
+	}
+
+	return OpenDeserialized(DatabaseImage, InDatabaseImage.Num(), InOpenMode, InThreadingMode);
+}
+
+bool FSQLiteDatabase::OpenFileIntoMemory(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode, const ESQLiteDatabaseThreadingMode InThreadingMode)
+{
+	if (Database)
+	{
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(InFilename));
+	if (!FileHandle)
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to open database '%s' into memory: The file could not be opened for read"), InFilename);
+		return false;
+	}
+
+	// Read the whole file directly into the buffer that SQLite will take ownership of, to avoid a second copy
+	const int64 DatabaseImageSizeBytes = FileHandle->Size();
+	uint8* DatabaseImage = nullptr;
+	if (DatabaseImageSizeBytes > 0)
+	{
+		DatabaseImage = (uint8*)sqlite3_malloc64(DatabaseImageSizeBytes);
+		if (!DatabaseImage)
+		{
+			return false;
+		}
+
+		if (!FileHandle->Read(DatabaseImage, DatabaseImageSizeBytes))
+		{
+			UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to open database '%s' into memory: The file could not be read"), InFilename);
+			sqlite3_free(DatabaseImage);
+			return false;
+		}
+	}
+
+	return OpenDeserialized(DatabaseImage, DatabaseImageSizeBytes, InOpenMode, InThreadingMode);
+}
+
+bool FSQLiteDatabase::OpenDeserialized(uint8* InDatabaseImage, const int64 InDatabaseImageSizeBytes, const ESQLiteDatabaseOpenMode InOpenMode, const ESQLiteDatabaseThreadingMode InThreadingMode)
+{
+	check(!Database);
+
+	// An empty image is just an empty database, which is what opening ":memory:" gives us; as there is nothing to
+	// deserialize (and so no SQLITE_DESERIALIZE_READONLY), a read-only empty database must be opened read-only instead
+	const bool bReadOnlyEmpty = !InDatabaseImage && InOpenMode == ESQLiteDatabaseOpenMode::ReadOnly;
+	const int32 OpenFlags = (bReadOnlyEmpty ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) | SQLiteDatabaseImpl::ThreadingModeToOpenFlags(InThreadingMode);
+	if (sqlite3_open_v2(":memory:", &Database, OpenFlags, nullptr) != SQLITE_OK)
+	{
+		if (Database)
+		{
+			sqlite3_close(Database);
+			Database = nullptr;
+		}
+		sqlite3_free(InDatabaseImage);
+		return false;
+	}
+
+	if (!InDatabaseImage)
+	{
+		CacheTextEncoding();
+		return true;
+	}
+
+	uint32 DeserializeFlags = SQLITE_DESERIALIZE_FREEONCLOSE;
+	DeserializeFlags |= InOpenMode == ESQLiteDatabaseOpenMode::ReadOnly
+		? SQLITE_DESERIALIZE_READONLY
+		: SQLITE_DESERIALIZE_RESIZEABLE;
+
+	// Note: SQLite frees the image on failure as we passed SQLITE_DESERIALIZE_FREEONCLOSE
+	if (sqlite3_deserialize(Database, "main", InDatabaseImage, InDatabaseImageSizeBytes, InDatabaseImageSizeBytes, DeserializeFlags) != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to deserialize database: %s"), *GetLastError());
+
+		sqlite3_close(Database);
+		Database = nullptr;
+		return false;
+	}
+
+	CacheTextEncoding();
+
+	return true;
+}
+
+bool FSQLiteDatabase::Serialize(TArray<uint8>& OutDatabaseImage) const
+{
+	if (!Database)
+	{
+		return false;
+	}
+
+	// In-memory databases can give us direct access to their image, otherwise SQLite has to build us a copy
+	sqlite3_int64 DatabaseImageSizeBytes = 0;
+	if (const uint8* DatabaseImage = sqlite3_serialize(Database, "main", &DatabaseImageSizeBytes, SQLITE_SERIALIZE_NOCOPY))
+	{
+		OutDatabaseImage.Reset();
+		OutDatabaseImage.Append(DatabaseImage, DatabaseImageSizeBytes);
+		return true;
+	}
+
+	uint8* DatabaseImage = sqlite3_serialize(Database, "main", &DatabaseImageSizeBytes, 0);
+	if (!DatabaseImage)
+	{
+		return false;
+	}
+
+	OutDatabaseImage.Reset();
+	OutDatabaseImage.Append(DatabaseImage, DatabaseImageSizeBytes);
+	sqlite3_free(DatabaseImage);
+
 	return true;
 }
 
@@ -104,6 +602,7 @@ bool FSQLiteDatabase::Close()
 	}
 	
 	Database = nullptr;
+	TextEncoding = ESQLiteDatabaseTextEncoding::UTF8;
 	return true;
 }
 
@@ -145,6 +644,129 @@ bool FSQLiteDatabase::SetUserVersion(const int32 InUserVersion)
 	return Execute(*FString::Printf(TEXT("PRAGMA user_version = %d;"), InUserVersion));
 }
 
+bool FSQLiteDatabase::SetMemoryMapSizeLimit(const int64 InSizeBytes)
+{
+	return Execute(*FString::Printf(TEXT("PRAGMA mmap_size = %lld;"), InSizeBytes));
+}
+
+namespace SQLiteDatabaseImpl
+{
+
+const TCHAR* JournalModeToString(const ESQLiteDatabaseJournalMode InJournalMode)
+{
+	switch (InJournalMode)
+	{
+	case ESQLiteDatabaseJournalMode::Delete:
+		return TEXT("delete");
+	case ESQLiteDatabaseJournalMode::Truncate:
+		return TEXT("truncate");
+	case ESQLiteDatabaseJournalMode::Persist:
+		return TEXT("persist");
+	case ESQLiteDatabaseJournalMode::Memory:
+		return TEXT("memory");
+	case ESQLiteDatabaseJournalMode::WAL:
+		return TEXT("wal");
+	case ESQLiteDatabaseJournalMode::Off:
+		return TEXT("off");
+	default:
+		checkf(false, TEXT("Unhandled ESQLiteDatabaseJournalMode!"));
+		break;
+	}
+	return TEXT("");
+}
+
+bool JournalModeFromString(const FString& InJournalModeStr, ESQLiteDatabaseJournalMode& OutJournalMode)
+{
+	for (uint8 JournalModeIndex = (uint8)ESQLiteDatabaseJournalMode::Delete; JournalModeIndex <= (uint8)ESQLiteDatabaseJournalMode::Off; ++JournalModeIndex)
+	{
+		if (InJournalModeStr.Equals(JournalModeToString((ESQLiteDatabaseJournalMode)JournalModeIndex), ESearchCase::IgnoreCase))
+		{
+			OutJournalMode = (ESQLiteDatabaseJournalMode)JournalModeIndex;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TextEncodingFromString(const FString& InTextEncodingStr, ESQLiteDatabaseTextEncoding& OutTextEncoding)
+{
+	// SQLite reports the byte order of UTF-16 (eg, "UTF-16le"), but we only ever request the native byte order
+	if (InTextEncodingStr.Equals(TEXT("UTF-8"), ESearchCase::IgnoreCase))
+	{
+		OutTextEncoding = ESQLiteDatabaseTextEncoding::UTF8;
+		return true;
+	}
+	if (InTextEncodingStr.StartsWith(TEXT("UTF-16"), ESearchCase::IgnoreCase))
+	{
+		OutTextEncoding = ESQLiteDatabaseTextEncoding::UTF16;
+		return true;
+	}
+	return false;
+}
+
+} // namespace SQLiteDatabaseImpl
+
+bool FSQLiteDatabase::GetTextEncoding(ESQLiteDatabaseTextEncoding& OutTextEncoding) const
+{
+	FString TextEncodingStr;
+	const bool bSuccessful = const_cast<FSQLiteDatabase*>(this)->Execute(TEXT("PRAGMA encoding;"), [&TextEncodingStr](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, TextEncodingStr);
+		return ESQLitePreparedStatementExecuteRowResult::Stop;
+	}) == 1;
+
+	return bSuccessful && SQLiteDatabaseImpl::TextEncodingFromString(TextEncodingStr, OutTextEncoding);
+}
+
+bool FSQLiteDatabase::SetTextEncoding(const ESQLiteDatabaseTextEncoding InTextEncoding)
+{
+	// Setting the encoding is silently ignored once the database content exists, so read back the resulting encoding
+	const TCHAR* TextEncodingStr = InTextEncoding == ESQLiteDatabaseTextEncoding::UTF16 ? TEXT("UTF-16") : TEXT("UTF-8");
+	if (!Execute(*FString::Printf(TEXT("PRAGMA encoding = '%s';"), TextEncodingStr)))
+	{
+		return false;
+	}
+
+	CacheTextEncoding();
+	return TextEncoding == InTextEncoding;
+}
+
+void FSQLiteDatabase::CacheTextEncoding()
+{
+	ESQLiteDatabaseTextEncoding NewTextEncoding = ESQLiteDatabaseTextEncoding::UTF8;
+	if (!GetTextEncoding(NewTextEncoding))
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to get the text encoding of database '%s': %s"), *GetFilename(), *GetLastError());
+	}
+	TextEncoding = NewTextEncoding;
+}
+
+bool FSQLiteDatabase::GetJournalMode(ESQLiteDatabaseJournalMode& OutJournalMode) const
+{
+	FString JournalModeStr;
+	const bool bSuccessful = const_cast<FSQLiteDatabase*>(this)->Execute(TEXT("PRAGMA journal_mode;"), [&JournalModeStr](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, JournalModeStr);
+		return ESQLitePreparedStatementExecuteRowResult::Stop;
+	}) == 1;
+
+	return bSuccessful && SQLiteDatabaseImpl::JournalModeFromString(JournalModeStr, OutJournalMode);
+}
+
+bool FSQLiteDatabase::SetJournalMode(const ESQLiteDatabaseJournalMode InJournalMode)
+{
+	// Setting the journal mode returns the resulting mode, which will be the old mode if the change couldn't be made
+	FString JournalModeStr;
+	const bool bSuccessful = Execute(*FString::Printf(TEXT("PRAGMA journal_mode = %s;"), SQLiteDatabaseImpl::JournalModeToString(InJournalMode)), [&JournalModeStr](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, JournalModeStr);
+		return ESQLitePreparedStatementExecuteRowResult::Stop;
+	}) == 1;
+
+	ESQLiteDatabaseJournalMode NewJournalMode;
+	return bSuccessful && SQLiteDatabaseImpl::JournalModeFromString(JournalModeStr, NewJournalMode) && NewJournalMode == InJournalMode;
+}
+
 bool FSQLiteDatabase::Execute(const TCHAR* InStatement)
 {
 	if (!Database)
@@ -188,6 +810,93 @@ FSQLitePreparedStatement FSQLiteDatabase::PrepareStatement(const TCHAR* InStatem
 		: FSQLitePreparedStatement();
 }
 
+bool FSQLiteDatabase::RegisterScalarFunction(const TCHAR* InFunctionName, const int32 InNumArgs, const ESQLiteFunctionFlags InFlags, TFunction<void(const FSQLiteFunctionArgs&, FSQLiteFunctionResult&)> InFunction)
+{
+	if (!Database || !InFunction)
+	{
+		return false;
+	}
+
+	// Functions on UTF-16 databases receive and return text without it being transcoded to UTF-8
+	const bool bUseUTF16Text = !PLATFORM_TCHAR_IS_4_BYTES && TextEncoding == ESQLiteDatabaseTextEncoding::UTF16;
+
+	// SQLite takes ownership of the function data, and destroys it on failure, or once the function is replaced or the database is closed
+	SQLiteDatabaseImpl::FScalarFunctionData* FunctionData = new SQLiteDatabaseImpl::FScalarFunctionData{ MoveTemp(InFunction), bUseUTF16Text };
+	const int Result = sqlite3_create_function_v2(Database, TCHAR_TO_UTF8(InFunctionName), InNumArgs, (bUseUTF16Text ? SQLITE_UTF16 : SQLITE_UTF8) | SQLiteDatabaseImpl::FunctionFlagsToCreateFlags(InFlags), FunctionData,
+		&SQLiteDatabaseImpl::FFunctionFuncs::ScalarFunc, nullptr, nullptr, &SQLiteDatabaseImpl::FFunctionFuncs::DestroyScalar);
+
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to register SQL function '%s': %s"), InFunctionName, *GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool FSQLiteDatabase::RegisterAggregateFunction(const TCHAR* InFunctionName, const int32 InNumArgs, const ESQLiteFunctionFlags InFlags, TFunction<TUniquePtr<ISQLiteAggregateState>()> InCreateState)
+{
+	if (!Database || !InCreateState)
+	{
+		return false;
+	}
+
+	const bool bUseUTF16Text = !PLATFORM_TCHAR_IS_4_BYTES && TextEncoding == ESQLiteDatabaseTextEncoding::UTF16;
+
+	SQLiteDatabaseImpl::FAggregateFunctionData* FunctionData = new SQLiteDatabaseImpl::FAggregateFunctionData{ MoveTemp(InCreateState), bUseUTF16Text };
+	const int Result = sqlite3_create_function_v2(Database, TCHAR_TO_UTF8(InFunctionName), InNumArgs, (bUseUTF16Text ? SQLITE_UTF16 : SQLITE_UTF8) | SQLiteDatabaseImpl::FunctionFlagsToCreateFlags(InFlags), FunctionData,
+		nullptr, &SQLiteDatabaseImpl::FFunctionFuncs::AggregateStep, &SQLiteDatabaseImpl::FFunctionFuncs::AggregateFinal, &SQLiteDatabaseImpl::FFunctionFuncs::DestroyAggregate);
+
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to register SQL aggregate function '%s': %s"), InFunctionName, *GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool FSQLiteDatabase::UnregisterFunction(const TCHAR* InFunctionName, const int32 InNumArgs)
+{
+	if (!Database)
+	{
+		return false;
+	}
+
+	// Functions are registered for a single text encoding, so remove the function from every encoding
+	return sqlite3_create_function_v2(Database, TCHAR_TO_UTF8(InFunctionName), InNumArgs, SQLITE_ANY, nullptr, nullptr, nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool FSQLiteDatabase::RegisterVirtualTable(const TCHAR* InTableName, TSharedRef<ISQLiteVirtualTableSource> InSource)
+{
+	if (!Database)
+	{
+		return false;
+	}
+
+	const bool bUseUTF16Text = !PLATFORM_TCHAR_IS_4_BYTES && TextEncoding == ESQLiteDatabaseTextEncoding::UTF16;
+
+	// SQLite takes ownership of the table data, and destroys it on failure, or once the module is replaced or the database is closed
+	SQLiteDatabaseImpl::FVirtualTableData* TableData = new SQLiteDatabaseImpl::FVirtualTableData{ MoveTemp(InSource), bUseUTF16Text };
+	const int Result = sqlite3_create_module_v2(Database, TCHAR_TO_UTF8(InTableName), &SQLiteDatabaseImpl::FVirtualTableFuncs::Module, TableData, &SQLiteDatabaseImpl::FVirtualTableFuncs::DestroyTableData);
+
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSQLiteDatabase, Warning, TEXT("Failed to register SQL virtual table '%s': %s"), InTableName, *GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool FSQLiteDatabase::UnregisterVirtualTable(const TCHAR* InTableName)
+{
+	if (!Database)
+	{
+		return false;
+	}
+
+	// Registering a null module removes the existing module
+	return sqlite3_create_module_v2(Database, TCHAR_TO_UTF8(InTableName), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
 FString FSQLiteDatabase::GetLastError() const
 {
 	const char* ErrorStr = Database ? sqlite3_errmsg(Database) : nullptr;
@@ -208,6 +917,37 @@ int64 FSQLiteDatabase::GetLastInsertRowId() const
 //PRAGMA_DISABLE_OPTIMIZATION
 UE_DISABLE_OPTIMIZATION_SHIP
 
+bool FSQLiteDatabase::GetIoStats(TArray<FSQLiteIoStats>& OutIoStats) const
+{
+	OutIoStats.Reset();
+
+	TArray<FString> SchemaNames;
+	const bool bListedSchemas = const_cast<FSQLiteDatabase*>(this)->Execute(TEXT("PRAGMA database_list;"), [&SchemaNames](const FSQLitePreparedStatement& InStatement)
+	{
+		FString SchemaName;
+		InStatement.GetColumnValueByIndex(1, SchemaName);
+		SchemaNames.Add(MoveTemp(SchemaName));
+		return ESQLitePreparedStatementExecuteRowResult::Continue;
+	}) != INDEX_NONE;
+
+	if (!bListedSchemas)
+	{
+		return false;
+	}
+
+	// Ask the VFS for the counters of the file behind each schema; anything it doesn't know about (eg, in-memory databases) will fail this request
+	for (const FString& SchemaName : SchemaNames)
+	{
+		FSQLiteIoStats IoStats;
+		if (sqlite3_file_control(Database, TCHAR_TO_UTF8(*SchemaName), FSQLiteIoStats::FileControlOp, &IoStats) == SQLITE_OK)
+		{
+			OutIoStats.Add(MoveTemp(IoStats));
+		}
+	}
+
+	return true;
+}
+
 bool FSQLiteDatabase::PerformQuickIntegrityCheck() const
 {
 	bool OutIntegrityOk = true;
@@ -5,11 +5,20 @@
 #include "CoreTypes.h"
 #include "Misc/Paths.h"
 #include "Misc/ScopeLock.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Crc.h"
 #include "Math/RandomStream.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
 #include "HAL/PlatformFileManager.h"
 #include "HAL/PlatformFile.h"
-#include "Templates/Atomic.h"
+#include "Async/MappedFileHandle.h"
+#include "Templates/AlignmentTemplates.h"
+#include "Templates/UniquePtr.h"
+#include <atomic>
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "SQLiteIoStats.h"
 
 THIRD_PARTY_INCLUDES_START
 #include "sqlite/sqlite3.h"
@@ -79,21 +88,96 @@ private:
 	}
 };
 
-/** Unreal implementation of an SQLite mutex */
+/** Unreal implementation of an SQLite mutex (see FSQLiteRecursiveMutex and FSQLiteFastMutex, selected by SQLiteMutexId) */
 struct FSQLiteMutex
 {
-	FSQLiteMutex(int InSQLiteMutexId)
+	explicit FSQLiteMutex(int InSQLiteMutexId)
 		: SQLiteMutexId(InSQLiteMutexId)
 	{
 	}
 
-	FCriticalSection CriticalSection;
 	int SQLiteMutexId;
 #ifdef SQLITE_DEBUG
-	TAtomic<uint32> OwnerThreadId = (uint32)INDEX_NONE;
+	std::atomic<uint32> OwnerThreadId{ (uint32)INDEX_NONE };
 #endif
 };
 
+/** SQLite mutex that may be entered recursively (used for SQLITE_MUTEX_RECURSIVE and the static mutexes) */
+struct FSQLiteRecursiveMutex : public FSQLiteMutex
+{
+	using FSQLiteMutex::FSQLiteMutex;
+
+	FCriticalSection CriticalSection;
+};
+
+/**
+ * SQLite mutex that is never entered recursively, and is only ever held for a handful of instructions (used for SQLITE_MUTEX_FAST).
+ * This spins for a short while before parking the thread on an event, as it's almost never contended, and avoids the cost of the OS lock for the common uncontended case.
+ */
+struct FSQLiteFastMutex : public FSQLiteMutex
+{
+	explicit FSQLiteFastMutex(int InSQLiteMutexId)
+		: FSQLiteMutex(InSQLiteMutexId)
+		, WakeEvent(FPlatformProcess::GetSynchEventFromPool(/*bIsManualReset*/false))
+	{
+	}
+
+	~FSQLiteFastMutex()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	/** Number of times to spin on a contended lock before parking the thread until the owner releases it */
+	static constexpr int32 NumSpinsBeforeWait = 64;
+
+	void Lock()
+	{
+		for (int32 NumSpins = 0; NumSpins < NumSpinsBeforeWait; ++NumSpins)
+		{
+			if (TryLock())
+			{
+				return;
+			}
+
+			// Wait for the lock to look free before trying to take it again, so we don't keep invalidating the cache line of the owner
+			while (bIsLocked.load(std::memory_order_relaxed) && NumSpins < NumSpinsBeforeWait)
+			{
+				++NumSpins;
+			}
+		}
+
+		// Register as a waiter before the final attempt, so that an Unlock racing with it will either let it succeed or trigger the event
+		// The event is auto-reset, so a trigger that arrives before we wait on it isn't lost
+		++NumWaiters;
+		while (!TryLock())
+		{
+			WakeEvent->Wait();
+		}
+		--NumWaiters;
+	}
+
+	bool TryLock()
+	{
+		return !bIsLocked.exchange(true);
+	}
+
+	void Unlock()
+	{
+		bIsLocked = false;
+
+		// Wake a single waiter; if another thread takes the lock first, the waiter simply waits again and is woken by that thread's Unlock
+		if (NumWaiters.load() > 0)
+		{
+			WakeEvent->Trigger();
+		}
+	}
+
+private:
+	std::atomic<bool> bIsLocked{ false };
+	std::atomic<int32> NumWaiters{ 0 };
+	FEvent* WakeEvent;
+};
+
 /** Mutex functions used by SQLite (see sqlite3_mutex_methods) */
 struct FSQLiteMutexFuncs
 {
@@ -119,7 +203,7 @@ public:
 private:
 	/** Array of static mutexes used by SQLite */
 	static const int32 SQLiteStaticMutexArrayCount = 12;
-	static FSQLiteMutex* SQLiteStaticMutexArray[SQLiteStaticMutexArrayCount];
+	static FSQLiteRecursiveMutex* SQLiteStaticMutexArray[SQLiteStaticMutexArrayCount];
 
 	/** Initialize the mutex system */
 	static int Init()
@@ -127,7 +211,7 @@ private:
 		for (int32 SQLiteStaticMutexIndex = 0; SQLiteStaticMutexIndex < SQLiteStaticMutexArrayCount; ++SQLiteStaticMutexIndex)
 		{
 			check(!SQLiteStaticMutexArray[SQLiteStaticMutexIndex]);
-			SQLiteStaticMutexArray[SQLiteStaticMutexIndex] = new FSQLiteMutex(SQLiteStaticMutexIndex + 2);
+			SQLiteStaticMutexArray[SQLiteStaticMutexIndex] = new FSQLiteRecursiveMutex(SQLiteStaticMutexIndex + 2);
 		}
 
 		return SQLITE_OK;
@@ -149,19 +233,23 @@ private:
 	/** Allocate a mutex */
 	static sqlite3_mutex* Alloc(int InSQLiteMutexId)
 	{
-		if (InSQLiteMutexId == SQLITE_MUTEX_FAST || InSQLiteMutexId == SQLITE_MUTEX_RECURSIVE)
+		if (InSQLiteMutexId == SQLITE_MUTEX_FAST)
+		{
+			return (sqlite3_mutex*)static_cast<FSQLiteMutex*>(new FSQLiteFastMutex(InSQLiteMutexId));
+		}
+		else if (InSQLiteMutexId == SQLITE_MUTEX_RECURSIVE)
 		{
-			return (sqlite3_mutex*)new FSQLiteMutex(InSQLiteMutexId);
+			return (sqlite3_mutex*)static_cast<FSQLiteMutex*>(new FSQLiteRecursiveMutex(InSQLiteMutexId));
 		}
 		else
 		{
 			const int32 SQLiteStaticMutexIndex = InSQLiteMutexId - 2;
 			check(SQLiteStaticMutexIndex >= 0 && SQLiteStaticMutexIndex < SQLiteStaticMutexArrayCount);
 
-			FSQLiteMutex* SQLiteStaticMutex = SQLiteStaticMutexArray[SQLiteStaticMutexIndex];
+			FSQLiteRecursiveMutex* SQLiteStaticMutex = SQLiteStaticMutexArray[SQLiteStaticMutexIndex];
 			checkSlow(SQLiteStaticMutex->SQLiteMutexId == InSQLiteMutexId);
 
-			return (sqlite3_mutex*)SQLiteStaticMutex;
+			return (sqlite3_mutex*)static_cast<FSQLiteMutex*>(SQLiteStaticMutex);
 		}
 	}
 
@@ -171,9 +259,13 @@ private:
 		FSQLiteMutex* Mutex = (FSQLiteMutex*)InMutex;
 		check(Mutex);
 
-		if (Mutex->SQLiteMutexId == SQLITE_MUTEX_FAST || Mutex->SQLiteMutexId == SQLITE_MUTEX_RECURSIVE)
+		if (Mutex->SQLiteMutexId == SQLITE_MUTEX_FAST)
+		{
+			delete static_cast<FSQLiteFastMutex*>(Mutex);
+		}
+		else if (Mutex->SQLiteMutexId == SQLITE_MUTEX_RECURSIVE)
 		{
-			delete Mutex;
+			delete static_cast<FSQLiteRecursiveMutex*>(Mutex);
 		}
 	}
 
@@ -183,7 +275,14 @@ private:
 		FSQLiteMutex* Mutex = (FSQLiteMutex*)InMutex;
 		check(Mutex);
 
-		Mutex->CriticalSection.Lock();
+		if (Mutex->SQLiteMutexId == SQLITE_MUTEX_FAST)
+		{
+			static_cast<FSQLiteFastMutex*>(Mutex)->Lock();
+		}
+		else
+		{
+			static_cast<FSQLiteRecursiveMutex*>(Mutex)->CriticalSection.Lock();
+		}
 #ifdef SQLITE_DEBUG
 		Mutex->OwnerThreadId = FPlatformTLS::GetCurrentThreadId();
 #endif
@@ -195,7 +294,10 @@ private:
 		FSQLiteMutex* Mutex = (FSQLiteMutex*)InMutex;
 		check(Mutex);
 
-		if (Mutex->CriticalSection.TryLock())
+		const bool bLocked = Mutex->SQLiteMutexId == SQLITE_MUTEX_FAST
+			? static_cast<FSQLiteFastMutex*>(Mutex)->TryLock()
+			: static_cast<FSQLiteRecursiveMutex*>(Mutex)->CriticalSection.TryLock();
+		if (bLocked)
 		{
 #ifdef SQLITE_DEBUG
 			Mutex->OwnerThreadId = FPlatformTLS::GetCurrentThreadId();
@@ -211,10 +313,17 @@ private:
 		FSQLiteMutex* Mutex = (FSQLiteMutex*)InMutex;
 		check(Mutex);
 
-		Mutex->CriticalSection.Unlock();
 #ifdef SQLITE_DEBUG
 		Mutex->OwnerThreadId = (uint32)INDEX_NONE;
 #endif
+		if (Mutex->SQLiteMutexId == SQLITE_MUTEX_FAST)
+		{
+			static_cast<FSQLiteFastMutex*>(Mutex)->Unlock();
+		}
+		else
+		{
+			static_cast<FSQLiteRecursiveMutex*>(Mutex)->CriticalSection.Unlock();
+		}
 	}
 
 	/** Test whether a mutex returned by Alloc is held by the current thread (debug only) */
@@ -244,58 +353,381 @@ private:
 	}
 };
 
-FSQLiteMutex* FSQLiteMutexFuncs::SQLiteStaticMutexArray[FSQLiteMutexFuncs::SQLiteStaticMutexArrayCount] = { 0 };
+FSQLiteRecursiveMutex* FSQLiteMutexFuncs::SQLiteStaticMutexArray[FSQLiteMutexFuncs::SQLiteStaticMutexArrayCount] = { 0 };
+
+/** In-process implementation of the shared memory (wal-index) for a single database file, shared by every connection to that file */
+struct FSQLiteShmNode
+{
+	/** Canonical filename of the database file this shared memory belongs to */
+	FString CanonFilename;
+
+	/** Heap allocated regions of shared memory (all RegionSizeBytes in size) */
+	TArray<void*> Regions;
+	int32 RegionSizeBytes = 0;
+
+	/** Number of connections that currently have this shared memory mapped */
+	int32 RefCount = 0;
+
+	/** State of each shared memory lock slot: 0 = unlocked, >0 = number of shared holders, -1 = exclusively held */
+	int32 LockStates[SQLITE_SHM_NLOCK] = {};
+};
+
+DECLARE_CYCLE_STAT(TEXT("VFS Read"), STAT_SQLiteVFS_Read, STATGROUP_SqliteGameDB);
+DECLARE_CYCLE_STAT(TEXT("VFS Write"), STAT_SQLiteVFS_Write, STATGROUP_SqliteGameDB);
+DECLARE_CYCLE_STAT(TEXT("VFS Sync"), STAT_SQLiteVFS_Sync, STATGROUP_SqliteGameDB);
+DECLARE_CYCLE_STAT(TEXT("VFS Truncate"), STAT_SQLiteVFS_Truncate, STATGROUP_SqliteGameDB);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VFS Bytes Read"), STAT_SQLiteVFS_BytesRead, STATGROUP_SqliteGameDB);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VFS Bytes Written"), STAT_SQLiteVFS_BytesWritten, STATGROUP_SqliteGameDB);
+
+/** Live counterpart of FSQLiteIoOpStats, updated by every connection to a file (from any thread) */
+struct FSQLiteLiveIoOpStats
+{
+	std::atomic<uint64> NumOps{ 0 };
+	std::atomic<uint64> NumBytes{ 0 };
+	std::atomic<uint64> TotalCycles{ 0 };
+	std::atomic<uint64> LatencyHistogram[FSQLiteIoOpStats::NumLatencyBuckets] = {};
+
+	/** Record a single operation */
+	void Record(const uint64 InNumBytes, const uint64 InDurationCycles)
+	{
+		const int32 LatencyBucketIndex = FSQLiteIoOpStats::GetLatencyBucketIndex(FPlatformTime::ToSeconds64(InDurationCycles));
+		NumOps.fetch_add(1, std::memory_order_relaxed);
+		NumBytes.fetch_add(InNumBytes, std::memory_order_relaxed);
+		TotalCycles.fetch_add(InDurationCycles, std::memory_order_relaxed);
+		LatencyHistogram[LatencyBucketIndex].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/** Copy the current counters into the given stats; each counter is read atomically, but operations may be recorded between reading them */
+	void Snapshot(FSQLiteIoOpStats& OutOpStats) const
+	{
+		OutOpStats.NumOps = NumOps.load(std::memory_order_relaxed);
+		OutOpStats.NumBytes = NumBytes.load(std::memory_order_relaxed);
+		OutOpStats.TotalCycles = TotalCycles.load(std::memory_order_relaxed);
+		for (int32 BucketIndex = 0; BucketIndex < FSQLiteIoOpStats::NumLatencyBuckets; ++BucketIndex)
+		{
+			OutOpStats.LatencyHistogram[BucketIndex] = LatencyHistogram[BucketIndex].load(std::memory_order_relaxed);
+		}
+	}
+};
+
+/** Live counterpart of FSQLiteIoStats, shared by every connection to a database file */
+struct FSQLiteLiveIoStats
+{
+	FString Filename;
+
+	FSQLiteLiveIoOpStats Read;
+	FSQLiteLiveIoOpStats Write;
+	FSQLiteLiveIoOpStats Sync;
+	FSQLiteLiveIoOpStats Truncate;
+
+	/** Copy the current counters into the given stats */
+	void Snapshot(FSQLiteIoStats& OutIoStats) const
+	{
+		OutIoStats.Filename = Filename;
+		Read.Snapshot(OutIoStats.Read);
+		Write.Snapshot(OutIoStats.Write);
+		Sync.Snapshot(OutIoStats.Sync);
+		Truncate.Snapshot(OutIoStats.Truncate);
+	}
+};
+
+/** Records a single file operation into the given FSQLiteLiveIoOpStats (if any) when it goes out of scope */
+struct FSQLiteIoOpScope
+{
+	FSQLiteIoOpScope(FSQLiteLiveIoOpStats* InOpStats, const int64 InNumBytes)
+		: OpStats(InOpStats)
+		, NumBytes(InNumBytes)
+		, StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FSQLiteIoOpScope()
+	{
+		if (OpStats)
+		{
+			OpStats->Record((uint64)NumBytes, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	FSQLiteLiveIoOpStats* OpStats;
+	int64 NumBytes;
+	uint64 StartCycles;
+};
+
+/** In-process state for a single file, shared by every connection to that file */
+struct FSQLiteFileNode
+{
+	/** Canonical filename of the file this node belongs to */
+	FString CanonFilename;
+
+	/** Platform handle to the file; our HAL only allows a single writable handle per file, so every connection shares it */
+	IFileHandle* FileHandle = nullptr;
+
+	/** Serializes use of FileHandle between connections, as each read or write is a Seek followed by the operation itself */
+	FCriticalSection FileHandleSection;
+
+	/** Number of connections that currently have this file open */
+	int32 RefCount = 0;
+
+	/** Strongest SQLite lock (SQLITE_LOCK_*) held on this file by any connection, and the number of connections holding at least a SHARED lock */
+	int32 LockMode = SQLITE_LOCK_NONE;
+	int32 NumSharedLocks = 0;
+
+	/** Redo log used to make batch atomic writes atomic (if any have been committed), and whether it holds a batch that hasn't been synced to this file yet */
+	FString AtomicWriteLogFilename;
+	IFileHandle* AtomicWriteLogHandle = nullptr;
+	bool bAtomicWriteLogPending = false;
+
+	/**
+	 * Make the batch pending in the redo log (if any) durable in the file itself, and clear the redo log, so that it can never be replayed over anything written to the file after it.
+	 * This happens when SQLite syncs the file, but SQLite doesn't sync at all with PRAGMA synchronous=OFF, so it must also happen before anything else changes the file, and on close.
+	 * @note The caller must hold FileHandleSection (unless this is the last connection), and may skip flushing the file if it has just done so itself.
+	 */
+	bool RetireAtomicWriteLog(const bool bFlushFile)
+	{
+		if (!bAtomicWriteLogPending)
+		{
+			return true;
+		}
+
+		if (bFlushFile && !FileHandle->Flush(/*bFullFlush*/true))
+		{
+			return false;
+		}
+
+		// The log must stay pending until it's known to be empty on disk, otherwise a crash could replay it over newer writes
+		if (!AtomicWriteLogHandle->Truncate(0) || !AtomicWriteLogHandle->Flush(/*bFullFlush*/true))
+		{
+			return false;
+		}
+
+		bAtomicWriteLogPending = false;
+		return true;
+	}
+};
+
+/** Writes buffered between SQLITE_FCNTL_BEGIN_ATOMIC_WRITE and SQLITE_FCNTL_COMMIT_ATOMIC_WRITE, in the order they were made */
+struct FSQLiteAtomicWriteBatch
+{
+	struct FWrite
+	{
+		int64 OffsetBytes = 0;
+		TArray<uint8> Data;
+	};
+	TArray<FWrite> Writes;
+};
 
 /** Unreal implementation of an SQLite file (zeroed on init) */
 struct FSQLiteFile
 {
 	const sqlite3_io_methods* IOMethods;
+	FSQLiteFileNode* FileNode;
 	IFileHandle* FileHandle;
 	FString Filename;
 	int LockMode;
 	bool bDeleteOnClose;
 	bool bIsReadOnly;
+
+	/** Whether this file supports batch atomic writes (writable main databases only), and the batch currently being buffered (if any) */
+	bool bSupportsAtomicWriteBatch;
+	FSQLiteAtomicWriteBatch* AtomicWriteBatch;
+
+	/** I/O counters this file reports into (shared with the database it belongs to, for journals) */
+	FSQLiteLiveIoStats* IoStats;
+
+	/** Shared memory mapped by this connection (if any), and the shm locks it currently holds */
+	FSQLiteShmNode* ShmNode;
+	uint16 ShmSharedMask;
+	uint16 ShmExclusiveMask;
+
+	/** Read-only memory mapping of this file used to serve pages without a copy (if any), along with the mapping limit set by SQLite and the number of pages it currently has fetched */
+	IMappedFileHandle* MappedFileHandle;
+	IMappedFileRegion* MappedFileRegion;
+	sqlite3_int64 MmapSizeMax;
+	int32 NumOutstandingFetches;
+	bool bMappingUnavailable;
+
+	/** Usable size of the mapping, which is less than the mapped region once the file has been truncated while pages were still fetched */
+	int64 MappedSizeBytes;
+
+	/** Mapping limit set by SQLite while pages were still fetched, applied once the last of them is released (or -1 if none) */
+	sqlite3_int64 PendingMmapSizeMax;
+
+	/** Aligned read-ahead cache used for read-only files that can't be memory mapped (eg, files inside a Pak), along with the file range it currently holds */
+	uint8* ReadAheadBuffer;
+	int64 ReadAheadBufferSizeBytes;
+	int64 ReadAheadOffsetBytes;
+	int64 ReadAheadAmountBytes;
 	
-	static FCriticalSection CurrentlyOpenAsReadOnlySection;
-	static TSet<FString> CurrentlyOpenAsReadOnly;
-	static bool AllowOpenAsReadOnly(const TCHAR* InFilename);
-	static void CloseAsReadOnly(const TCHAR* InFilename);
+	static FCriticalSection FileNodesSection;
+	static TMap<FString, FSQLiteFileNode*> FileNodes;
+	static FSQLiteFileNode* AcquireFileNode(const TCHAR* InFilename, const bool bIsReadOnly);
+	static void ReleaseFileNode(FSQLiteFileNode* InFileNode);
+
+	static FCriticalSection IoStatsSection;
+	static TMap<FString, FSQLiteLiveIoStats*> IoStatsByFilename;
+	static FSQLiteLiveIoStats* FindOrAddIoStats(const FString& InFilename, const int InFlags);
+
+	static FCriticalSection ShmNodesSection;
+	static TMap<FString, FSQLiteShmNode*> ShmNodes;
+	static FSQLiteShmNode* AcquireShmNode(const TCHAR* InFilename);
+	static void ReleaseShmNode(FSQLiteShmNode* InShmNode);
 };
 
-FCriticalSection FSQLiteFile::CurrentlyOpenAsReadOnlySection;
-TSet<FString> FSQLiteFile::CurrentlyOpenAsReadOnly;
+FCriticalSection FSQLiteFile::FileNodesSection;
+TMap<FString, FSQLiteFileNode*> FSQLiteFile::FileNodes;
+
+FCriticalSection FSQLiteFile::IoStatsSection;
+TMap<FString, FSQLiteLiveIoStats*> FSQLiteFile::IoStatsByFilename;
 
-bool FSQLiteFile::AllowOpenAsReadOnly(const TCHAR* InFilename)
+FCriticalSection FSQLiteFile::ShmNodesSection;
+TMap<FString, FSQLiteShmNode*> FSQLiteFile::ShmNodes;
+
+FSQLiteFileNode* FSQLiteFile::AcquireFileNode(const TCHAR* InFilename, const bool bIsReadOnly)
 {
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 	FString CanonFilename = PlatformFile.GetFilenameOnDisk(InFilename);
 
-	// for consistency's sake we try our best to enforce only opening each file _once_
-	//  if we open for write we obtain a lock to the file, but not for read-only
-	//  instead implement a tracking list of files that have been opened
-	bool bIsAlreadyInSet = false;
-	FScopeLock Lock(&CurrentlyOpenAsReadOnlySection);
-	bool bAdded = CurrentlyOpenAsReadOnly.Add(CanonFilename, &bIsAlreadyInSet).IsValidId();
-	check(bAdded);
+	// Every connection to the same file within this process shares the same node (and handle), which is what lets them see each others locks
+	FScopeLock Lock(&FileNodesSection);
+	FSQLiteFileNode*& FileNode = FileNodes.FindOrAdd(CanonFilename);
+	if (!FileNode)
+	{
+		// The Unreal HAL doesn't support granular file locking, so we obtain a write handle to any writable file regardless of what SQLite asked for
+		// This prevents concurrent access from other processes, while connections within this process are arbitrated by the lock state of the node
+		// If the file is stored in a read-only way (Pak) then open it in read-only mode; this assumes there won't be any contention (it's impossible to open for write)
+		IFileHandle* FileHandle = bIsReadOnly
+			? PlatformFile.OpenRead(InFilename)
+			: PlatformFile.OpenWrite(InFilename, /*bAppend*/true, /*bAllowRead*/true);
+		if (!FileHandle)
+		{
+			FileNodes.Remove(CanonFilename);
+			return nullptr;
+		}
+
+		FileNode = new FSQLiteFileNode();
+		FileNode->CanonFilename = MoveTemp(CanonFilename);
+		FileNode->FileHandle = FileHandle;
+	}
+	++FileNode->RefCount;
+
+	return FileNode;
+}
+
+void FSQLiteFile::ReleaseFileNode(FSQLiteFileNode* InFileNode)
+{
+	FScopeLock Lock(&FileNodesSection);
+	check(InFileNode && InFileNode->RefCount > 0);
+	if (--InFileNode->RefCount == 0)
+	{
+		check(InFileNode->LockMode == SQLITE_LOCK_NONE && InFileNode->NumSharedLocks == 0);
+
+		// Once any pending batch is durable in the file the redo log is no longer needed; if that fails, the log must be kept so it can be recovered when the file is next opened
+		// (this is safe, as nothing can have been written to the file since the batch was committed, see RetireAtomicWriteLog)
+		if (InFileNode->AtomicWriteLogHandle)
+		{
+			InFileNode->RetireAtomicWriteLog(/*bFlushFile*/true);
+			delete InFileNode->AtomicWriteLogHandle;
+			if (!InFileNode->bAtomicWriteLogPending)
+			{
+				FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*InFileNode->AtomicWriteLogFilename);
+			}
+		}
+
+		// Deleting the handle instance closes the file
+		delete InFileNode->FileHandle;
+
+		FileNodes.Remove(InFileNode->CanonFilename);
+		delete InFileNode;
+	}
+}
+
+FSQLiteLiveIoStats* FSQLiteFile::FindOrAddIoStats(const FString& InFilename, const int InFlags)
+{
+	// Journals are attributed to the database they belong to, and temporary files are attributed together, which keeps the number of entries bounded
+	// SQLite derives journal names by appending to the database name it was given, so there's no need to canonicalize them
+	FString DatabaseFilename;
+	if (!(InFlags & (SQLITE_OPEN_DELETEONCLOSE | SQLITE_OPEN_TEMP_DB | SQLITE_OPEN_TEMP_JOURNAL | SQLITE_OPEN_SUBJOURNAL | SQLITE_OPEN_TRANSIENT_DB)))
+	{
+		DatabaseFilename = InFilename;
+		if (InFlags & SQLITE_OPEN_MAIN_JOURNAL)
+		{
+			DatabaseFilename.RemoveFromEnd(TEXT("-journal"));
+		}
+		else if (InFlags & SQLITE_OPEN_WAL)
+		{
+			DatabaseFilename.RemoveFromEnd(TEXT("-wal"));
+		}
+		else if (InFlags & SQLITE_OPEN_SUPER_JOURNAL)
+		{
+			// Super-journals are named "<database>-mj<random>"
+			const int32 SuffixIndex = DatabaseFilename.Find(TEXT("-mj"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+			if (SuffixIndex != INDEX_NONE)
+			{
+				DatabaseFilename.LeftInline(SuffixIndex);
+			}
+		}
+	}
+
+	// Entries are never removed, so the returned pointer remains valid for the lifetime of the process
+	FScopeLock Lock(&IoStatsSection);
+	FSQLiteLiveIoStats*& IoStats = IoStatsByFilename.FindOrAdd(DatabaseFilename);
+	if (!IoStats)
+	{
+		IoStats = new FSQLiteLiveIoStats();
+		IoStats->Filename = MoveTemp(DatabaseFilename);
+	}
 
-	// only succeed if we were the call to add it to the set
-	return !bIsAlreadyInSet;
+	return IoStats;
 }
 
-void FSQLiteFile::CloseAsReadOnly(const TCHAR* InFilename)
+FSQLiteShmNode* FSQLiteFile::AcquireShmNode(const TCHAR* InFilename)
 {
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 	FString CanonFilename = PlatformFile.GetFilenameOnDisk(InFilename);
-	FScopeLock Lock(&CurrentlyOpenAsReadOnlySection);
-	int32 NumRemoved = CurrentlyOpenAsReadOnly.Remove(CanonFilename);
-	check(NumRemoved > 0);
+
+	// Caller must hold ShmNodesSection
+	// Every connection to the same file within this process shares the same node, which is how readers and writers see each others wal-index
+	FSQLiteShmNode*& ShmNode = ShmNodes.FindOrAdd(CanonFilename);
+	if (!ShmNode)
+	{
+		ShmNode = new FSQLiteShmNode();
+		ShmNode->CanonFilename = MoveTemp(CanonFilename);
+	}
+	++ShmNode->RefCount;
+
+	return ShmNode;
+}
+
+void FSQLiteFile::ReleaseShmNode(FSQLiteShmNode* InShmNode)
+{
+	// Caller must hold ShmNodesSection
+	check(InShmNode && InShmNode->RefCount > 0);
+	if (--InShmNode->RefCount == 0)
+	{
+		for (void* Region : InShmNode->Regions)
+		{
+			FMemory::Free(Region);
+		}
+
+		ShmNodes.Remove(InShmNode->CanonFilename);
+		delete InShmNode;
+	}
 }
 
 /**
  * File functions used by SQLite (see sqlite3_io_methods and sqlite3_vfs)
  * @note We have to make some concessions for things not exposed in the Unreal HAL that will affect multi-process concurrency (single-process access is not affected):
- *   - We do not provide an implementation for shared memory (mmap) as not all platforms implement it (see MapNamedSharedMemoryRegion and UnmapNamedSharedMemoryRegion)
- *   - We do not provide an implementation for granular file locks as our HAL doesn't expose the concept; instead we always take a writable handle for all file opens to prevent concurrent writes
+ *   - We provide an in-process (heap backed) implementation of shared memory rather than an OS one, as not all platforms implement it (see MapNamedSharedMemoryRegion and UnmapNamedSharedMemoryRegion)
+ *     This is enough to allow WAL journaling between connections within this process, but not between processes
+ *   - We serve memory mapped pages (xFetch) via IMappedFileHandle where the platform file supports it, and fallback to regular reads where it doesn't (eg, files inside a Pak)
+ *   - Read, Write, Sync and Truncate are recorded per database file (see FSQLiteIoStats) and in STATGROUP_SqliteGameDB
+ *   - We provide batch atomic writes for writable main databases by buffering the batch, and committing it to a redo log before applying it to the file (see CommitAtomicWriteBatch)
+ *   - Read-only files that can't be memory mapped are read in whole blocks aligned to the Pak compression block size, so each compressed block is only decompressed once
+ *   - We provide an in-process implementation of the SHARED/RESERVED/PENDING/EXCLUSIVE file locks, as our HAL doesn't expose granular (byte-range) file locks
+ *     This allows multiple connections to the same file within this process (eg, readers on worker threads while the game thread writes), and they share a single file handle
+ *     To prevent concurrent writes from other processes, we always take a writable handle for writable files regardless of what SQLite asked for
  */
 struct FSQLiteFileFuncs
 {
@@ -336,7 +768,7 @@ private:
 	static int Open(sqlite3_vfs* InVFS, const char* InFilename, sqlite3_file* InFile, int InFlags, int* OutFlagsPtr)
 	{
 		static const sqlite3_io_methods FileFuncs = {
-			1,	/** Version 1, no shared memory support */
+			3,	/** Version 3, in-process shared memory and memory mapped I/O support */
 			&Close,
 			&Read,
 			&Write,
@@ -349,6 +781,12 @@ private:
 			&FileControl,
 			&SectorSize,
 			&DeviceCharacteristics,
+			&ShmMap,
+			&ShmLock,
+			&ShmBarrier,
+			&ShmUnmap,
+			&Fetch,
+			&Unfetch,
 		};
 
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
@@ -356,6 +794,7 @@ private:
 
 		// Zero the file descriptor so it has valid data for the early return cases
 		FMemory::Memzero(*File);
+		File->PendingMmapSizeMax = -1;
 
 		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 
@@ -386,36 +825,28 @@ private:
 		}
 
 		// Stat the file to fetch its write-ability.
+		// If we are unable to open for write, we can only open the file if we only require read access (or this is the main database, which SQLite can use read-only)
 		File->bIsReadOnly = PlatformFile.IsReadOnly(*File->Filename);
-		if (!File->bIsReadOnly)
-		{
-			// The Unreal HAL doesn't support granular file locking so we always obtain a write handle to any file regardless of what SQLite asked for
-			// This prevents concurrent access to the files and makes the locking operations a no-op (though we still track the requested lock mode)
-			File->FileHandle = PlatformFile.OpenWrite(*File->Filename, /*bAppend*/true, /*bAllowRead*/true);
-		}
-		else if (InFlags & SQLITE_OPEN_READONLY)
+		if (File->bIsReadOnly && !(InFlags & (SQLITE_OPEN_READONLY | SQLITE_OPEN_MAIN_DB)))
 		{
-			if (FSQLiteFile::AllowOpenAsReadOnly(*File->Filename))
-			{
-				// If we are unable to open for write, the file could be stored in a read-only way (Pak)
-				// If we only require read access, attempt to open the in read-only mode
-				// This assumes there won't be any contention (it's impossible to open for write)
-				File->FileHandle = PlatformFile.OpenRead(*File->Filename);
-
-				// Our open operation failed for a reason, make sure to keep bookkeeping up to date
-				if (!File->FileHandle)
-				{
-					FSQLiteFile::CloseAsReadOnly(*File->Filename);
-				}
-			}
+			return SQLITE_IOERR;
 		}
 
-		if (File->FileHandle)
+		File->FileNode = FSQLiteFile::AcquireFileNode(*File->Filename, File->bIsReadOnly);
+		if (!File->FileNode)
 		{
-			File->FileHandle->Seek(0);
+			return SQLITE_IOERR;
 		}
-		else
+		File->FileHandle = File->FileNode->FileHandle;
+		File->IoStats = FSQLiteFile::FindOrAddIoStats(File->Filename, InFlags);
+
+		// A batch atomic write may have been committed to the redo log, but not applied to the file, before we last closed it
+		File->bSupportsAtomicWriteBatch = !File->bIsReadOnly && (InFlags & SQLITE_OPEN_MAIN_DB);
+		if (File->bSupportsAtomicWriteBatch && !RecoverAtomicWriteLog(File))
 		{
+			FSQLiteFile::ReleaseFileNode(File->FileNode);
+			File->FileNode = nullptr;
+			File->FileHandle = nullptr;
 			return SQLITE_IOERR;
 		}
 
@@ -441,14 +872,30 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		// Make sure to bookeep our special read-only file list
-		if (File->bIsReadOnly)
+		// SQLite should have unmapped any shared memory already, but make sure we don't leak our reference to it
+		if (File->ShmNode)
 		{
-			FSQLiteFile::CloseAsReadOnly(*File->Filename);
+			ShmUnmap(InFile, 0);
 		}
 
-		// Deleting the handle instance closes the file
-		delete File->FileHandle;
+		// Release any memory mapping before the handle it was created from
+		File->NumOutstandingFetches = 0;
+		UnmapFile(File);
+
+		FMemory::Free(File->ReadAheadBuffer);
+		File->ReadAheadBuffer = nullptr;
+
+		// Any batch that wasn't committed is discarded
+		delete File->AtomicWriteBatch;
+		File->AtomicWriteBatch = nullptr;
+
+		// Don't leave other connections locked out by a lock we can no longer release
+		Unlock(InFile, SQLITE_LOCK_NONE);
+
+		// The file itself is closed once the last connection to it is closed
+		FSQLiteFile::ReleaseFileNode(File->FileNode);
+		File->FileNode = nullptr;
+		File->FileHandle = nullptr;
 
 		// Should we also delete it?
 		if (File->bDeleteOnClose)
@@ -466,9 +913,30 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
+		SCOPE_CYCLE_COUNTER(STAT_SQLiteVFS_Read);
+		INC_DWORD_STAT_BY(STAT_SQLiteVFS_BytesRead, InReadAmountBytes);
+		FSQLiteIoOpScope IoOpScope(&File->IoStats->Read, InReadAmountBytes);
+
+		// Read-only files can't change underneath the mapping, so serve the read straight from it when possible (within the limit set by SQLite)
+		if (File->bIsReadOnly && (File->MappedFileRegion || MapFile(File, FMath::Min<int64>(GetFileHandleSize(File), File->MmapSizeMax))))
+		{
+			if (InReadOffsetBytes + InReadAmountBytes <= File->MappedSizeBytes)
+			{
+				FMemory::Memcpy(OutBuffer, File->MappedFileRegion->GetMappedPtr() + InReadOffsetBytes, InReadAmountBytes);
+				return SQLITE_OK;
+			}
+		}
+
+		if (File->bIsReadOnly)
+		{
+			return ReadThroughReadAheadCache(File, (uint8*)OutBuffer, InReadAmountBytes, InReadOffsetBytes);
+		}
+
 		// Zero the buffer first in-case of a short read
 		FMemory::Memzero(OutBuffer, InReadAmountBytes);
 
+		FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+
 		if (!File->FileHandle->Seek(InReadOffsetBytes))
 		{
 			return SQLITE_IOERR_SEEK;
@@ -487,12 +955,102 @@ private:
 		return SQLITE_OK;
 	}
 
+	/** Size of the blocks read by ReadThroughReadAheadCache; this matches the default Pak compression block size */
+	static constexpr int64 ReadAheadBlockSizeBytes = 64 * 1024;
+
+	/** Read from a read-only file previously opened by Open, reading whole aligned blocks into the read-ahead cache and serving subsequent reads from it */
+	static int ReadThroughReadAheadCache(FSQLiteFile* File, uint8* OutBuffer, const int64 InReadAmountBytes, const int64 InReadOffsetBytes)
+	{
+		int64 ReadOffsetBytes = InReadOffsetBytes;
+		int64 ReadBytesRemaining = InReadAmountBytes;
+
+		while (ReadBytesRemaining > 0)
+		{
+			const bool bIsCached = ReadOffsetBytes >= File->ReadAheadOffsetBytes && ReadOffsetBytes < File->ReadAheadOffsetBytes + File->ReadAheadAmountBytes;
+			if (!bIsCached)
+			{
+				FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+
+				// Anything at or past the end of the file is a short read, and SQLite expects the rest of the buffer to be zeroed
+				const int64 FileSizeBytes = File->FileHandle->Size();
+				if (ReadOffsetBytes >= FileSizeBytes)
+				{
+					FMemory::Memzero(OutBuffer, ReadBytesRemaining);
+					return SQLITE_IOERR_SHORT_READ;
+				}
+
+				// Read enough whole blocks to cover the rest of the request with a single read (the last block may be partial)
+				const int64 BlockOffsetBytes = AlignDown(ReadOffsetBytes, ReadAheadBlockSizeBytes);
+				const int64 BlockAmountBytes = FMath::Min<int64>(Align(ReadOffsetBytes + ReadBytesRemaining, ReadAheadBlockSizeBytes), FileSizeBytes) - BlockOffsetBytes;
+
+				if (BlockAmountBytes > File->ReadAheadBufferSizeBytes)
+				{
+					File->ReadAheadBuffer = (uint8*)FMemory::Realloc(File->ReadAheadBuffer, BlockAmountBytes);
+					File->ReadAheadBufferSizeBytes = BlockAmountBytes;
+				}
+
+				// Invalidate the cache before reading, so a failed read doesn't leave it holding partial data
+				File->ReadAheadAmountBytes = 0;
+
+				if (!File->FileHandle->Seek(BlockOffsetBytes))
+				{
+					return SQLITE_IOERR_SEEK;
+				}
+
+				if (!File->FileHandle->Read(File->ReadAheadBuffer, BlockAmountBytes))
+				{
+					return SQLITE_IOERR_READ;
+				}
+
+				File->ReadAheadOffsetBytes = BlockOffsetBytes;
+				File->ReadAheadAmountBytes = BlockAmountBytes;
+			}
+
+			const int64 CachedOffsetBytes = ReadOffsetBytes - File->ReadAheadOffsetBytes;
+			const int64 CopyAmountBytes = FMath::Min<int64>(ReadBytesRemaining, File->ReadAheadAmountBytes - CachedOffsetBytes);
+			if (CopyAmountBytes <= 0)
+			{
+				// The block came back shorter than asked for, so treat the rest as past the end of the file
+				FMemory::Memzero(OutBuffer, ReadBytesRemaining);
+				return SQLITE_IOERR_SHORT_READ;
+			}
+			FMemory::Memcpy(OutBuffer, File->ReadAheadBuffer + CachedOffsetBytes, CopyAmountBytes);
+
+			OutBuffer += CopyAmountBytes;
+			ReadOffsetBytes += CopyAmountBytes;
+			ReadBytesRemaining -= CopyAmountBytes;
+		}
+
+		return SQLITE_OK;
+	}
+
 	/** Write to a file previously opened by Open */
 	static int Write(sqlite3_file* InFile, const void* InBuffer, int InWriteAmountBytes, sqlite3_int64 InWriteOffsetBytes)
 	{
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
+		SCOPE_CYCLE_COUNTER(STAT_SQLiteVFS_Write);
+		INC_DWORD_STAT_BY(STAT_SQLiteVFS_BytesWritten, InWriteAmountBytes);
+		FSQLiteIoOpScope IoOpScope(&File->IoStats->Write, InWriteAmountBytes);
+
+		// Writes made during a batch atomic write are buffered until the batch is committed
+		if (File->AtomicWriteBatch)
+		{
+			FSQLiteAtomicWriteBatch::FWrite& BufferedWrite = File->AtomicWriteBatch->Writes.AddDefaulted_GetRef();
+			BufferedWrite.OffsetBytes = InWriteOffsetBytes;
+			BufferedWrite.Data.Append((const uint8*)InBuffer, InWriteAmountBytes);
+			return SQLITE_OK;
+		}
+
+		FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+
+		// A batch still pending in the redo log must not be replayed over this write
+		if (!File->FileNode->RetireAtomicWriteLog(/*bFlushFile*/true))
+		{
+			return SQLITE_IOERR_WRITE;
+		}
+
 		if (!File->FileHandle->Seek(InWriteOffsetBytes))
 		{
 			return SQLITE_IOERR_SEEK;
@@ -512,6 +1070,30 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
+		SCOPE_CYCLE_COUNTER(STAT_SQLiteVFS_Truncate);
+		FSQLiteIoOpScope IoOpScope(&File->IoStats->Truncate, 0);
+
+		// Never leave a mapping over the part of the file that is about to be removed; if SQLite still holds pages from it, just stop serving anything past the new end until they're released
+		if (File->MappedFileRegion && InSizeBytes < File->MappedSizeBytes)
+		{
+			if (File->NumOutstandingFetches == 0)
+			{
+				UnmapFile(File);
+			}
+			else
+			{
+				File->MappedSizeBytes = InSizeBytes;
+			}
+		}
+
+		FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+
+		// A batch still pending in the redo log must not be replayed over the truncated file
+		if (!File->FileNode->RetireAtomicWriteLog(/*bFlushFile*/true))
+		{
+			return SQLITE_IOERR_TRUNCATE;
+		}
+
 		if (!File->FileHandle->Truncate(InSizeBytes))
 		{
 			return SQLITE_IOERR_TRUNCATE;
@@ -526,12 +1108,23 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		const bool bFullFlush = (InFlags & 0x0F) == SQLITE_SYNC_FULL;
+		SCOPE_CYCLE_COUNTER(STAT_SQLiteVFS_Sync);
+		FSQLiteIoOpScope IoOpScope(&File->IoStats->Sync, 0);
+
+		FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+
+		const bool bFullFlush = (InFlags & 0x0F) == SQLITE_SYNC_FULL;
 		if (!File->FileHandle->Flush(bFullFlush))
 		{
 			return SQLITE_IOERR_FSYNC;
 		}
 
+		// Once the file is synced, any batch committed to the redo log is durable without it
+		if (!File->FileNode->RetireAtomicWriteLog(/*bFlushFile*/false))
+		{
+			return SQLITE_IOERR_FSYNC;
+		}
+
 		return SQLITE_OK;
 	}
 
@@ -542,23 +1135,67 @@ private:
 		check(File && File->FileHandle);
 
 		check(OutSizePtr);
-		*OutSizePtr = File->FileHandle->Size();
+		*OutSizePtr = GetFileHandleSize(File);
 
 		return SQLITE_OK;
 	}
 
-	/** Lock a file previously opened by Open */
+	/** Get the current size of a file previously opened by Open, via its shared handle */
+	static int64 GetFileHandleSize(FSQLiteFile* File)
+	{
+		FScopeLock FileHandleLock(&File->FileNode->FileHandleSection);
+		return File->FileHandle->Size();
+	}
+
+	/**
+	 * Lock a file previously opened by Open
+	 * @note This mirrors the in-process part of the unix VFS locking: any number of connections can hold SHARED, one of which can also hold RESERVED (to write to its journal),
+	 *       and a writer moves through PENDING (which stops new SHARED locks being granted) while waiting for the other readers to finish before it can take EXCLUSIVE
+	 */
 	static int Lock(sqlite3_file* InFile, int InLockMode)
 	{
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		// See Open for the notes on locking
-		if (InLockMode < File->LockMode)
+		if (InLockMode <= File->LockMode)
+		{
+			return SQLITE_OK;
+		}
+
+		// SQLite never asks for PENDING directly, and never asks for more than SHARED without holding SHARED first
+		check(InLockMode != SQLITE_LOCK_PENDING);
+		check(File->LockMode != SQLITE_LOCK_NONE || InLockMode == SQLITE_LOCK_SHARED);
+
+		FScopeLock FileNodesLock(&FSQLiteFile::FileNodesSection);
+		FSQLiteFileNode* FileNode = File->FileNode;
+
+		// Is another connection holding a lock that precludes the one requested?
+		if (File->LockMode != FileNode->LockMode && (FileNode->LockMode >= SQLITE_LOCK_PENDING || InLockMode > SQLITE_LOCK_SHARED))
+		{
+			return SQLITE_BUSY;
+		}
+
+		if (InLockMode == SQLITE_LOCK_SHARED)
 		{
-			return SQLITE_IOERR_LOCK;
+			if (FileNode->LockMode == SQLITE_LOCK_NONE)
+			{
+				FileNode->LockMode = SQLITE_LOCK_SHARED;
+			}
+			++FileNode->NumSharedLocks;
+			File->LockMode = SQLITE_LOCK_SHARED;
+			return SQLITE_OK;
 		}
+
+		if (InLockMode == SQLITE_LOCK_EXCLUSIVE && FileNode->NumSharedLocks > 1)
+		{
+			// Other connections are still reading; hold PENDING so that no new readers can start while SQLite retries
+			File->LockMode = SQLITE_LOCK_PENDING;
+			FileNode->LockMode = SQLITE_LOCK_PENDING;
+			return SQLITE_BUSY;
+		}
+
 		File->LockMode = InLockMode;
+		FileNode->LockMode = InLockMode;
 
 		return SQLITE_OK;
 	}
@@ -569,25 +1206,48 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		// See Open for the notes on locking
-		if (InLockMode > File->LockMode)
+		// SQLite only ever unlocks to SHARED or NONE
+		check(InLockMode <= SQLITE_LOCK_SHARED);
+
+		if (InLockMode >= File->LockMode)
 		{
-			return SQLITE_IOERR_UNLOCK;
+			return SQLITE_OK;
+		}
+
+		FScopeLock FileNodesLock(&FSQLiteFile::FileNodesSection);
+		FSQLiteFileNode* FileNode = File->FileNode;
+
+		// Only one connection can hold a lock stronger than SHARED, so releasing ours drops the file back to SHARED
+		if (File->LockMode > SQLITE_LOCK_SHARED)
+		{
+			check(FileNode->LockMode == File->LockMode);
+			FileNode->LockMode = SQLITE_LOCK_SHARED;
 		}
+
+		if (InLockMode == SQLITE_LOCK_NONE)
+		{
+			check(FileNode->NumSharedLocks > 0);
+			if (--FileNode->NumSharedLocks == 0)
+			{
+				FileNode->LockMode = SQLITE_LOCK_NONE;
+			}
+		}
+
 		File->LockMode = InLockMode;
 
 		return SQLITE_OK;
 	}
 
-	/** Check for a lock on a file previously opened by Open */
+	/** Check whether any connection holds a RESERVED (or stronger) lock on a file previously opened by Open */
 	static int CheckReservedLock(sqlite3_file* InFile, int* OutIsLocked)
 	{
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		// See Open for the notes on locking
+		FScopeLock FileNodesLock(&FSQLiteFile::FileNodesSection);
+
 		check(OutIsLocked);
-		*OutIsLocked = File->LockMode > 0;
+		*OutIsLocked = File->FileNode->LockMode > SQLITE_LOCK_SHARED;
 
 		return SQLITE_OK;
 	}
@@ -604,6 +1264,43 @@ private:
 			*(int*)InOutOpData = File->LockMode;
 			return SQLITE_OK;
 
+		case FSQLiteIoStats::FileControlOp:
+			File->IoStats->Snapshot(*(FSQLiteIoStats*)InOutOpData);
+			return SQLITE_OK;
+
+		case SQLITE_FCNTL_BEGIN_ATOMIC_WRITE:
+			if (!File->bSupportsAtomicWriteBatch || File->AtomicWriteBatch)
+			{
+				return SQLITE_IOERR;
+			}
+			File->AtomicWriteBatch = new FSQLiteAtomicWriteBatch();
+			return SQLITE_OK;
+
+		case SQLITE_FCNTL_COMMIT_ATOMIC_WRITE:
+			return CommitAtomicWriteBatch(File);
+
+		case SQLITE_FCNTL_ROLLBACK_ATOMIC_WRITE:
+			delete File->AtomicWriteBatch;
+			File->AtomicWriteBatch = nullptr;
+			return SQLITE_OK;
+
+		case SQLITE_FCNTL_MMAP_SIZE:
+			{
+				// A negative limit is a query for the current limit, otherwise apply the new limit (the mapping will be lazily recreated on the next fetch)
+				// The mapping can't be released while SQLite still holds pages from it, so in that case the new limit is applied once the last page is released
+				const sqlite3_int64 NewMmapSizeMax = *(sqlite3_int64*)InOutOpData;
+				*(sqlite3_int64*)InOutOpData = File->MmapSizeMax;
+				if (NewMmapSizeMax >= 0)
+				{
+					File->PendingMmapSizeMax = NewMmapSizeMax != File->MmapSizeMax ? NewMmapSizeMax : -1;
+					if (File->NumOutstandingFetches == 0)
+					{
+						ApplyPendingMappingChanges(File);
+					}
+				}
+			}
+			return SQLITE_OK;
+
 		default:
 			break;
 		}
@@ -626,7 +1323,514 @@ private:
 		FSQLiteFile* File = (FSQLiteFile*)InFile;
 		check(File && File->FileHandle);
 
-		return SQLITE_IOCAP_UNDELETABLE_WHEN_OPEN;
+		// Read-only files (eg, files inside a Pak) can never change, so SQLite can skip its locking and change detection for them
+		if (File->bIsReadOnly)
+		{
+			return SQLITE_IOCAP_UNDELETABLE_WHEN_OPEN | SQLITE_IOCAP_IMMUTABLE;
+		}
+
+		// Transactions that fit in memory can skip the rollback journal when we can apply their writes atomically
+		return File->bSupportsAtomicWriteBatch
+			? SQLITE_IOCAP_UNDELETABLE_WHEN_OPEN | SQLITE_IOCAP_BATCH_ATOMIC
+			: SQLITE_IOCAP_UNDELETABLE_WHEN_OPEN;
+	}
+
+	/** Magic number written at the start of the redo log used by CommitAtomicWriteBatch */
+	static constexpr uint32 AtomicWriteLogMagic = 0x41425153; // 'SQBA'
+
+	/** Offset of the file change counter in the database header, which SQLite changes in every transaction that writes to a rollback journal mode database */
+	static constexpr int64 ChangeCounterOffsetBytes = 24;
+
+	/**
+	 * Commit the batch atomic write currently being buffered by a file previously opened by Open.
+	 * The batch is written to a redo log (and synced) before being applied to the file, so that a batch interrupted part way through being applied can be
+	 * recovered from the redo log by RecoverAtomicWriteLog. The redo log is cleared once the batch is durable in the file (see FSQLiteFileNode::RetireAtomicWriteLog).
+	 * @note Failing this returns an I/O error, which causes SQLite to rollback the batch and retry the transaction using the rollback journal.
+	 */
+	static int CommitAtomicWriteBatch(FSQLiteFile* File)
+	{
+		if (!File->AtomicWriteBatch)
+		{
+			return SQLITE_IOERR;
+		}
+
+		TUniquePtr<FSQLiteAtomicWriteBatch> AtomicWriteBatch(File->AtomicWriteBatch);
+		File->AtomicWriteBatch = nullptr;
+
+		FSQLiteFileNode* FileNode = File->FileNode;
+		FScopeLock FileHandleLock(&FileNode->FileHandleSection);
+
+		// Only one batch may be pending at a time, as the new one only holds the pages it changed
+		if (!FileNode->RetireAtomicWriteLog(/*bFlushFile*/true))
+		{
+			return SQLITE_IOERR_FSYNC;
+		}
+
+		// The redo log is a header (magic, change counter the batch applies to, payload size, payload CRC) followed by the payload of offset/data pairs
+		TArray<uint8> LogPayload;
+		{
+			FMemoryWriter LogPayloadWriter(LogPayload);
+			for (FSQLiteAtomicWriteBatch::FWrite& BufferedWrite : AtomicWriteBatch->Writes)
+			{
+				LogPayloadWriter << BufferedWrite.OffsetBytes;
+				LogPayloadWriter << BufferedWrite.Data;
+			}
+		}
+
+		TArray<uint8> LogData;
+		{
+			uint32 LogMagic = AtomicWriteLogMagic;
+			uint32 LogBaseChangeCounter = ReadChangeCounter(File->FileHandle);
+			int64 LogPayloadSizeBytes = LogPayload.Num();
+			uint32 LogPayloadCrc = FCrc::MemCrc32(LogPayload.GetData(), LogPayload.Num());
+
+			FMemoryWriter LogWriter(LogData);
+			LogWriter << LogMagic;
+			LogWriter << LogBaseChangeCounter;
+			LogWriter << LogPayloadSizeBytes;
+			LogWriter << LogPayloadCrc;
+			LogWriter.Serialize(LogPayload.GetData(), LogPayload.Num());
+		}
+
+		if (!FileNode->AtomicWriteLogHandle)
+		{
+			FileNode->AtomicWriteLogFilename = GetAtomicWriteLogFilename(File);
+			FileNode->AtomicWriteLogHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FileNode->AtomicWriteLogFilename, /*bAppend*/false, /*bAllowRead*/true);
+			if (!FileNode->AtomicWriteLogHandle)
+			{
+				return SQLITE_IOERR_WRITE;
+			}
+		}
+
+		// Once the redo log is synced the batch is committed, even if we fail to apply it below
+		{
+			FSQLiteIoOpScope IoOpScope(&File->IoStats->Write, LogData.Num());
+			if (!FileNode->AtomicWriteLogHandle->Seek(0) || !FileNode->AtomicWriteLogHandle->Write(LogData.GetData(), LogData.Num()))
+			{
+				return SQLITE_IOERR_WRITE;
+			}
+		}
+		{
+			FSQLiteIoOpScope IoOpScope(&File->IoStats->Sync, 0);
+			if (!FileNode->AtomicWriteLogHandle->Flush(/*bFullFlush*/true))
+			{
+				return SQLITE_IOERR_FSYNC;
+			}
+		}
+		FileNode->bAtomicWriteLogPending = true;
+
+		for (const FSQLiteAtomicWriteBatch::FWrite& BufferedWrite : AtomicWriteBatch->Writes)
+		{
+			if (!File->FileHandle->Seek(BufferedWrite.OffsetBytes) || !File->FileHandle->Write(BufferedWrite.Data.GetData(), BufferedWrite.Data.Num()))
+			{
+				// SQLite will retry this transaction via its rollback journal, which must take precedence over this batch if we crash during the retry
+				FileNode->AtomicWriteLogHandle->Truncate(0);
+				FileNode->AtomicWriteLogHandle->Flush(/*bFullFlush*/true);
+				FileNode->bAtomicWriteLogPending = false;
+				return SQLITE_IOERR_WRITE;
+			}
+		}
+
+		return SQLITE_OK;
+	}
+
+	/**
+	 * Apply any batch atomic write left in the redo log of a file previously opened by Open (see CommitAtomicWriteBatch), and remove the redo log.
+	 * The batch is only applied if the file is still at the change counter it was committed against, or the one it sets, so a log left behind by a crash
+	 * is never replayed over changes made to the file since (eg, by a tool that doesn't know about the redo log).
+	 * @return false if a committed batch could not be applied.
+	 */
+	static bool RecoverAtomicWriteLog(FSQLiteFile* File)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		const FString LogFilename = GetAtomicWriteLogFilename(File);
+		if (!PlatformFile.FileExists(*LogFilename))
+		{
+			return true;
+		}
+
+		FSQLiteFileNode* FileNode = File->FileNode;
+		FScopeLock FileHandleLock(&FileNode->FileHandleSection);
+
+		// Another connection to this file is already using the redo log, so there's nothing to recover
+		if (FileNode->AtomicWriteLogHandle)
+		{
+			return true;
+		}
+
+		TArray<uint8> LogData;
+		if (!FFileHelper::LoadFileToArray(LogData, *LogFilename))
+		{
+			return false;
+		}
+
+		// A redo log that is empty, or was only partially written, holds no committed batch
+		constexpr int64 LogHeaderSizeBytes = sizeof(uint32) + sizeof(uint32) + sizeof(int64) + sizeof(uint32);
+		if (LogData.Num() >= LogHeaderSizeBytes)
+		{
+			uint32 LogMagic = 0;
+			uint32 LogBaseChangeCounter = 0;
+			int64 LogPayloadSizeBytes = 0;
+			uint32 LogPayloadCrc = 0;
+
+			FMemoryReader LogReader(LogData);
+			LogReader << LogMagic;
+			LogReader << LogBaseChangeCounter;
+			LogReader << LogPayloadSizeBytes;
+			LogReader << LogPayloadCrc;
+
+			const bool bIsCommitted = LogMagic == AtomicWriteLogMagic
+				&& LogPayloadSizeBytes >= 0
+				&& LogPayloadSizeBytes <= LogData.Num() - LogHeaderSizeBytes
+				&& LogPayloadCrc == FCrc::MemCrc32(LogData.GetData() + LogHeaderSizeBytes, (int32)LogPayloadSizeBytes);
+
+			if (bIsCommitted)
+			{
+				FSQLiteAtomicWriteBatch AtomicWriteBatch;
+				uint32 BatchChangeCounter = LogBaseChangeCounter;
+				while (LogReader.Tell() < LogHeaderSizeBytes + LogPayloadSizeBytes)
+				{
+					FSQLiteAtomicWriteBatch::FWrite& BufferedWrite = AtomicWriteBatch.Writes.AddDefaulted_GetRef();
+					LogReader << BufferedWrite.OffsetBytes;
+					LogReader << BufferedWrite.Data;
+
+					// The change counter the file has once the batch is applied (if the batch writes the header)
+					const int64 CounterIndex = ChangeCounterOffsetBytes - BufferedWrite.OffsetBytes;
+					if (CounterIndex >= 0 && CounterIndex + (int64)sizeof(uint32) <= BufferedWrite.Data.Num())
+					{
+						FMemory::Memcpy(&BatchChangeCounter, BufferedWrite.Data.GetData() + CounterIndex, sizeof(uint32));
+					}
+				}
+
+				const uint32 FileChangeCounter = ReadChangeCounter(File->FileHandle);
+				if (FileChangeCounter == LogBaseChangeCounter || FileChangeCounter == BatchChangeCounter)
+				{
+					for (const FSQLiteAtomicWriteBatch::FWrite& BufferedWrite : AtomicWriteBatch.Writes)
+					{
+						if (!File->FileHandle->Seek(BufferedWrite.OffsetBytes) || !File->FileHandle->Write(BufferedWrite.Data.GetData(), BufferedWrite.Data.Num()))
+						{
+							return false;
+						}
+					}
+
+					if (!File->FileHandle->Flush(/*bFullFlush*/true))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return PlatformFile.DeleteFile(*LogFilename);
+	}
+
+	/** Read the change counter from the database header of a file (as stored, as it's only compared), or 0 if the file is too short to have one */
+	static uint32 ReadChangeCounter(IFileHandle* FileHandle)
+	{
+		uint32 ChangeCounter = 0;
+		if (FileHandle->Size() < ChangeCounterOffsetBytes + (int64)sizeof(uint32)
+			|| !FileHandle->Seek(ChangeCounterOffsetBytes)
+			|| !FileHandle->Read((uint8*)&ChangeCounter, sizeof(uint32)))
+		{
+			return 0;
+		}
+		return ChangeCounter;
+	}
+
+	/** Get the filename of the redo log used for the batch atomic writes of a file previously opened by Open */
+	static FString GetAtomicWriteLogFilename(const FSQLiteFile* File)
+	{
+		return File->Filename + TEXT("-batch");
+	}
+
+	/** Map a region of the shared memory (wal-index) associated with a file previously opened by Open */
+	static int ShmMap(sqlite3_file* InFile, int InRegionIndex, int InRegionSizeBytes, int InExtend, void volatile** OutRegionPtr)
+	{
+		FSQLiteFile* File = (FSQLiteFile*)InFile;
+		check(File && File->FileHandle);
+		check(OutRegionPtr);
+
+		FScopeLock Lock(&FSQLiteFile::ShmNodesSection);
+
+		if (!File->ShmNode)
+		{
+			File->ShmNode = FSQLiteFile::AcquireShmNode(*File->Filename);
+		}
+
+		FSQLiteShmNode* ShmNode = File->ShmNode;
+		if (ShmNode->RegionSizeBytes == 0)
+		{
+			ShmNode->RegionSizeBytes = InRegionSizeBytes;
+		}
+		check(ShmNode->RegionSizeBytes == InRegionSizeBytes);
+
+		if (InRegionIndex >= ShmNode->Regions.Num())
+		{
+			// If we weren't asked to extend the shared memory then SQLite expects a null region rather than an error
+			if (!InExtend)
+			{
+				*OutRegionPtr = nullptr;
+				return SQLITE_OK;
+			}
+
+			while (InRegionIndex >= ShmNode->Regions.Num())
+			{
+				void* Region = FMemory::Malloc(InRegionSizeBytes, DEFAULT_ALIGNMENT);
+				if (!Region)
+				{
+					*OutRegionPtr = nullptr;
+					return SQLITE_IOERR_NOMEM;
+				}
+				FMemory::Memzero(Region, InRegionSizeBytes);
+				ShmNode->Regions.Add(Region);
+			}
+		}
+
+		*OutRegionPtr = ShmNode->Regions[InRegionIndex];
+		return SQLITE_OK;
+	}
+
+	/** Change the lock state of a range of shared memory lock slots for a file previously opened by Open */
+	static int ShmLock(sqlite3_file* InFile, int InOffset, int InCount, int InFlags)
+	{
+		FSQLiteFile* File = (FSQLiteFile*)InFile;
+		check(File && File->FileHandle && File->ShmNode);
+		check(InOffset >= 0 && InCount >= 1 && InOffset + InCount <= SQLITE_SHM_NLOCK);
+
+		FScopeLock Lock(&FSQLiteFile::ShmNodesSection);
+
+		FSQLiteShmNode* ShmNode = File->ShmNode;
+		const uint16 LockMask = (uint16)(((1 << InCount) - 1) << InOffset);
+
+		if (InFlags & SQLITE_SHM_UNLOCK)
+		{
+			for (int32 SlotIndex = InOffset; SlotIndex < InOffset + InCount; ++SlotIndex)
+			{
+				const uint16 SlotMask = (uint16)(1 << SlotIndex);
+				if (File->ShmExclusiveMask & SlotMask)
+				{
+					check(ShmNode->LockStates[SlotIndex] == -1);
+					ShmNode->LockStates[SlotIndex] = 0;
+				}
+				else if (File->ShmSharedMask & SlotMask)
+				{
+					check(ShmNode->LockStates[SlotIndex] > 0);
+					--ShmNode->LockStates[SlotIndex];
+				}
+			}
+
+			File->ShmSharedMask &= ~LockMask;
+			File->ShmExclusiveMask &= ~LockMask;
+		}
+		else if (InFlags & SQLITE_SHM_SHARED)
+		{
+			// SQLite only ever takes shared locks on a single slot
+			check(InCount == 1);
+
+			if ((File->ShmSharedMask & LockMask) == 0)
+			{
+				if (ShmNode->LockStates[InOffset] < 0)
+				{
+					return SQLITE_BUSY;
+				}
+
+				++ShmNode->LockStates[InOffset];
+				File->ShmSharedMask |= LockMask;
+			}
+		}
+		else
+		{
+			// Make sure nobody else holds any lock on the slots before we take any of them
+			for (int32 SlotIndex = InOffset; SlotIndex < InOffset + InCount; ++SlotIndex)
+			{
+				const uint16 SlotMask = (uint16)(1 << SlotIndex);
+				if ((File->ShmExclusiveMask & SlotMask) == 0 && ShmNode->LockStates[SlotIndex] != 0)
+				{
+					return SQLITE_BUSY;
+				}
+			}
+
+			for (int32 SlotIndex = InOffset; SlotIndex < InOffset + InCount; ++SlotIndex)
+			{
+				ShmNode->LockStates[SlotIndex] = -1;
+			}
+			File->ShmExclusiveMask |= LockMask;
+		}
+
+		return SQLITE_OK;
+	}
+
+	/** Issue a memory barrier for the shared memory of a file previously opened by Open */
+	static void ShmBarrier(sqlite3_file* InFile)
+	{
+		FPlatformMisc::MemoryBarrier();
+
+		// Taking the lock also acts as a barrier against any other connection that is mid-way through a shm operation
+		FScopeLock Lock(&FSQLiteFile::ShmNodesSection);
+	}
+
+	/** Unmap the shared memory associated with a file previously opened by Open */
+	static int ShmUnmap(sqlite3_file* InFile, int InDeleteFlag)
+	{
+		FSQLiteFile* File = (FSQLiteFile*)InFile;
+		check(File);
+
+		if (!File->ShmNode)
+		{
+			return SQLITE_OK;
+		}
+
+		FScopeLock Lock(&FSQLiteFile::ShmNodesSection);
+
+		// Release any locks that are still held by this connection
+		FSQLiteShmNode* ShmNode = File->ShmNode;
+		for (int32 SlotIndex = 0; SlotIndex < SQLITE_SHM_NLOCK; ++SlotIndex)
+		{
+			const uint16 SlotMask = (uint16)(1 << SlotIndex);
+			if (File->ShmExclusiveMask & SlotMask)
+			{
+				ShmNode->LockStates[SlotIndex] = 0;
+			}
+			else if (File->ShmSharedMask & SlotMask)
+			{
+				--ShmNode->LockStates[SlotIndex];
+			}
+		}
+		File->ShmSharedMask = 0;
+		File->ShmExclusiveMask = 0;
+
+		// The shared memory only ever lives on the heap, so it is discarded once the last connection unmaps it (regardless of InDeleteFlag)
+		FSQLiteFile::ReleaseShmNode(ShmNode);
+		File->ShmNode = nullptr;
+
+		return SQLITE_OK;
+	}
+
+	/** Get a pointer to a page of a file previously opened by Open, or null if the page cannot be memory mapped (in which case SQLite will fallback to Read) */
+	static int Fetch(sqlite3_file* InFile, sqlite3_int64 InOffsetBytes, int InAmountBytes, void** OutPtr)
+	{
+		FSQLiteFile* File = (FSQLiteFile*)InFile;
+		check(File && File->FileHandle);
+		check(OutPtr);
+
+		*OutPtr = nullptr;
+
+		const sqlite3_int64 RequiredSizeBytes = InOffsetBytes + InAmountBytes;
+		if (RequiredSizeBytes > File->MmapSizeMax)
+		{
+			return SQLITE_OK;
+		}
+
+		// The file may have grown since it was mapped, but we can only remap while SQLite isn't holding onto any pages from the current mapping
+		if (!File->MappedFileRegion || RequiredSizeBytes > File->MappedSizeBytes)
+		{
+			if (File->NumOutstandingFetches > 0)
+			{
+				return SQLITE_OK;
+			}
+
+			UnmapFile(File);
+			MapFile(File, FMath::Min<int64>(GetFileHandleSize(File), File->MmapSizeMax));
+		}
+
+		if (File->MappedFileRegion && RequiredSizeBytes <= File->MappedSizeBytes)
+		{
+			*OutPtr = (void*)(File->MappedFileRegion->GetMappedPtr() + InOffsetBytes);
+			++File->NumOutstandingFetches;
+		}
+
+		return SQLITE_OK;
+	}
+
+	/** Release a page previously returned by Fetch, or release the whole mapping if given a null page */
+	static int Unfetch(sqlite3_file* InFile, sqlite3_int64 InOffsetBytes, void* InPtr)
+	{
+		FSQLiteFile* File = (FSQLiteFile*)InFile;
+		check(File && File->FileHandle);
+
+		if (InPtr)
+		{
+			check(File->NumOutstandingFetches > 0);
+			if (--File->NumOutstandingFetches == 0)
+			{
+				ApplyPendingMappingChanges(File);
+			}
+		}
+		else if (File->NumOutstandingFetches == 0)
+		{
+			UnmapFile(File);
+		}
+
+		return SQLITE_OK;
+	}
+
+	/** Apply any mapping limit or truncation that had to wait for SQLite to release all of its fetched pages */
+	static void ApplyPendingMappingChanges(FSQLiteFile* File)
+	{
+		check(File->NumOutstandingFetches == 0);
+
+		if (File->PendingMmapSizeMax >= 0)
+		{
+			File->MmapSizeMax = File->PendingMmapSizeMax;
+			File->PendingMmapSizeMax = -1;
+			UnmapFile(File);
+		}
+		else if (File->MappedFileRegion && File->MappedSizeBytes < File->MappedFileRegion->GetMappedSize())
+		{
+			UnmapFile(File);
+		}
+	}
+
+	/** Attempt to create a read-only memory mapping of the first InMapSizeBytes of the file, returning true if the mapping is available */
+	static bool MapFile(FSQLiteFile* File, const int64 InMapSizeBytes)
+	{
+		check(!File->MappedFileRegion);
+
+		// Don't keep asking the platform for a mapping it has already told us it can't provide
+		if (File->bMappingUnavailable || InMapSizeBytes <= 0)
+		{
+			return false;
+		}
+
+		if (!File->MappedFileHandle)
+		{
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			File->MappedFileHandle = PlatformFile.OpenMapped(*File->Filename);
+			if (!File->MappedFileHandle)
+			{
+				File->bMappingUnavailable = true;
+				return false;
+			}
+		}
+
+		const int64 MappedFileSizeBytes = File->MappedFileHandle->GetFileSize();
+		File->MappedFileRegion = File->MappedFileHandle->MapRegion(0, FMath::Min<int64>(InMapSizeBytes, MappedFileSizeBytes));
+		if (!File->MappedFileRegion)
+		{
+			// The mapped file handle captures the file size when opened, so a failure may just be down to the file having grown; retry with a fresh handle next time
+			File->bMappingUnavailable = MappedFileSizeBytes >= InMapSizeBytes;
+			delete File->MappedFileHandle;
+			File->MappedFileHandle = nullptr;
+			return false;
+		}
+
+		File->MappedSizeBytes = File->MappedFileRegion->GetMappedSize();
+		return true;
+	}
+
+	/** Release any memory mapping of the file */
+	static void UnmapFile(FSQLiteFile* File)
+	{
+		check(File->NumOutstandingFetches == 0);
+
+		delete File->MappedFileRegion;
+		File->MappedFileRegion = nullptr;
+		File->MappedSizeBytes = 0;
+
+		// The mapped file handle captures the file size when opened, so we need a new one if the file may have grown
+		delete File->MappedFileHandle;
+		File->MappedFileHandle = nullptr;
 	}
 
 	/** Attempt to delete the named file */
@@ -0,0 +1,245 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQLiteFunction.h"
+#include "IncludeSQLite.h"
+
+#include "Containers/StringConv.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FSQLiteFunctionArgs::FSQLiteFunctionArgs(sqlite3_value** InValues, const int32 InNumValues, const bool bInUseUTF16Text)
+	: Values(InValues)
+	, NumValues(InNumValues)
+	, bUseUTF16Text(bInUseUTF16Text)
+{
+}
+
+bool FSQLiteFunctionArgs::HasNull() const
+{
+	for (int32 ArgIndex = 0; ArgIndex < NumValues; ++ArgIndex)
+	{
+		if (sqlite3_value_type(Values[ArgIndex]) == SQLITE_NULL)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FSQLiteFunctionArgs::GetType(const int32 InArgIndex, ESQLiteColumnType& OutType) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	switch (sqlite3_value_type(Values[InArgIndex]))
+	{
+	case SQLITE_INTEGER:
+		OutType = ESQLiteColumnType::Integer;
+		break;
+	case SQLITE_FLOAT:
+		OutType = ESQLiteColumnType::Float;
+		break;
+	case SQLITE_TEXT:
+		OutType = ESQLiteColumnType::String;
+		break;
+	case SQLITE_BLOB:
+		OutType = ESQLiteColumnType::Blob;
+		break;
+	default:
+		OutType = ESQLiteColumnType::Null;
+		break;
+	}
+	return true;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, int32& OutValue) const
+{
+	int64 Value = 0;
+	if (GetValue(InArgIndex, Value))
+	{
+		OutValue = (int32)Value;
+		return true;
+	}
+	return false;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, int64& OutValue) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	OutValue = sqlite3_value_int64(Values[InArgIndex]);
+	return true;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, bool& OutValue) const
+{
+	int64 Value = 0;
+	if (GetValue(InArgIndex, Value))
+	{
+		OutValue = Value != 0;
+		return true;
+	}
+	return false;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, float& OutValue) const
+{
+	double Value = 0.0;
+	if (GetValue(InArgIndex, Value))
+	{
+		OutValue = (float)Value;
+		return true;
+	}
+	return false;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, double& OutValue) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	OutValue = sqlite3_value_double(Values[InArgIndex]);
+	return true;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, FString& OutValue) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	// Note: sqlite3_value_bytes must be called after sqlite3_value_text, as the text call may convert the value
+#if !PLATFORM_TCHAR_IS_4_BYTES
+	if (bUseUTF16Text)
+	{
+		const TCHAR* ValueUTF16 = (const TCHAR*)sqlite3_value_text16(Values[InArgIndex]);
+		const int32 ValueUTF16Len = sqlite3_value_bytes16(Values[InArgIndex]) / sizeof(TCHAR);
+		OutValue = ValueUTF16 ? FString(ValueUTF16Len, ValueUTF16) : FString();
+		return true;
+	}
+#endif
+
+	const char* ValueUTF8 = (const char*)sqlite3_value_text(Values[InArgIndex]);
+	const int32 ValueUTF8SizeBytes = sqlite3_value_bytes(Values[InArgIndex]);
+	if (!ValueUTF8)
+	{
+		OutValue.Reset();
+		return true;
+	}
+
+	const FUTF8ToTCHAR Value(ValueUTF8, ValueUTF8SizeBytes);
+	OutValue = FString(Value.Length(), Value.Get());
+	return true;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, TArray<uint8>& OutValue) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	// Note: sqlite3_value_bytes must be called after sqlite3_value_blob, as the blob call may convert the value
+	const uint8* ValueBlob = (const uint8*)sqlite3_value_blob(Values[InArgIndex]);
+	const int32 ValueBlobSizeBytes = sqlite3_value_bytes(Values[InArgIndex]);
+	OutValue.Reset();
+	if (ValueBlob)
+	{
+		OutValue.Append(ValueBlob, ValueBlobSizeBytes);
+	}
+	return true;
+}
+
+bool FSQLiteFunctionArgs::GetValue(const int32 InArgIndex, FGuid& OutValue) const
+{
+	if (InArgIndex < 0 || InArgIndex >= NumValues)
+	{
+		return false;
+	}
+
+	const uint8* ValueBlob = (const uint8*)sqlite3_value_blob(Values[InArgIndex]);
+	const int32 ValueBlobSizeBytes = sqlite3_value_bytes(Values[InArgIndex]);
+
+	FMemoryReaderView GuidReader(MakeArrayView(ValueBlob, ValueBlob ? ValueBlobSizeBytes : 0));
+	GuidReader << OutValue;
+	return !GuidReader.GetError();
+}
+
+FSQLiteFunctionResult::FSQLiteFunctionResult(sqlite3_context* InContext, const bool bInUseUTF16Text)
+	: Context(InContext)
+	, bUseUTF16Text(bInUseUTF16Text)
+{
+}
+
+void FSQLiteFunctionResult::SetValue(const int32 InValue)
+{
+	sqlite3_result_int64(Context, InValue);
+}
+
+void FSQLiteFunctionResult::SetValue(const int64 InValue)
+{
+	sqlite3_result_int64(Context, InValue);
+}
+
+void FSQLiteFunctionResult::SetValue(const bool InValue)
+{
+	sqlite3_result_int(Context, InValue ? 1 : 0);
+}
+
+void FSQLiteFunctionResult::SetValue(const float InValue)
+{
+	sqlite3_result_double(Context, InValue);
+}
+
+void FSQLiteFunctionResult::SetValue(const double InValue)
+{
+	sqlite3_result_double(Context, InValue);
+}
+
+void FSQLiteFunctionResult::SetValue(const FString& InValue)
+{
+#if !PLATFORM_TCHAR_IS_4_BYTES
+	if (bUseUTF16Text)
+	{
+		sqlite3_result_text16(Context, *InValue, InValue.Len() * sizeof(TCHAR), SQLITE_TRANSIENT);
+		return;
+	}
+#endif
+
+	const FTCHARToUTF8 ValueUTF8(*InValue, InValue.Len());
+	sqlite3_result_text(Context, ValueUTF8.Get(), ValueUTF8.Length(), SQLITE_TRANSIENT);
+}
+
+void FSQLiteFunctionResult::SetValue(TArrayView<const uint8> InBlobData)
+{
+	sqlite3_result_blob64(Context, InBlobData.GetData(), (sqlite3_uint64)InBlobData.Num(), SQLITE_TRANSIENT);
+}
+
+void FSQLiteFunctionResult::SetValue(const FGuid& InValue)
+{
+	TArray<uint8> GuidBytes;
+	{
+		FMemoryWriter GuidWriter(GuidBytes);
+		GuidWriter << const_cast<FGuid&>(InValue);
+	}
+	sqlite3_result_blob(Context, GuidBytes.GetData(), GuidBytes.Num(), SQLITE_TRANSIENT);
+}
+
+void FSQLiteFunctionResult::SetNull()
+{
+	sqlite3_result_null(Context);
+}
+
+void FSQLiteFunctionResult::SetError(const TCHAR* InErrorMessage)
+{
+	const FTCHARToUTF8 ErrorMessageUTF8(InErrorMessage);
+	sqlite3_result_error(Context, ErrorMessageUTF8.Get(), ErrorMessageUTF8.Length());
+}
@@ -0,0 +1,502 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQLitePageCache.h"
+#include "SQLiteIoStats.h"
+#include "IncludeSQLite.h"
+
+#include "Containers/Map.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/AlignmentTemplates.h"
+#include "Templates/UniquePtr.h"
+
+DECLARE_MEMORY_STAT(TEXT("Page Cache Memory"), STAT_SQLitePageCacheMemory, STATGROUP_SqliteGameDB);
+
+struct FSQLitePageCacheInstance;
+
+/** A page of a cache; the page content and the extra data SQLite asked for directly follow this header in the same slab slot */
+struct FSQLitePageCachePage
+{
+	/** Must be first, as SQLite hands this back to us as the page */
+	sqlite3_pcache_page Base;
+
+	FSQLitePageCacheInstance* Cache;
+	uint32 Key;
+	bool bPinned;
+
+	/** Links in the global LRU list and the LRU list of the owning cache (unpinned pages of purgeable caches only), most recently used first */
+	FSQLitePageCachePage* GlobalLruPrev;
+	FSQLitePageCachePage* GlobalLruNext;
+	FSQLitePageCachePage* CacheLruPrev;
+	FSQLitePageCachePage* CacheLruNext;
+};
+
+/** Fixed size slots carved out of larger slabs, so that each page doesn't need its own allocation */
+struct FSQLitePageSlabPool
+{
+	static constexpr int32 NumSlotsPerSlab = 32;
+
+	explicit FSQLitePageSlabPool(const int32 InSlotSizeBytes)
+		: SlotSizeBytes(InSlotSizeBytes)
+	{
+	}
+
+	~FSQLitePageSlabPool()
+	{
+		ReleaseSlabs();
+	}
+
+	void* Alloc()
+	{
+		if (!FreeSlots)
+		{
+			uint8* Slab = (uint8*)FMemory::Malloc(SlotSizeBytes * NumSlotsPerSlab);
+			Slabs.Add(Slab);
+			for (int32 SlotIndex = NumSlotsPerSlab - 1; SlotIndex >= 0; --SlotIndex)
+			{
+				void* Slot = Slab + (SlotIndex * SlotSizeBytes);
+				*(void**)Slot = FreeSlots;
+				FreeSlots = Slot;
+			}
+		}
+
+		void* Slot = FreeSlots;
+		FreeSlots = *(void**)Slot;
+		++NumSlotsInUse;
+		return Slot;
+	}
+
+	/** Return a slot to the pool; its slab stays allocated, so a page that is repeatedly fetched and discarded doesn't allocate each time */
+	void Free(void* InSlot)
+	{
+		*(void**)InSlot = FreeSlots;
+		FreeSlots = InSlot;
+
+		check(NumSlotsInUse > 0);
+		--NumSlotsInUse;
+	}
+
+	/** Give the memory back if nothing is using this pool (eg, all the connections using this page size have closed, or SQLite asked for memory to be freed) */
+	void ReleaseSlabsIfUnused()
+	{
+		if (NumSlotsInUse == 0)
+		{
+			ReleaseSlabs();
+		}
+	}
+
+	void ReleaseSlabs()
+	{
+		check(NumSlotsInUse == 0);
+		for (void* Slab : Slabs)
+		{
+			FMemory::Free(Slab);
+		}
+		Slabs.Reset();
+		FreeSlots = nullptr;
+	}
+
+	const int32 SlotSizeBytes;
+
+private:
+	TArray<void*> Slabs;
+	void* FreeSlots = nullptr;
+	int32 NumSlotsInUse = 0;
+};
+
+/** A page cache created by SQLite (one per database connection and schema) */
+struct FSQLitePageCacheInstance
+{
+	int32 PageSizeBytes = 0;
+	int32 ExtraSizeBytes = 0;
+	bool bPurgeable = false;
+
+	/** Number of pages this cache should hold (as set by PRAGMA cache_size), and the number that are currently pinned */
+	int32 MaxPages = 0;
+	int32 NumPinned = 0;
+
+	TMap<uint32, FSQLitePageCachePage*> Pages;
+	FSQLitePageSlabPool* Pool = nullptr;
+
+	/** Unpinned pages of this cache, most recently used first (purgeable caches only) */
+	FSQLitePageCachePage* LruHead = nullptr;
+	FSQLitePageCachePage* LruTail = nullptr;
+};
+
+/**
+ * Page cache functions used by SQLite (see sqlite3_pcache_methods2)
+ * @note All caches share a single lock, as pages are recycled between them.
+ */
+struct FSQLitePageCacheFuncs
+{
+public:
+	/** Register the page cache */
+	static void Register()
+	{
+		static const sqlite3_pcache_methods2 PageCacheFuncs = {
+			1,			/* Version 1 */
+			nullptr,	/* Pointer to application-specific data */
+			&Init,
+			&Shutdown,
+			&Create,
+			&Cachesize,
+			&Pagecount,
+			&Fetch,
+			&Unpin,
+			&Rekey,
+			&Truncate,
+			&Destroy,
+			&Shrink,
+		};
+
+		sqlite3_config(SQLITE_CONFIG_PCACHE2, &PageCacheFuncs);
+	}
+
+	/** Set the memory budget shared by every cache */
+	static void SetMemoryBudget(const int64 InBudgetBytes)
+	{
+		FScopeLock Lock(&PageCacheSection);
+		MemoryBudgetBytes = InBudgetBytes;
+		while (MemoryUsedBytes > MemoryBudgetBytes && GlobalLruTail)
+		{
+			FreePage(GlobalLruTail);
+		}
+	}
+
+	/** Default memory budget shared by every cache */
+	static constexpr int64 DefaultMemoryBudgetBytes = 64 * 1024 * 1024;
+
+	static FCriticalSection PageCacheSection;
+	static int64 MemoryBudgetBytes;
+	static int64 MemoryUsedBytes;
+
+private:
+	/** Initialize the page cache */
+	static int Init(void*)
+	{
+		return SQLITE_OK;
+	}
+
+	/** Shutdown the page cache */
+	static void Shutdown(void*)
+	{
+		// Every cache has been destroyed by this point, so every pool is empty, and destroying it releases any slabs it kept
+		FScopeLock Lock(&PageCacheSection);
+		SlabPools.Reset();
+	}
+
+	/** Create a new cache */
+	static sqlite3_pcache* Create(int InPageSizeBytes, int InExtraSizeBytes, int InPurgeable)
+	{
+		FScopeLock Lock(&PageCacheSection);
+
+		FSQLitePageCacheInstance* Cache = new FSQLitePageCacheInstance();
+		Cache->PageSizeBytes = InPageSizeBytes;
+		Cache->ExtraSizeBytes = InExtraSizeBytes;
+		Cache->bPurgeable = !!InPurgeable;
+
+		// Caches with the same page and extra sizes (ie, most of them) share the same pool
+		const int32 SlotSizeBytes = Align((int32)sizeof(FSQLitePageCachePage), 16) + Align(InPageSizeBytes + InExtraSizeBytes, 16);
+		TUniquePtr<FSQLitePageSlabPool>& Pool = SlabPools.FindOrAdd(SlotSizeBytes);
+		if (!Pool)
+		{
+			Pool = MakeUnique<FSQLitePageSlabPool>(SlotSizeBytes);
+		}
+		Cache->Pool = Pool.Get();
+
+		return (sqlite3_pcache*)Cache;
+	}
+
+	/** Set the number of pages a cache should hold */
+	static void Cachesize(sqlite3_pcache* InCache, int InMaxPages)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FScopeLock Lock(&PageCacheSection);
+
+		Cache->MaxPages = InMaxPages;
+		while (Cache->Pages.Num() > Cache->MaxPages && Cache->LruTail)
+		{
+			FreePage(Cache->LruTail);
+		}
+	}
+
+	/** Get the number of pages (pinned or unpinned) held by a cache */
+	static int Pagecount(sqlite3_pcache* InCache)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FScopeLock Lock(&PageCacheSection);
+
+		return Cache->Pages.Num();
+	}
+
+	/** Fetch (and pin) a page from a cache, optionally allocating it if it isn't already cached */
+	static sqlite3_pcache_page* Fetch(sqlite3_pcache* InCache, unsigned InKey, int InCreateFlag)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FScopeLock Lock(&PageCacheSection);
+
+		if (FSQLitePageCachePage** ExistingPagePtr = Cache->Pages.Find(InKey))
+		{
+			FSQLitePageCachePage* ExistingPage = *ExistingPagePtr;
+			PinPage(ExistingPage);
+			return &ExistingPage->Base;
+		}
+
+		if (InCreateFlag == 0)
+		{
+			return nullptr;
+		}
+
+		// SQLite first asks "nicely" (1), and will spill its dirty pages and try again before insisting (2)
+		const bool bMayFail = InCreateFlag == 1 && Cache->bPurgeable;
+		if (bMayFail && Cache->NumPinned >= Cache->MaxPages)
+		{
+			return nullptr;
+		}
+
+		FSQLitePageCachePage* Page = nullptr;
+
+		// Once a cache holds its share of pages, it recycles its own least recently used page
+		if (Cache->bPurgeable && Cache->Pages.Num() >= Cache->MaxPages && Cache->LruTail)
+		{
+			Page = Cache->LruTail;
+			DetachPage(Page);
+		}
+
+		// Otherwise take a page from the pool, recycling the least recently used page of any cache while the pool is over budget
+		while (!Page && MemoryUsedBytes + Cache->Pool->SlotSizeBytes > MemoryBudgetBytes && GlobalLruTail)
+		{
+			FSQLitePageCachePage* RecyclePage = GlobalLruTail;
+			if (RecyclePage->Cache->Pool == Cache->Pool)
+			{
+				Page = RecyclePage;
+				DetachPage(Page);
+			}
+			else
+			{
+				FreePage(RecyclePage);
+			}
+		}
+
+		if (!Page)
+		{
+			if (bMayFail && MemoryUsedBytes + Cache->Pool->SlotSizeBytes > MemoryBudgetBytes)
+			{
+				return nullptr;
+			}
+
+			Page = (FSQLitePageCachePage*)Cache->Pool->Alloc();
+			MemoryUsedBytes += Cache->Pool->SlotSizeBytes;
+			INC_MEMORY_STAT_BY(STAT_SQLitePageCacheMemory, Cache->Pool->SlotSizeBytes);
+		}
+
+		// SQLite relies on the extra data being zeroed to detect that this is a new page
+		uint8* PageData = (uint8*)Page + Align((int32)sizeof(FSQLitePageCachePage), 16);
+		Page->Base.pBuf = PageData;
+		Page->Base.pExtra = PageData + Cache->PageSizeBytes;
+		FMemory::Memzero(Page->Base.pExtra, Cache->ExtraSizeBytes);
+
+		Page->Cache = Cache;
+		Page->Key = InKey;
+		Page->bPinned = true;
+		Page->GlobalLruPrev = Page->GlobalLruNext = nullptr;
+		Page->CacheLruPrev = Page->CacheLruNext = nullptr;
+
+		Cache->Pages.Add(InKey, Page);
+		++Cache->NumPinned;
+
+		return &Page->Base;
+	}
+
+	/** Unpin a page previously returned by Fetch, optionally discarding it */
+	static void Unpin(sqlite3_pcache* InCache, sqlite3_pcache_page* InPage, int InDiscard)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FSQLitePageCachePage* Page = (FSQLitePageCachePage*)InPage;
+		FScopeLock Lock(&PageCacheSection);
+
+		check(Page->Cache == Cache && Page->bPinned);
+		if (InDiscard || (Cache->bPurgeable && Cache->Pages.Num() > Cache->MaxPages))
+		{
+			FreePage(Page);
+			return;
+		}
+
+		Page->bPinned = false;
+		--Cache->NumPinned;
+
+		// Pages of caches that aren't purgeable (eg, in-memory databases) are the only copy of their data, so are never recycled
+		if (Cache->bPurgeable)
+		{
+			LinkLru(Page);
+		}
+	}
+
+	/** Change the key of a page previously returned by Fetch, discarding any existing page with the new key */
+	static void Rekey(sqlite3_pcache* InCache, sqlite3_pcache_page* InPage, unsigned InOldKey, unsigned InNewKey)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FSQLitePageCachePage* Page = (FSQLitePageCachePage*)InPage;
+		FScopeLock Lock(&PageCacheSection);
+
+		check(Page->Cache == Cache && Page->Key == InOldKey);
+		if (FSQLitePageCachePage** ExistingPagePtr = Cache->Pages.Find(InNewKey))
+		{
+			FreePage(*ExistingPagePtr);
+		}
+
+		Cache->Pages.Remove(InOldKey);
+		Page->Key = InNewKey;
+		Cache->Pages.Add(InNewKey, Page);
+	}
+
+	/** Discard every page of a cache with a key greater than or equal to the given limit (pinned or not) */
+	static void Truncate(sqlite3_pcache* InCache, unsigned InKeyLimit)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FScopeLock Lock(&PageCacheSection);
+
+		TArray<FSQLitePageCachePage*> PagesToFree;
+		for (const TPair<uint32, FSQLitePageCachePage*>& PagePair : Cache->Pages)
+		{
+			if (PagePair.Key >= InKeyLimit)
+			{
+				PagesToFree.Add(PagePair.Value);
+			}
+		}
+
+		for (FSQLitePageCachePage* Page : PagesToFree)
+		{
+			FreePage(Page);
+		}
+	}
+
+	/** Destroy a cache previously created by Create, along with all of its pages */
+	static void Destroy(sqlite3_pcache* InCache)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		Truncate(InCache, 0);
+
+		FScopeLock Lock(&PageCacheSection);
+		check(Cache->Pages.Num() == 0);
+		Cache->Pool->ReleaseSlabsIfUnused();
+		delete Cache;
+	}
+
+	/** Free as much memory as possible from a cache */
+	static void Shrink(sqlite3_pcache* InCache)
+	{
+		FSQLitePageCacheInstance* Cache = (FSQLitePageCacheInstance*)InCache;
+		FScopeLock Lock(&PageCacheSection);
+
+		while (Cache->LruTail)
+		{
+			FreePage(Cache->LruTail);
+		}
+		Cache->Pool->ReleaseSlabsIfUnused();
+	}
+
+	/** Pin a page, removing it from the LRU lists */
+	static void PinPage(FSQLitePageCachePage* Page)
+	{
+		if (!Page->bPinned)
+		{
+			if (Page->Cache->bPurgeable)
+			{
+				UnlinkLru(Page);
+			}
+			Page->bPinned = true;
+			++Page->Cache->NumPinned;
+		}
+	}
+
+	/** Remove a page from its cache, but keep its memory so that it can be reused */
+	static void DetachPage(FSQLitePageCachePage* Page)
+	{
+		FSQLitePageCacheInstance* Cache = Page->Cache;
+		Cache->Pages.Remove(Page->Key);
+
+		if (Page->bPinned)
+		{
+			--Cache->NumPinned;
+		}
+		else if (Cache->bPurgeable)
+		{
+			UnlinkLru(Page);
+		}
+	}
+
+	/** Remove a page from its cache, and return its memory to the pool */
+	static void FreePage(FSQLitePageCachePage* Page)
+	{
+		FSQLitePageSlabPool* Pool = Page->Cache->Pool;
+		DetachPage(Page);
+
+		MemoryUsedBytes -= Pool->SlotSizeBytes;
+		DEC_MEMORY_STAT_BY(STAT_SQLitePageCacheMemory, Pool->SlotSizeBytes);
+		Pool->Free(Page);
+	}
+
+	/** Add an unpinned page to the front of the LRU lists */
+	static void LinkLru(FSQLitePageCachePage* Page)
+	{
+		FSQLitePageCacheInstance* Cache = Page->Cache;
+
+		Page->GlobalLruPrev = nullptr;
+		Page->GlobalLruNext = GlobalLruHead;
+		(GlobalLruHead ? GlobalLruHead->GlobalLruPrev : GlobalLruTail) = Page;
+		GlobalLruHead = Page;
+
+		Page->CacheLruPrev = nullptr;
+		Page->CacheLruNext = Cache->LruHead;
+		(Cache->LruHead ? Cache->LruHead->CacheLruPrev : Cache->LruTail) = Page;
+		Cache->LruHead = Page;
+	}
+
+	/** Remove an unpinned page from the LRU lists */
+	static void UnlinkLru(FSQLitePageCachePage* Page)
+	{
+		FSQLitePageCacheInstance* Cache = Page->Cache;
+
+		(Page->GlobalLruPrev ? Page->GlobalLruPrev->GlobalLruNext : GlobalLruHead) = Page->GlobalLruNext;
+		(Page->GlobalLruNext ? Page->GlobalLruNext->GlobalLruPrev : GlobalLruTail) = Page->GlobalLruPrev;
+		Page->GlobalLruPrev = Page->GlobalLruNext = nullptr;
+
+		(Page->CacheLruPrev ? Page->CacheLruPrev->CacheLruNext : Cache->LruHead) = Page->CacheLruNext;
+		(Page->CacheLruNext ? Page->CacheLruNext->CacheLruPrev : Cache->LruTail) = Page->CacheLruPrev;
+		Page->CacheLruPrev = Page->CacheLruNext = nullptr;
+	}
+
+	static TMap<int32, TUniquePtr<FSQLitePageSlabPool>> SlabPools;
+	static FSQLitePageCachePage* GlobalLruHead;
+	static FSQLitePageCachePage* GlobalLruTail;
+};
+
+FCriticalSection FSQLitePageCacheFuncs::PageCacheSection;
+int64 FSQLitePageCacheFuncs::MemoryBudgetBytes = FSQLitePageCacheFuncs::DefaultMemoryBudgetBytes;
+int64 FSQLitePageCacheFuncs::MemoryUsedBytes = 0;
+TMap<int32, TUniquePtr<FSQLitePageSlabPool>> FSQLitePageCacheFuncs::SlabPools;
+FSQLitePageCachePage* FSQLitePageCacheFuncs::GlobalLruHead = nullptr;
+FSQLitePageCachePage* FSQLitePageCacheFuncs::GlobalLruTail = nullptr;
+
+void FSQLitePageCache::Register()
+{
+	FSQLitePageCacheFuncs::Register();
+}
+
+void FSQLitePageCache::SetMemoryBudget(const int64 InBudgetBytes)
+{
+	FSQLitePageCacheFuncs::SetMemoryBudget(InBudgetBytes);
+}
+
+int64 FSQLitePageCache::GetMemoryBudget()
+{
+	FScopeLock Lock(&FSQLitePageCacheFuncs::PageCacheSection);
+	return FSQLitePageCacheFuncs::MemoryBudgetBytes;
+}
+
+int64 FSQLitePageCache::GetMemoryUsed()
+{
+	FScopeLock Lock(&FSQLitePageCacheFuncs::PageCacheSection);
+	return FSQLitePageCacheFuncs::MemoryUsedBytes;
+}
@@ -2,9 +2,11 @@
 
 #include "SQLitePreparedStatement.h"
 #include "SQLiteDatabase.h"
+#include "SQLiteArrayFunction.h"
 #include "IncludeSQLite.h"
 
 #include "Misc/AssertionMacros.h"
+#include "Misc/StringBuilder.h"
 #include "Containers/StringConv.h"
 #include "Serialization/MemoryReader.h"
 #include "Serialization/MemoryWriter.h"
@@ -29,10 +31,19 @@ FSQLitePreparedStatement::~FSQLitePreparedStatement()
 
 FSQLitePreparedStatement::FSQLitePreparedStatement(FSQLitePreparedStatement&& Other)
 	: Statement(Other.Statement)
+	, bUseUTF16Text(Other.bUseUTF16Text)
+	, CachedBindingIndices(MoveTemp(Other.CachedBindingIndices))
 	, CachedColumnNames(MoveTemp(Other.CachedColumnNames))
+	, CachedColumnIndices(MoveTemp(Other.CachedColumnIndices))
+	, CachedColumnDeclaredTypes(MoveTemp(Other.CachedColumnDeclaredTypes))
+	, CachedColumnsReprepareCount(Other.CachedColumnsReprepareCount)
 {
 	Other.Statement = nullptr;
+	Other.CachedBindingIndices.Reset();
 	Other.CachedColumnNames.Reset();
+	Other.CachedColumnIndices.Reset();
+	Other.CachedColumnDeclaredTypes.Reset();
+	Other.CachedColumnsReprepareCount = INDEX_NONE;
 }
 
 FSQLitePreparedStatement& FSQLitePreparedStatement::operator=(FSQLitePreparedStatement&& Other)
@@ -44,8 +55,22 @@ FSQLitePreparedStatement& FSQLitePreparedStatement::operator=(FSQLitePreparedSta
 		Statement = Other.Statement;
 		Other.Statement = nullptr;
 
+		bUseUTF16Text = Other.bUseUTF16Text;
+
+		CachedBindingIndices = MoveTemp(Other.CachedBindingIndices);
+		Other.CachedBindingIndices.Reset();
+
 		CachedColumnNames = MoveTemp(Other.CachedColumnNames);
 		Other.CachedColumnNames.Reset();
+
+		CachedColumnIndices = MoveTemp(Other.CachedColumnIndices);
+		Other.CachedColumnIndices.Reset();
+
+		CachedColumnDeclaredTypes = MoveTemp(Other.CachedColumnDeclaredTypes);
+		Other.CachedColumnDeclaredTypes.Reset();
+
+		CachedColumnsReprepareCount = Other.CachedColumnsReprepareCount;
+		Other.CachedColumnsReprepareCount = INDEX_NONE;
 	}
 	return *this;
 }
@@ -86,6 +111,13 @@ bool FSQLitePreparedStatement::Create(FSQLiteDatabase& InDatabase, const TCHAR*
 		return false;
 	}
 
+	// TCHAR is only UTF-16 when it's 2 bytes; otherwise it must be transcoded regardless of the database encoding
+#if !PLATFORM_TCHAR_IS_4_BYTES
+	bUseUTF16Text = InDatabase.TextEncoding == ESQLiteDatabaseTextEncoding::UTF16;
+#endif
+
+	CacheBindingNames();
+
 	return true;
 }
 
@@ -99,7 +131,11 @@ bool FSQLitePreparedStatement::Destroy()
 	sqlite3_finalize(Statement);
 	Statement = nullptr;
 
+	CachedBindingIndices.Reset();
 	CachedColumnNames.Reset();
+	CachedColumnIndices.Reset();
+	CachedColumnDeclaredTypes.Reset();
+	CachedColumnsReprepareCount = INDEX_NONE;
 
 	return true;
 }
@@ -126,12 +162,13 @@ void FSQLitePreparedStatement::ClearBindings()
 
 int32 FSQLitePreparedStatement::GetBindingIndexByName(const TCHAR* InBindingName) const
 {
-	if (!Statement)
+	if (!Statement || !InBindingName)
 	{
 		return 0;
 	}
 
-	return sqlite3_bind_parameter_index(Statement, TCHAR_TO_UTF8(InBindingName));
+	const int32* BindingIndex = CachedBindingIndices.FindByHash(SQLitePreparedStatementImpl::FBindingNameKeyFuncs::GetKeyHash(InBindingName), InBindingName);
+	return BindingIndex ? *BindingIndex : 0;
 }
 
 template <typename T>
@@ -285,12 +322,7 @@ bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName,
 
 bool FSQLitePreparedStatement::SetBindingValueByIndex(const int32 InBindingIndex, const TCHAR* InValue)
 {
-	if (!Statement || InBindingIndex < 1)
-	{
-		return false;
-	}
-
-	return sqlite3_bind_text(Statement, InBindingIndex, TCHAR_TO_UTF8(InValue), -1, SQLITE_TRANSIENT) == SQLITE_OK;
+	return SetBindingValueByIndex_Text(InBindingIndex, InValue, InValue ? FCString::Strlen(InValue) : 0);
 }
 
 bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName, const FString& InValue)
@@ -300,17 +332,20 @@ bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName,
 
 bool FSQLitePreparedStatement::SetBindingValueByIndex(const int32 InBindingIndex, const FString& InValue)
 {
-	return SetBindingValueByIndex(InBindingIndex, *InValue);
+	return SetBindingValueByIndex_Text(InBindingIndex, *InValue, InValue.Len());
 }
 
 bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName, const FName InValue)
 {
-	return SetBindingValueByName(InBindingName, *InValue.ToString());
+	return SetBindingValueByIndex(GetBindingIndexByName(InBindingName), InValue);
 }
 
 bool FSQLitePreparedStatement::SetBindingValueByIndex(const int32 InBindingIndex, const FName InValue)
 {
-	return SetBindingValueByIndex(InBindingIndex, *InValue.ToString());
+	// Build the name on the stack rather than in a temporary FString
+	TStringBuilder<NAME_SIZE> NameStr;
+	InValue.AppendString(NameStr);
+	return SetBindingValueByIndex_Text(InBindingIndex, NameStr.GetData(), NameStr.Len());
 }
 
 bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName, const FText& InValue)
@@ -327,6 +362,30 @@ bool FSQLitePreparedStatement::SetBindingValueByIndex(const int32 InBindingIndex
 	return SetBindingValueByIndex(InBindingIndex, TextStr);
 }
 
+bool FSQLitePreparedStatement::SetBindingValueByIndex_Text(const int32 InBindingIndex, const TCHAR* InValue, const int32 InValueLen)
+{
+	if (!Statement || InBindingIndex < 1)
+	{
+		return false;
+	}
+
+	if (!InValue)
+	{
+		return sqlite3_bind_null(Statement, InBindingIndex) == SQLITE_OK;
+	}
+
+#if !PLATFORM_TCHAR_IS_4_BYTES
+	if (bUseUTF16Text)
+	{
+		// The string is already in the database encoding, so SQLite only needs to copy it
+		return sqlite3_bind_text16(Statement, InBindingIndex, InValue, InValueLen * sizeof(TCHAR), SQLITE_TRANSIENT) == SQLITE_OK;
+	}
+#endif
+
+	const FTCHARToUTF8 ValueUTF8(InValue, InValueLen);
+	return sqlite3_bind_text(Statement, InBindingIndex, ValueUTF8.Get(), ValueUTF8.Length(), SQLITE_TRANSIENT) == SQLITE_OK;
+}
+
 bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName, TArrayView<const uint8> InBlobData, const bool bCopy)
 {
 	return SetBindingValueByName(InBindingName, InBlobData.GetData(), InBlobData.Num(), bCopy);
@@ -367,6 +426,67 @@ bool FSQLitePreparedStatement::SetBindingValueByIndex(const int32 InBindingIndex
 	return SetBindingValueByIndex(InBindingIndex, GuidBytes, true);
 }
 
+bool FSQLitePreparedStatement::SetBindingZeroBlobByName(const TCHAR* InBindingName, const int64 InBlobSizeBytes)
+{
+	return SetBindingZeroBlobByIndex(GetBindingIndexByName(InBindingName), InBlobSizeBytes);
+}
+
+bool FSQLitePreparedStatement::SetBindingZeroBlobByIndex(const int32 InBindingIndex, const int64 InBlobSizeBytes)
+{
+	if (!Statement || InBindingIndex < 1 || InBlobSizeBytes < 0)
+	{
+		return false;
+	}
+
+	return sqlite3_bind_zeroblob64(Statement, InBindingIndex, (sqlite3_uint64)InBlobSizeBytes) == SQLITE_OK;
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<int64> InValues)
+{
+	return SetBindingArrayByIndex(GetBindingIndexByName(InBindingName), InValues);
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<int64> InValues)
+{
+	if (!Statement || InBindingIndex < 1)
+	{
+		return false;
+	}
+
+	// SQLite takes ownership of the array, and destroys it on failure, or once it's rebound or the statement is finalized
+	return sqlite3_bind_pointer(Statement, InBindingIndex, new FSQLiteArrayBinding(InValues), FSQLiteArrayBinding::PointerType, &FSQLiteArrayBinding::Destroy) == SQLITE_OK;
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<FString> InValues)
+{
+	return SetBindingArrayByIndex(GetBindingIndexByName(InBindingName), InValues);
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<FString> InValues)
+{
+	if (!Statement || InBindingIndex < 1)
+	{
+		return false;
+	}
+
+	return sqlite3_bind_pointer(Statement, InBindingIndex, new FSQLiteArrayBinding(InValues), FSQLiteArrayBinding::PointerType, &FSQLiteArrayBinding::Destroy) == SQLITE_OK;
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<FGuid> InValues)
+{
+	return SetBindingArrayByIndex(GetBindingIndexByName(InBindingName), InValues);
+}
+
+bool FSQLitePreparedStatement::SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<FGuid> InValues)
+{
+	if (!Statement || InBindingIndex < 1)
+	{
+		return false;
+	}
+
+	return sqlite3_bind_pointer(Statement, InBindingIndex, new FSQLiteArrayBinding(InValues), FSQLiteArrayBinding::PointerType, &FSQLiteArrayBinding::Destroy) == SQLITE_OK;
+}
+
 bool FSQLitePreparedStatement::SetBindingValueByName(const TCHAR* InBindingName)
 {
 	return SetBindingValueByIndex(GetBindingIndexByName(InBindingName));
@@ -419,6 +539,72 @@ int64 FSQLitePreparedStatement::Execute(TFunctionRef<ESQLitePreparedStatementExe
 		: RowCount;
 }
 
+int64 FSQLitePreparedStatement::ExecuteBatch(const int64 InNumRows, TFunctionRef<bool(const int64 InRowIndex)> InBindRowCallback, FString* OutErrorMessage)
+{
+	checkf(IsValid() && !IsActive(), TEXT("SQLite statement must be valid and not-active!"));
+
+	// A savepoint begins a transaction if there isn't one already (so the batch is committed once, rather than once per row), or nests within the current transaction if there is
+	sqlite3* Database = sqlite3_db_handle(Statement);
+	if (sqlite3_exec(Database, "SAVEPOINT ue_execute_batch;", nullptr, nullptr, nullptr) != SQLITE_OK)
+	{
+		const FString ErrorMessage = UTF8_TO_TCHAR(sqlite3_errmsg(Database));
+		UE_LOG(LogSQLitePreparedStatement, Warning, TEXT("Failed to begin batch execution: %s"), *ErrorMessage);
+		if (OutErrorMessage)
+		{
+			*OutErrorMessage = ErrorMessage;
+		}
+		return INDEX_NONE;
+	}
+
+	// The rollback below replaces the last error of the database, so the error that failed the batch has to be captured before it
+	FString ErrorMessage;
+
+	int64 NumRowsExecuted = 0;
+	for (; NumRowsExecuted < InNumRows; ++NumRowsExecuted)
+	{
+		if (!InBindRowCallback(NumRowsExecuted))
+		{
+			ErrorMessage = FString::Printf(TEXT("Failed to bind row %lld of batch"), NumRowsExecuted);
+			break;
+		}
+
+		// Step it to completion (or error); any result rows are ignored
+		ESQLitePreparedStatementStepResult StepResult = ESQLitePreparedStatementStepResult::Done;
+		while ((StepResult = Step()) == ESQLitePreparedStatementStepResult::Row)
+		{
+		}
+
+		if (StepResult != ESQLitePreparedStatementStepResult::Done)
+		{
+			ErrorMessage = UTF8_TO_TCHAR(sqlite3_errmsg(Database));
+			UE_LOG(LogSQLitePreparedStatement, Warning, TEXT("Failed to execute row %lld of batch: %s"), NumRowsExecuted, *ErrorMessage);
+			Reset();
+			break;
+		}
+
+		Reset();
+	}
+
+	ClearBindings();
+
+	if (NumRowsExecuted == InNumRows)
+	{
+		if (sqlite3_exec(Database, "RELEASE ue_execute_batch;", nullptr, nullptr, nullptr) == SQLITE_OK)
+		{
+			return NumRowsExecuted;
+		}
+		ErrorMessage = UTF8_TO_TCHAR(sqlite3_errmsg(Database));
+	}
+
+	// Undo any rows that were executed, and end the savepoint (and its transaction, if it began one)
+	sqlite3_exec(Database, "ROLLBACK TO ue_execute_batch; RELEASE ue_execute_batch;", nullptr, nullptr, nullptr);
+	if (OutErrorMessage)
+	{
+		*OutErrorMessage = MoveTemp(ErrorMessage);
+	}
+	return INDEX_NONE;
+}
+
 ESQLitePreparedStatementStepResult FSQLitePreparedStatement::Step()
 {
 	if (!Statement)
@@ -443,10 +629,14 @@ ESQLitePreparedStatementStepResult FSQLitePreparedStatement::Step()
 int32 FSQLitePreparedStatement::GetColumnIndexByName(const TCHAR* InColumnName) const
 {
 	CacheColumnNames();
-	return CachedColumnNames.IndexOfByPredicate([&InColumnName](const FString& InPotentialMatch)
+	if (!InColumnName)
 	{
-		return FCString::Stricmp(*InPotentialMatch, InColumnName) == 0; // Column names are case-insensitive
-	});
+		return INDEX_NONE;
+	}
+
+	// Column names are case-insensitive
+	const int32* ColumnIndex = CachedColumnIndices.FindByHash(SQLitePreparedStatementImpl::FColumnNameKeyFuncs::GetKeyHash(InColumnName), InColumnName);
+	return ColumnIndex ? *ColumnIndex : INDEX_NONE;
 }
 
 template <typename T>
@@ -601,75 +791,136 @@ bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex,
 	return GetColumnValueByIndex_Real(InColumnIndex, OutValue);
 }
 
-bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, FString& OutValue) const
-{
-	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
-}
-
-bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FString& OutValue) const
+template <typename CallbackType>
+bool FSQLitePreparedStatement::GetColumnValueByIndex_Text(const int32 InColumnIndex, CallbackType&& InCallback) const
 {
 	if (!Statement || !IsValidColumnIndex(InColumnIndex))
 	{
 		return false;
 	}
 
+	// Note: sqlite3_column_bytes must be called after sqlite3_column_text, as the text call may convert the value
+#if !PLATFORM_TCHAR_IS_4_BYTES
+	if (bUseUTF16Text)
+	{
+		// The string is already in the database encoding, so can be used as-is
+		const TCHAR* ColumnValueUTF16 = (const TCHAR*)sqlite3_column_text16(Statement, InColumnIndex);
+		const int32 ColumnValueUTF16Len = sqlite3_column_bytes16(Statement, InColumnIndex) / sizeof(TCHAR);
+		InCallback(ColumnValueUTF16 ? ColumnValueUTF16 : TEXT(""), ColumnValueUTF16 ? ColumnValueUTF16Len : 0);
+		return true;
+	}
+#endif
+
 	const char* ColumnValueUTF8 = (const char*)sqlite3_column_text(Statement, InColumnIndex);
-	OutValue = ColumnValueUTF8 ? UTF8_TO_TCHAR(ColumnValueUTF8) : TEXT("");
+	const int32 ColumnValueUTF8SizeBytes = sqlite3_column_bytes(Statement, InColumnIndex);
+	if (!ColumnValueUTF8)
+	{
+		InCallback(TEXT(""), 0);
+		return true;
+	}
+
+	const FUTF8ToTCHAR ColumnValue(ColumnValueUTF8, ColumnValueUTF8SizeBytes);
+	InCallback(ColumnValue.Get(), ColumnValue.Length());
 	return true;
 }
 
+bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, FString& OutValue) const
+{
+	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
+}
+
+bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FString& OutValue) const
+{
+	return GetColumnValueByIndex_Text(InColumnIndex, [&OutValue](const TCHAR* InValue, const int32 InValueLen)
+	{
+		OutValue = FString(InValueLen, InValue);
+	});
+}
+
 bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, FName& OutValue) const
 {
 	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
 }
 
 bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FName& OutValue) const
+{
+	return GetColumnValueByIndex_Text(InColumnIndex, [&OutValue](const TCHAR* InValue, const int32 InValueLen)
+	{
+		OutValue = FName(InValueLen, InValue);
+	});
+}
+
+bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, FText& OutValue) const
+{
+	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
+}
+
+bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FText& OutValue) const
+{
+	return GetColumnValueByIndex_Text(InColumnIndex, [&OutValue](const TCHAR* InValue, const int32 InValueLen)
+	{
+		OutValue = FTextStringHelper::CreateFromBuffer(*FString(InValueLen, InValue));
+	});
+}
+
+bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, TArray<uint8>& OutValue) const
+{
+	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
+}
+
+bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, TArray<uint8>& OutValue) const
 {
 	if (!Statement || !IsValidColumnIndex(InColumnIndex))
 	{
 		return false;
 	}
 
-	const char* ColumnValueUTF8 = (const char*)sqlite3_column_text(Statement, InColumnIndex);
-	OutValue = FName(ColumnValueUTF8 ? UTF8_TO_TCHAR(ColumnValueUTF8) : TEXT(""));
+	const uint8* ColumnValueBlob = (const uint8*)sqlite3_column_blob(Statement, InColumnIndex);
+	const int32 ColumnValueBlobSizeBytes = sqlite3_column_bytes(Statement, InColumnIndex);
+
+	OutValue.Reset();
+	OutValue.Append(ColumnValueBlob, ColumnValueBlobSizeBytes);
+
 	return true;
 }
 
-bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, FText& OutValue) const
+bool FSQLitePreparedStatement::GetColumnUtf8ViewByName(const TCHAR* InColumnName, FUtf8StringView& OutValue) const
 {
-	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
+	return GetColumnUtf8ViewByIndex(GetColumnIndexByName(InColumnName), OutValue);
 }
 
-bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FText& OutValue) const
+bool FSQLitePreparedStatement::GetColumnUtf8ViewByIndex(const int32 InColumnIndex, FUtf8StringView& OutValue) const
 {
 	if (!Statement || !IsValidColumnIndex(InColumnIndex))
 	{
 		return false;
 	}
 
-	const char* ColumnValueUTF8 = (const char*)sqlite3_column_text(Statement, InColumnIndex);
-	OutValue = FTextStringHelper::CreateFromBuffer(ColumnValueUTF8 ? UTF8_TO_TCHAR(ColumnValueUTF8) : TEXT(""));
+	// sqlite3_column_bytes must be called after sqlite3_column_text, as the text call may convert the value
+	const UTF8CHAR* ColumnValueUTF8 = (const UTF8CHAR*)sqlite3_column_text(Statement, InColumnIndex);
+	const int32 ColumnValueUTF8SizeBytes = sqlite3_column_bytes(Statement, InColumnIndex);
+
+	OutValue = ColumnValueUTF8 ? FUtf8StringView(ColumnValueUTF8, ColumnValueUTF8SizeBytes) : FUtf8StringView();
 	return true;
 }
 
-bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, TArray<uint8>& OutValue) const
+bool FSQLitePreparedStatement::GetColumnBlobViewByName(const TCHAR* InColumnName, TArrayView<const uint8>& OutValue) const
 {
-	return GetColumnValueByIndex(GetColumnIndexByName(InColumnName), OutValue);
+	return GetColumnBlobViewByIndex(GetColumnIndexByName(InColumnName), OutValue);
 }
 
-bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, TArray<uint8>& OutValue) const
+bool FSQLitePreparedStatement::GetColumnBlobViewByIndex(const int32 InColumnIndex, TArrayView<const uint8>& OutValue) const
 {
 	if (!Statement || !IsValidColumnIndex(InColumnIndex))
 	{
 		return false;
 	}
 
+	// sqlite3_column_bytes must be called after sqlite3_column_blob, as the blob call may convert the value
 	const uint8* ColumnValueBlob = (const uint8*)sqlite3_column_blob(Statement, InColumnIndex);
 	const int32 ColumnValueBlobSizeBytes = sqlite3_column_bytes(Statement, InColumnIndex);
 
-	OutValue.Reset();
-	OutValue.Append(ColumnValueBlob, ColumnValueBlobSizeBytes);
-
+	OutValue = TArrayView<const uint8>(ColumnValueBlob, ColumnValueBlob ? ColumnValueBlobSizeBytes : 0);
 	return true;
 }
 
@@ -680,10 +931,10 @@ bool FSQLitePreparedStatement::GetColumnValueByName(const TCHAR* InColumnName, F
 
 bool FSQLitePreparedStatement::GetColumnValueByIndex(const int32 InColumnIndex, FGuid& OutValue) const
 {
-	TArray<uint8> GuidBytes;
-	if (GetColumnValueByIndex(InColumnIndex, GuidBytes))
+	TArrayView<const uint8> GuidBytes;
+	if (GetColumnBlobViewByIndex(InColumnIndex, GuidBytes))
 	{
-		FMemoryReader GuidReader(GuidBytes);
+		FMemoryReaderView GuidReader(GuidBytes);
 		GuidReader << OutValue;
 		return !GuidReader.GetError();
 	}
@@ -719,26 +970,97 @@ bool FSQLitePreparedStatement::GetColumnTypeByIndex(const int32 InColumnIndex, E
 	return true;
 }
 
+bool FSQLitePreparedStatement::GetColumnDeclaredTypeByName(const TCHAR* InColumnName, FString& OutDeclaredType) const
+{
+	return GetColumnDeclaredTypeByIndex(GetColumnIndexByName(InColumnName), OutDeclaredType);
+}
+
+bool FSQLitePreparedStatement::GetColumnDeclaredTypeByIndex(const int32 InColumnIndex, FString& OutDeclaredType) const
+{
+	if (!Statement || !IsValidColumnIndex(InColumnIndex))
+	{
+		return false;
+	}
+
+	OutDeclaredType = CachedColumnDeclaredTypes[InColumnIndex];
+	return true;
+}
+
 const TArray<FString>& FSQLitePreparedStatement::GetColumnNames() const
 {
 	CacheColumnNames();
 	return CachedColumnNames;
 }
 
+const TArray<FString>& FSQLitePreparedStatement::GetColumnDeclaredTypes() const
+{
+	CacheColumnNames();
+	return CachedColumnDeclaredTypes;
+}
+
+int32 FSQLitePreparedStatement::GetReprepareCount() const
+{
+	return Statement ? sqlite3_stmt_status(Statement, SQLITE_STMTSTATUS_REPREPARE, 0) : 0;
+}
+
+void FSQLitePreparedStatement::CacheBindingNames()
+{
+	CachedBindingIndices.Reset();
+
+	if (!Statement)
+	{
+		return;
+	}
+
+	// Binding indices are 1-based; anonymous bindings (eg, "?") have no name and can only be set by index
+	const int32 BindingCount = sqlite3_bind_parameter_count(Statement);
+	for (int32 BindingIndex = 1; BindingIndex <= BindingCount; ++BindingIndex)
+	{
+		if (const char* BindingNameUTF8 = sqlite3_bind_parameter_name(Statement, BindingIndex))
+		{
+			// A name used more than once in the statement shares a single index, so each name is only reported once
+			CachedBindingIndices.Add(UTF8_TO_TCHAR(BindingNameUTF8), BindingIndex);
+		}
+	}
+}
+
 void FSQLitePreparedStatement::CacheColumnNames() const
 {
-	if (!Statement || CachedColumnNames.Num() > 0)
+	if (!Statement)
+	{
+		return;
+	}
+
+	// A statement re-prepared after a schema change (eg, a SELECT * after an ALTER TABLE) may have different columns
+	const int32 ReprepareCount = GetReprepareCount();
+	if (CachedColumnsReprepareCount == ReprepareCount)
 	{
 		return;
 	}
 
+	CachedColumnNames.Reset();
+	CachedColumnIndices.Reset();
+	CachedColumnDeclaredTypes.Reset();
+	CachedColumnsReprepareCount = ReprepareCount;
+
 	const int32 ColumnCount = sqlite3_column_count(Statement);
 	CachedColumnNames.Reserve(ColumnCount);
+	CachedColumnIndices.Reserve(ColumnCount);
+	CachedColumnDeclaredTypes.Reserve(ColumnCount);
 
 	for (int32 ColumnIndex = 0; ColumnIndex < ColumnCount; ++ColumnIndex)
 	{
 		const char* ColumnNameUTF8 = sqlite3_column_name(Statement, ColumnIndex);
-		CachedColumnNames.Emplace(ColumnNameUTF8 ? UTF8_TO_TCHAR(ColumnNameUTF8) : TEXT(""));
+		const FString& ColumnName = CachedColumnNames.Emplace_GetRef(ColumnNameUTF8 ? UTF8_TO_TCHAR(ColumnNameUTF8) : TEXT(""));
+
+		// Result sets may contain the same name more than once (eg, joins), in which case the first column with the name wins
+		if (!CachedColumnIndices.Contains(ColumnName))
+		{
+			CachedColumnIndices.Add(ColumnName, ColumnIndex);
+		}
+
+		const char* ColumnDeclaredTypeUTF8 = sqlite3_column_decltype(Statement, ColumnIndex);
+		CachedColumnDeclaredTypes.Emplace(ColumnDeclaredTypeUTF8 ? UTF8_TO_TCHAR(ColumnDeclaredTypeUTF8) : TEXT(""));
 	}
 }
 
@@ -2,6 +2,8 @@
 
 #include "SqliteCoreX.h"
 #include "IncludeSQLite.h"
+#include "SQLitePageCache.h"
+#include "SQLiteArrayFunction.h"
 
 IMPLEMENT_MODULE(FSqliteCoreX, SqliteCoreX)
 
@@ -28,7 +30,16 @@ void FSqliteCoreX::StaticInitializeSQLite()
 		}
 #endif
 
+		// All connections share a single, budgeted, page cache
+		FSQLitePageCache::Register();
+
 		bInitializedSQLite = sqlite3_initialize() == SQLITE_OK;
+
+		// Make the carray function available to every connection opened from now on
+		if (bInitializedSQLite)
+		{
+			FSQLiteArrayFunction::Register();
+		}
 	}
 }
 
@@ -36,6 +47,7 @@ void FSqliteCoreX::StaticShutdownSQLite()
 {
 	if (bInitializedSQLite)
 	{
+		sqlite3_reset_auto_extension();
 		sqlite3_shutdown();
 	}
 }
@@ -2,9 +2,16 @@
 
 #include "CoreMinimal.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
 #include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "SQLiteDatabase.h"
+#include "SQLiteBlobArchive.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "sqlite/sqlite3.h"
+THIRD_PARTY_INCLUDES_END
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -84,4 +91,1009 @@ bool FSQLiteCoreTest::RunTest(const FString& Parameters)
 	return bSuccess;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreWALTest, "System.Plugins.Database.SQLiteCore.WAL", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that WAL journaling works through the UE5 abstraction layer. If this test fails, this is likely because the shared memory functions
+ * in SQLiteEmbeddedPlatform.cpp (ShmMap, ShmLock, ShmBarrier, ShmUnmap) are broken.
+ */
+bool FSQLiteCoreWALTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteWALTest.db");
+	IFileManager::Get().Delete(*Path);
+	bool bSuccess = true;
+
+	// Write some records while in WAL mode
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+		bSuccess &= TestDb.SetJournalMode(ESQLiteDatabaseJournalMode::WAL);
+
+		ESQLiteDatabaseJournalMode JournalMode = ESQLiteDatabaseJournalMode::Delete;
+		bSuccess &= TestDb.GetJournalMode(JournalMode);
+		bSuccess &= (JournalMode == ESQLiteDatabaseJournalMode::WAL);
+
+		bSuccess &= TestDb.Execute(TEXT("CREATE TABLE users (id INTEGER NOT NULL,name TEXT)"));
+		bSuccess &= TestDb.Execute(TEXT("BEGIN"));
+		bSuccess &= TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (1, 'John')"));
+		bSuccess &= TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (2, 'Mark')"));
+		bSuccess &= TestDb.Execute(TEXT("COMMIT"));
+		bSuccess &= TestDb.Close();
+	}
+
+	// Check the records were checkpointed back into the database (the journal mode is persistent for WAL)
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWrite);
+
+		int64 NumUsers = 0;
+		bSuccess &= TestDb.Execute(TEXT("SELECT count(*) FROM users"), [&NumUsers](const FSQLitePreparedStatement& InStatement)
+		{
+			InStatement.GetColumnValueByIndex(0, NumUsers);
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		}) == 1;
+		bSuccess &= (NumUsers == 2);
+
+		bSuccess &= TestDb.SetJournalMode(ESQLiteDatabaseJournalMode::Delete);
+		bSuccess &= TestDb.Close();
+	}
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreInMemoryTest, "System.Plugins.Database.SQLiteCore.InMemory", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that a database file can be loaded into memory, and that an in-memory database can be serialized and opened again.
+ */
+bool FSQLiteCoreInMemoryTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteInMemoryTest.db");
+	IFileManager::Get().Delete(*Path);
+	bool bSuccess = true;
+
+	auto CountUsers = [](FSQLiteDatabase& InDatabase)
+	{
+		int64 NumUsers = 0;
+		InDatabase.Execute(TEXT("SELECT count(*) FROM users"), [&NumUsers](const FSQLitePreparedStatement& InStatement)
+		{
+			InStatement.GetColumnValueByIndex(0, NumUsers);
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		});
+		return NumUsers;
+	};
+
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+		bSuccess &= TestDb.Execute(TEXT("CREATE TABLE users (id INTEGER NOT NULL,name TEXT)"));
+		bSuccess &= TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (1, 'John')"));
+		bSuccess &= TestDb.Close();
+	}
+
+	TArray<uint8> DatabaseImage;
+
+	// Load the file into memory, and make sure changes don't go back to the file
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.OpenFileIntoMemory(*Path);
+		bSuccess &= (CountUsers(TestDb) == 1);
+		bSuccess &= TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (2, 'Mark')"));
+		bSuccess &= (CountUsers(TestDb) == 2);
+		bSuccess &= TestDb.Serialize(DatabaseImage);
+		bSuccess &= TestDb.Close();
+	}
+
+	// Open the serialized image read-only
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.OpenFromMemory(DatabaseImage, ESQLiteDatabaseOpenMode::ReadOnly);
+		bSuccess &= (CountUsers(TestDb) == 2);
+		bSuccess &= !TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (3, 'Jane')"));
+		bSuccess &= TestDb.Close();
+	}
+
+	// An empty image opened read-only is an empty database that can't be written
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.OpenFromMemory(TArrayView<const uint8>(), ESQLiteDatabaseOpenMode::ReadOnly);
+		bSuccess &= !TestDb.Execute(TEXT("CREATE TABLE users (id INTEGER NOT NULL,name TEXT)"));
+		bSuccess &= TestDb.Close();
+	}
+
+	// The file itself is untouched
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadOnly);
+		bSuccess &= (CountUsers(TestDb) == 1);
+		bSuccess &= TestDb.Close();
+	}
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreSchemaChangeTest, "System.Plugins.Database.SQLiteCore.SchemaChange", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that the cached columns of a statement are refreshed once SQLite re-prepares it after a schema change.
+ */
+bool FSQLiteCoreSchemaChangeTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.OpenFromMemory(TArrayView<const uint8>(), ESQLiteDatabaseOpenMode::ReadWrite);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE users (id INTEGER NOT NULL,name TEXT)"));
+	bSuccess &= TestDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (1, 'John')"));
+
+	{
+		FSQLitePreparedStatement Statement(TestDb, TEXT("SELECT * FROM users"), ESQLitePreparedStatementFlags::Persistent);
+		bSuccess &= Statement.Step() == ESQLitePreparedStatementStepResult::Row;
+		bSuccess &= Statement.GetColumnNames().Num() == 2 && Statement.GetColumnIndexByName(TEXT("age")) == INDEX_NONE;
+		const int32 ReprepareCount = Statement.GetReprepareCount();
+		Statement.Reset();
+
+		// The statement is re-prepared with the new column on its next step
+		bSuccess &= TestDb.Execute(TEXT("ALTER TABLE users ADD COLUMN age INTEGER DEFAULT 42"));
+		bSuccess &= Statement.Step() == ESQLitePreparedStatementStepResult::Row;
+		bSuccess &= Statement.GetReprepareCount() != ReprepareCount;
+		bSuccess &= Statement.GetColumnNames().Num() == 3 && Statement.GetColumnDeclaredTypes().Num() == 3;
+
+		int64 Age = 0;
+		bSuccess &= Statement.GetColumnIndexByName(TEXT("age")) == 2 && Statement.GetColumnValueByName(TEXT("age"), Age) && Age == 42;
+		Statement.Reset();
+	}
+
+	bSuccess &= TestDb.Close();
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreMultipleConnectionsTest, "System.Plugins.Database.SQLiteCore.MultipleConnections", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that multiple connections can have the same file open, and that the file locks arbitrate between them. If this test fails, this is likely
+ * because the file locking functions in SQLiteEmbeddedPlatform.cpp (Lock, Unlock, CheckReservedLock) are broken.
+ */
+bool FSQLiteCoreMultipleConnectionsTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteMultipleConnectionsTest.db");
+	IFileManager::Get().Delete(*Path);
+	bool bSuccess = true;
+
+	auto CountUsers = [](FSQLiteDatabase& InDatabase)
+	{
+		int64 NumUsers = 0;
+		InDatabase.Execute(TEXT("SELECT count(*) FROM users"), [&NumUsers](const FSQLitePreparedStatement& InStatement)
+		{
+			InStatement.GetColumnValueByIndex(0, NumUsers);
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		});
+		return NumUsers;
+	};
+
+	FSQLiteDatabase WriterDb;
+	bSuccess &= WriterDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= WriterDb.Execute(TEXT("CREATE TABLE users (id INTEGER NOT NULL,name TEXT)"));
+	bSuccess &= WriterDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (1, 'John')"));
+
+	FSQLiteDatabase ReaderDb;
+	bSuccess &= ReaderDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWrite);
+	bSuccess &= (CountUsers(ReaderDb) == 1);
+
+	// While the writer holds a RESERVED lock, other connections can still read (the last committed state) but not write
+	bSuccess &= WriterDb.Execute(TEXT("BEGIN IMMEDIATE"));
+	bSuccess &= WriterDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (2, 'Mark')"));
+	bSuccess &= (CountUsers(ReaderDb) == 1);
+	bSuccess &= !ReaderDb.Execute(TEXT("BEGIN IMMEDIATE"));
+	bSuccess &= WriterDb.Execute(TEXT("COMMIT"));
+
+	// Once committed, the other connection sees the change and can write itself
+	bSuccess &= (CountUsers(ReaderDb) == 2);
+	bSuccess &= ReaderDb.Execute(TEXT("INSERT INTO users (id, name) VALUES (3, 'Jane')"));
+	bSuccess &= (CountUsers(WriterDb) == 3);
+
+	bSuccess &= ReaderDb.Close();
+	bSuccess &= WriterDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreBlobArchiveTest, "System.Plugins.Database.SQLiteCore.BlobArchive", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that blobs can be written and read incrementally through FSQLiteBlobArchive, and that the archive can be reopened on other rows.
+ */
+bool FSQLiteCoreBlobArchiveTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteBlobArchiveTest.db");
+	IFileManager::Get().Delete(*Path);
+	bool bSuccess = true;
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE saves (id INTEGER PRIMARY KEY, state BLOB)"));
+
+	// Reserve space for each blob, then stream the data into it in chunks
+	const int32 NumRows = 3;
+	const int32 NumValuesPerRow = 64 * 1024;
+	{
+		FSQLitePreparedStatement InsertStatement = TestDb.PrepareStatement(TEXT("INSERT INTO saves (id, state) VALUES (?1, ?2)"));
+		for (int32 RowIndex = 1; RowIndex <= NumRows; ++RowIndex)
+		{
+			bSuccess &= InsertStatement.SetBindingValueByIndex(1, RowIndex);
+			bSuccess &= InsertStatement.SetBindingZeroBlobByIndex(2, NumValuesPerRow * sizeof(int32));
+			bSuccess &= InsertStatement.Execute();
+		}
+	}
+	{
+		FSQLiteBlobArchive Writer(TestDb, TEXT("saves"), TEXT("state"), 1, /*bInIsSaving*/true);
+		bSuccess &= Writer.IsValid();
+		for (int32 RowIndex = 1; RowIndex <= NumRows; ++RowIndex)
+		{
+			bSuccess &= (RowIndex == 1 || Writer.Reopen(RowIndex));
+			for (int32 ValueIndex = 0; ValueIndex < NumValuesPerRow; ++ValueIndex)
+			{
+				int32 Value = RowIndex * ValueIndex;
+				Writer << Value;
+			}
+			bSuccess &= !Writer.IsError();
+		}
+
+		// Writing past the end of the reserved space is an error
+		AddExpectedError(TEXT("Attempted to serialize"), EAutomationExpectedErrorFlags::Contains, 1);
+		int32 Value = 0;
+		Writer << Value;
+		bSuccess &= Writer.IsError();
+	}
+
+	// Read the data back
+	{
+		FSQLiteBlobArchive Reader(TestDb, TEXT("saves"), TEXT("state"), 1);
+		bSuccess &= Reader.IsValid();
+		for (int32 RowIndex = 1; RowIndex <= NumRows; ++RowIndex)
+		{
+			bSuccess &= (RowIndex == 1 || Reader.Reopen(RowIndex));
+			bSuccess &= (Reader.TotalSize() == NumValuesPerRow * sizeof(int32));
+			for (int32 ValueIndex = 0; ValueIndex < NumValuesPerRow; ++ValueIndex)
+			{
+				int32 Value = 0;
+				Reader << Value;
+				bSuccess &= (Value == RowIndex * ValueIndex);
+			}
+			bSuccess &= !Reader.IsError();
+		}
+
+		// Reopening a row that doesn't exist fails
+		bSuccess &= !Reader.Reopen(NumRows + 1);
+	}
+
+	bSuccess &= TestDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreTextEncodingTest, "System.Plugins.Database.SQLiteCore.TextEncoding", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that strings round-trip through both UTF-8 and UTF-16 databases, and that the encoding of a database is detected when it is opened again.
+ */
+bool FSQLiteCoreTextEncodingTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	const FString TestString = TEXT("Caf\u00E9 \u65E5\u672C \U0001F600");
+	const FName TestName = TEXT("Test_Name");
+
+	auto RoundTripStrings = [&TestString, &TestName](FSQLiteDatabase& InDatabase)
+	{
+		bool bSucceeded = true;
+
+		FSQLitePreparedStatement InsertStatement = InDatabase.PrepareStatement(TEXT("INSERT INTO strings (str, name) VALUES (?1, ?2)"));
+		bSucceeded &= InsertStatement.SetBindingValueByIndex(1, TestString);
+		bSucceeded &= InsertStatement.SetBindingValueByIndex(2, TestName);
+		bSucceeded &= InsertStatement.Execute();
+
+		bSucceeded &= InDatabase.Execute(TEXT("SELECT str, name, length(str) FROM strings"), [&](const FSQLitePreparedStatement& InStatement)
+		{
+			FString Str;
+			FName Name;
+			int32 StrLength = 0;
+			bSucceeded &= InStatement.GetColumnValueByIndex(0, Str) && Str == TestString;
+			bSucceeded &= InStatement.GetColumnValueByIndex(1, Name) && Name == TestName;
+			bSucceeded &= InStatement.GetColumnValueByIndex(2, StrLength) && StrLength == 9; // SQLite counts code points rather than UTF-16 code units
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		}) == 1;
+
+		return bSucceeded;
+	};
+
+	for (const ESQLiteDatabaseTextEncoding TextEncoding : { ESQLiteDatabaseTextEncoding::UTF8, ESQLiteDatabaseTextEncoding::UTF16 })
+	{
+		FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteTextEncodingTest.db");
+		IFileManager::Get().Delete(*Path);
+
+		{
+			FSQLiteDatabase TestDb;
+			bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+			bSuccess &= TestDb.SetTextEncoding(TextEncoding);
+			bSuccess &= TestDb.Execute(TEXT("CREATE TABLE strings (str TEXT, name TEXT)"));
+			bSuccess &= RoundTripStrings(TestDb);
+			bSuccess &= TestDb.Close();
+		}
+
+		{
+			FSQLiteDatabase TestDb;
+			ESQLiteDatabaseTextEncoding OpenedTextEncoding;
+			bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWrite);
+			bSuccess &= TestDb.GetTextEncoding(OpenedTextEncoding) && OpenedTextEncoding == TextEncoding;
+			bSuccess &= RoundTripStrings(TestDb);
+			bSuccess &= TestDb.Close();
+		}
+
+		IFileManager::Get().Delete(*Path);
+	}
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreExecuteBatchTest, "System.Plugins.Database.SQLiteCore.ExecuteBatch", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that a batch of rows is executed as a single unit: every row is applied on success, and none are applied if any row fails.
+ */
+bool FSQLiteCoreExecuteBatchTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	SQLITE_PREPARED_STATEMENT(FInsertUserStatement, "INSERT INTO users (id, name) VALUES (?1, ?2)", SQLITE_PREPARED_STATEMENT_COLUMNS(), SQLITE_PREPARED_STATEMENT_BINDINGS(int64, FString));
+
+	auto CountUsers = [](FSQLiteDatabase& InDatabase)
+	{
+		int64 NumUsers = 0;
+		InDatabase.Execute(TEXT("SELECT count(*) FROM users"), [&NumUsers](const FSQLitePreparedStatement& InStatement)
+		{
+			InStatement.GetColumnValueByIndex(0, NumUsers);
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		});
+		return NumUsers;
+	};
+
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteExecuteBatchTest.db");
+	IFileManager::Get().Delete(*Path);
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT)"));
+
+	FInsertUserStatement InsertStatement = TestDb.PrepareStatement<FInsertUserStatement>(ESQLitePreparedStatementFlags::Persistent);
+
+	TArray<TTuple<int64, FString>> Users;
+	for (int64 UserId = 1; UserId <= 100; ++UserId)
+	{
+		Users.Emplace(UserId, FString::Printf(TEXT("User%lld"), UserId));
+	}
+	bSuccess &= (InsertStatement.ExecuteBatch(Users) == Users.Num());
+	bSuccess &= (CountUsers(TestDb) == Users.Num());
+
+	// The last row collides with an existing id, so the whole batch is rolled back
+	TArray<TTuple<int64, FString>> CollidingUsers;
+	CollidingUsers.Emplace(101, TEXT("Mark"));
+	CollidingUsers.Emplace(102, TEXT("Jane"));
+	CollidingUsers.Emplace(1, TEXT("John"));
+	bSuccess &= (InsertStatement.ExecuteBatch(CollidingUsers) == INDEX_NONE);
+	bSuccess &= (CountUsers(TestDb) == Users.Num());
+
+	// The error that failed the batch is still reported once the batch has been rolled back
+	FString BatchError;
+	bSuccess &= (InsertStatement.FSQLitePreparedStatement::ExecuteBatch(CollidingUsers.Num(), [&InsertStatement, &CollidingUsers](const int64 InRowIndex)
+	{
+		return InsertStatement.SetBindingValues(CollidingUsers[InRowIndex].Get<0>(), CollidingUsers[InRowIndex].Get<1>());
+	}, &BatchError) == INDEX_NONE);
+	bSuccess &= BatchError.Contains(TEXT("UNIQUE"));
+	bSuccess &= (CountUsers(TestDb) == Users.Num());
+
+	InsertStatement.Destroy();
+	bSuccess &= TestDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreArrayBindingTest, "System.Plugins.Database.SQLiteCore.ArrayBinding", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that arrays bound to a single parameter are expanded by the carray function, for each supported value type.
+ */
+bool FSQLiteCoreArrayBindingTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteArrayBindingTest.db");
+	IFileManager::Get().Delete(*Path);
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT, guid BLOB)"));
+
+	TArray<FGuid> Guids;
+	{
+		FSQLitePreparedStatement InsertStatement = TestDb.PrepareStatement(TEXT("INSERT INTO items (id, name, guid) VALUES (?1, ?2, ?3)"));
+		for (int64 ItemId = 1; ItemId <= 10; ++ItemId)
+		{
+			const FGuid& Guid = Guids.Add_GetRef(FGuid::NewGuid());
+			bSuccess &= InsertStatement.SetBindingValueByIndex(1, ItemId);
+			bSuccess &= InsertStatement.SetBindingValueByIndex(2, FString::Printf(TEXT("Item%lld"), ItemId));
+			bSuccess &= InsertStatement.SetBindingValueByIndex(3, Guid);
+			bSuccess &= InsertStatement.Execute();
+		}
+	}
+
+	auto CountMatches = [&TestDb](const TCHAR* InStatement, TFunctionRef<bool(FSQLitePreparedStatement&)> InBindArray)
+	{
+		int64 NumMatches = INDEX_NONE;
+		FSQLitePreparedStatement CountStatement = TestDb.PrepareStatement(InStatement);
+		if (InBindArray(CountStatement))
+		{
+			CountStatement.Execute([&NumMatches](const FSQLitePreparedStatement& InStatement)
+			{
+				InStatement.GetColumnValueByIndex(0, NumMatches);
+				return ESQLitePreparedStatementExecuteRowResult::Stop;
+			});
+		}
+		return NumMatches;
+	};
+
+	const TArray<int64> Ids = { 2, 4, 6, 42 };
+	bSuccess &= CountMatches(TEXT("SELECT count(*) FROM items WHERE id IN carray(@Ids)"), [&Ids](FSQLitePreparedStatement& InStatement)
+	{
+		return InStatement.SetBindingArrayByName(TEXT("@Ids"), Ids);
+	}) == 3;
+
+	const TArray<FString> Names = { TEXT("Item1"), TEXT("Item10"), TEXT("Item11") };
+	bSuccess &= CountMatches(TEXT("SELECT count(*) FROM items WHERE name IN carray(?1)"), [&Names](FSQLitePreparedStatement& InStatement)
+	{
+		return InStatement.SetBindingArrayByIndex(1, Names);
+	}) == 2;
+
+	const TArray<FGuid> MatchGuids = { Guids[0], Guids[9], FGuid::NewGuid() };
+	bSuccess &= CountMatches(TEXT("SELECT count(*) FROM items JOIN carray(?1) ON items.guid = carray.value"), [&MatchGuids](FSQLitePreparedStatement& InStatement)
+	{
+		return InStatement.SetBindingArrayByIndex(1, MatchGuids);
+	}) == 2;
+
+	// An empty array (or an unbound parameter) matches nothing
+	bSuccess &= CountMatches(TEXT("SELECT count(*) FROM items WHERE id IN carray(?1)"), [](FSQLitePreparedStatement& InStatement)
+	{
+		return InStatement.SetBindingArrayByIndex(1, TConstArrayView<int64>());
+	}) == 0;
+	bSuccess &= CountMatches(TEXT("SELECT count(*) FROM items WHERE id IN carray(?1)"), [](FSQLitePreparedStatement& InStatement)
+	{
+		return true;
+	}) == 0;
+
+	bSuccess &= TestDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreFunctionTest, "System.Plugins.Database.SQLiteCore.Function", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that typed scalar and aggregate functions can be registered and invoked from SQL.
+ */
+bool FSQLiteCoreFunctionTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteFunctionTest.db");
+	IFileManager::Get().Delete(*Path);
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE points (x REAL, y REAL)"));
+	bSuccess &= TestDb.Execute(TEXT("INSERT INTO points VALUES (3, 4), (6, 8), (NULL, 1)"));
+
+	bSuccess &= TestDb.RegisterScalarFunction<double, double, double>(TEXT("length2"), [](double X, double Y)
+	{
+		return FMath::Sqrt(X * X + Y * Y);
+	});
+	bSuccess &= TestDb.RegisterScalarFunction<FString, FString>(TEXT("shout"), [](const FString& Value)
+	{
+		return Value.ToUpper() + TEXT("!");
+	});
+	bSuccess &= TestDb.RegisterAggregateFunction<double, double, double>(TEXT("sum_sq"), [](double& State, double Value)
+	{
+		State += Value * Value;
+	},
+	[](const double& State)
+	{
+		return State;
+	});
+
+	double TotalLength = 0.0;
+	int64 NumNullLengths = 0;
+	bSuccess &= TestDb.Execute(TEXT("SELECT length2(x, y) FROM points"), [&TotalLength, &NumNullLengths](const FSQLitePreparedStatement& InStatement)
+	{
+		ESQLiteColumnType ColumnType = ESQLiteColumnType::Null;
+		InStatement.GetColumnTypeByIndex(0, ColumnType);
+		if (ColumnType == ESQLiteColumnType::Null)
+		{
+			++NumNullLengths;
+		}
+		else
+		{
+			double Length = 0.0;
+			InStatement.GetColumnValueByIndex(0, Length);
+			TotalLength += Length;
+		}
+		return ESQLitePreparedStatementExecuteRowResult::Continue;
+	}) == 3;
+	bSuccess &= FMath::IsNearlyEqual(TotalLength, 15.0) && NumNullLengths == 1;
+
+	FString Shouted;
+	bSuccess &= TestDb.Execute(TEXT("SELECT shout('hello')"), [&Shouted](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, Shouted);
+		return ESQLitePreparedStatementExecuteRowResult::Stop;
+	}) == 1;
+	bSuccess &= Shouted == TEXT("HELLO!");
+
+	// Rows with a NULL argument are skipped by the aggregate
+	double SumSq = 0.0;
+	bSuccess &= TestDb.Execute(TEXT("SELECT sum_sq(x) FROM points"), [&SumSq](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, SumSq);
+		return ESQLitePreparedStatementExecuteRowResult::Stop;
+	}) == 1;
+	bSuccess &= FMath::IsNearlyEqual(SumSq, 45.0);
+
+	bSuccess &= TestDb.UnregisterFunction(TEXT("shout"), 1);
+
+	bSuccess &= TestDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreVirtualTableTest, "System.Plugins.Database.SQLiteCore.VirtualTable", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that a virtual table reads its rows from the registered source, including via key lookups and joins,
+ * and that a source that can't be read fails the statement.
+ */
+bool FSQLiteCoreVirtualTableTest::RunTest(const FString& Parameters)
+{
+	struct FTestUnit
+	{
+		int64 Id;
+		FString Name;
+		int64 TypeId;
+	};
+
+	class FTestUnitSource : public ISQLiteVirtualTableSource
+	{
+	public:
+		explicit FTestUnitSource(const TArray<FTestUnit>& InUnits)
+			: Units(InUnits)
+		{
+		}
+
+		virtual TArray<FSQLiteVirtualTableColumn> GetColumns() const override
+		{
+			return { { TEXT("Id"), TEXT("INTEGER") }, { TEXT("Name"), TEXT("TEXT") }, { TEXT("TypeId"), TEXT("INTEGER") } };
+		}
+
+		virtual int32 GetKeyColumnIndex() const override
+		{
+			return 0;
+		}
+
+		virtual void GetRows(TArray<const void*>& OutRows) const override
+		{
+			for (const FTestUnit& Unit : Units)
+			{
+				OutRows.Add(&Unit);
+			}
+		}
+
+		virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const override
+		{
+			++NumKeyLookups;
+
+			int64 Id = 0;
+			InKey.GetValue(0, Id);
+			if (const FTestUnit* Unit = Units.FindByPredicate([Id](const FTestUnit& InUnit) { return InUnit.Id == Id; }))
+			{
+				OutRows.Add(Unit);
+			}
+		}
+
+		virtual TUniquePtr<ISQLiteVirtualTableKeyIndex> CreateKeyIndex() const override
+		{
+			class FTestUnitIndex : public ISQLiteVirtualTableKeyIndex
+			{
+			public:
+				virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const override
+				{
+					int64 Id = 0;
+					InKey.GetValue(0, Id);
+					if (const FTestUnit* const* Unit = UnitsById.Find(Id))
+					{
+						OutRows.Add(*Unit);
+					}
+				}
+
+				TMap<int64, const FTestUnit*> UnitsById;
+			};
+
+			++NumKeyIndexes;
+
+			TUniquePtr<FTestUnitIndex> Index = MakeUnique<FTestUnitIndex>();
+			for (const FTestUnit& Unit : Units)
+			{
+				Index->UnitsById.Add(Unit.Id, &Unit);
+			}
+			return Index;
+		}
+
+		virtual bool CanRead(FString& OutError) const override
+		{
+			OutError = TEXT("units are unreadable");
+			return bReadable;
+		}
+
+		virtual void GetColumnValue(const void* InRow, const int32 InColumnIndex, FSQLiteFunctionResult& OutResult) const override
+		{
+			const FTestUnit& Unit = *(const FTestUnit*)InRow;
+			switch (InColumnIndex)
+			{
+			case 0:
+				OutResult.SetValue(Unit.Id);
+				break;
+			case 1:
+				OutResult.SetValue(Unit.Name);
+				break;
+			case 2:
+				OutResult.SetValue(Unit.TypeId);
+				break;
+			default:
+				break;
+			}
+		}
+
+		const TArray<FTestUnit>& Units;
+		mutable int32 NumKeyLookups = 0;
+		mutable int32 NumKeyIndexes = 0;
+		bool bReadable = true;
+	};
+
+	bool bSuccess = true;
+
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteVirtualTableTest.db");
+	IFileManager::Get().Delete(*Path);
+
+	TArray<FTestUnit> Units = { { 1, TEXT("Archer"), 10 }, { 2, TEXT("Knight"), 20 }, { 3, TEXT("Squire"), 20 } };
+	TSharedRef<FTestUnitSource> Source = MakeShared<FTestUnitSource>(Units);
+
+	FSQLiteDatabase TestDb;
+	bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE unit_types (id INTEGER PRIMARY KEY, speed REAL)"));
+	bSuccess &= TestDb.Execute(TEXT("INSERT INTO unit_types VALUES (10, 1.5), (20, 0.5)"));
+	bSuccess &= TestDb.RegisterVirtualTable(TEXT("live_units"), Source);
+
+	// The rows are read from the source as they are, so changes to them are visible without re-registering
+	Units[2].Name = TEXT("Paladin");
+
+	TArray<FString> SlowUnits;
+	bSuccess &= TestDb.Execute(TEXT("SELECT u.Name FROM live_units AS u JOIN unit_types AS t ON t.id = u.TypeId WHERE t.speed < 1 ORDER BY u.Id"), [&SlowUnits](const FSQLitePreparedStatement& InStatement)
+	{
+		FString Name;
+		InStatement.GetColumnValueByIndex(0, Name);
+		SlowUnits.Add(Name);
+		return ESQLitePreparedStatementExecuteRowResult::Continue;
+	}) == 2;
+	bSuccess &= SlowUnits == TArray<FString>({ TEXT("Knight"), TEXT("Paladin") });
+
+	FString ArcherName;
+	bSuccess &= TestDb.Execute(TEXT("SELECT Name FROM live_units WHERE Id = 1"), [&ArcherName](const FSQLitePreparedStatement& InStatement)
+	{
+		InStatement.GetColumnValueByIndex(0, ArcherName);
+		return ESQLitePreparedStatementExecuteRowResult::Continue;
+	}) == 1;
+	bSuccess &= ArcherName == TEXT("Archer") && Source->NumKeyLookups > 0 && Source->NumKeyIndexes == 0;
+
+	// As the inner table of a join, the first key is found via FindRows, and the rest via a single index
+	bSuccess &= TestDb.Execute(TEXT("CREATE TABLE squad (slot INTEGER PRIMARY KEY, unit_id INTEGER)"));
+	bSuccess &= TestDb.Execute(TEXT("INSERT INTO squad VALUES (1, 3), (2, 1), (3, 3), (4, 9)"));
+
+	Source->NumKeyLookups = 0;
+	TArray<FString> SquadUnits;
+	bSuccess &= TestDb.Execute(TEXT("SELECT u.Name FROM squad AS s CROSS JOIN live_units AS u ON u.Id = s.unit_id ORDER BY s.slot"), [&SquadUnits](const FSQLitePreparedStatement& InStatement)
+	{
+		FString Name;
+		InStatement.GetColumnValueByIndex(0, Name);
+		SquadUnits.Add(Name);
+		return ESQLitePreparedStatementExecuteRowResult::Continue;
+	}) == 3;
+	bSuccess &= SquadUnits == TArray<FString>({ TEXT("Paladin"), TEXT("Archer"), TEXT("Paladin") });
+	bSuccess &= Source->NumKeyLookups == 1 && Source->NumKeyIndexes == 1;
+
+	// A source that can't be read fails the statement, rather than being asked for rows
+	Source->bReadable = false;
+	bSuccess &= !TestDb.Execute(TEXT("SELECT Name FROM live_units"));
+	bSuccess &= TestDb.GetLastError().Contains(TEXT("units are unreadable"));
+	Source->bReadable = true;
+
+	bSuccess &= TestDb.UnregisterVirtualTable(TEXT("live_units"));
+	bSuccess &= TestDb.Close();
+
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+#if SQLITE_OS_OTHER
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreReadOnlyShortReadTest, "System.Plugins.Database.SQLiteCore.ReadOnlyShortRead", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that reads of a read-only file that run past its end, or start at it, are reported as short reads with the rest of the buffer zeroed.
+ * If this test fails (or hangs), this is likely because ReadThroughReadAheadCache in SQLiteEmbeddedPlatform.cpp is broken.
+ */
+bool FSQLiteCoreReadOnlyShortReadTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteReadOnlyShortReadTest.db");
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.SetReadOnly(*Path, false);
+	IFileManager::Get().Delete(*Path);
+	bool bSuccess = true;
+
+	// The file size deliberately isn't a multiple of the read-ahead block size, so the last block is partial
+	const int32 FileSizeBytes = 64 * 1024 + 100;
+	TArray<uint8> FileData;
+	FileData.SetNumUninitialized(FileSizeBytes);
+	for (int32 ByteIndex = 0; ByteIndex < FileSizeBytes; ++ByteIndex)
+	{
+		FileData[ByteIndex] = (uint8)(1 + ByteIndex % 251);
+	}
+	bSuccess &= FFileHelper::SaveArrayToFile(FileData, *Path);
+	bSuccess &= PlatformFile.SetReadOnly(*Path, true);
+
+	sqlite3_vfs* Vfs = sqlite3_vfs_find("unreal-fs");
+	bSuccess &= Vfs != nullptr;
+	if (Vfs)
+	{
+		TArray<uint8> FileStorage;
+		FileStorage.SetNumZeroed(Vfs->szOsFile);
+		sqlite3_file* File = (sqlite3_file*)FileStorage.GetData();
+
+		int OpenedFlags = 0;
+		bSuccess &= Vfs->xOpen(Vfs, TCHAR_TO_UTF8(*Path), File, SQLITE_OPEN_READONLY | SQLITE_OPEN_MAIN_DB, &OpenedFlags) == SQLITE_OK;
+		if (File->pMethods)
+		{
+			const int32 ReadAmountBytes = 200;
+			uint8 Buffer[ReadAmountBytes];
+
+			auto MatchesFile = [&FileData, &Buffer](const int32 InOffsetBytes, const int32 InAmountBytes)
+			{
+				return FMemory::Memcmp(Buffer, FileData.GetData() + InOffsetBytes, InAmountBytes) == 0;
+			};
+			auto IsZeroed = [&Buffer](const int32 InOffsetBytes, const int32 InAmountBytes)
+			{
+				for (int32 ByteIndex = InOffsetBytes; ByteIndex < InOffsetBytes + InAmountBytes; ++ByteIndex)
+				{
+					if (Buffer[ByteIndex] != 0)
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+
+			// A read that ends before EOF is served in full
+			FMemory::Memset(Buffer, 0xFF, ReadAmountBytes);
+			bSuccess &= File->pMethods->xRead(File, Buffer, ReadAmountBytes, 1000) == SQLITE_OK;
+			bSuccess &= MatchesFile(1000, ReadAmountBytes);
+
+			// A read that crosses EOF returns what's there and zeroes the rest
+			const int32 CrossingOffsetBytes = FileSizeBytes - 50;
+			FMemory::Memset(Buffer, 0xFF, ReadAmountBytes);
+			bSuccess &= File->pMethods->xRead(File, Buffer, ReadAmountBytes, CrossingOffsetBytes) == SQLITE_IOERR_SHORT_READ;
+			bSuccess &= MatchesFile(CrossingOffsetBytes, 50);
+			bSuccess &= IsZeroed(50, ReadAmountBytes - 50);
+
+			// A read that starts at (or past) EOF is entirely zeroed
+			FMemory::Memset(Buffer, 0xFF, ReadAmountBytes);
+			bSuccess &= File->pMethods->xRead(File, Buffer, ReadAmountBytes, FileSizeBytes) == SQLITE_IOERR_SHORT_READ;
+			bSuccess &= IsZeroed(0, ReadAmountBytes);
+
+			FMemory::Memset(Buffer, 0xFF, ReadAmountBytes);
+			bSuccess &= File->pMethods->xRead(File, Buffer, ReadAmountBytes, FileSizeBytes + 64 * 1024) == SQLITE_IOERR_SHORT_READ;
+			bSuccess &= IsZeroed(0, ReadAmountBytes);
+
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+	}
+
+	PlatformFile.SetReadOnly(*Path, false);
+	IFileManager::Get().Delete(*Path);
+
+	return bSuccess;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSQLiteCoreAtomicWriteLogTest, "System.Plugins.Database.SQLiteCore.AtomicWriteLog", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Ensures that the redo log used for batch atomic writes is never replayed over changes made to the file after the batch, including when SQLite never syncs (PRAGMA synchronous=OFF).
+ * If this test fails, this is likely because RetireAtomicWriteLog or RecoverAtomicWriteLog in SQLiteEmbeddedPlatform.cpp is broken.
+ */
+bool FSQLiteCoreAtomicWriteLogTest::RunTest(const FString& Parameters)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("SQLiteTests") / "SQLiteAtomicWriteLogTest.db");
+	const FString LogPath = Path + TEXT("-batch");
+	const FString SavedLogPath = Path + TEXT("-batch-saved");
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	IFileManager::Get().Delete(*Path);
+	IFileManager::Get().Delete(*LogPath);
+	IFileManager::Get().Delete(*SavedLogPath);
+	bool bSuccess = true;
+
+	// A small (batch) commit followed by a journaled commit, with no syncs, survives a close and reopen
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate);
+		bSuccess &= TestDb.Execute(TEXT("PRAGMA synchronous=OFF;"));
+		bSuccess &= TestDb.Execute(TEXT("CREATE TABLE items (id INTEGER PRIMARY KEY, value TEXT);"));
+		bSuccess &= TestDb.Execute(TEXT("INSERT INTO items (id, value) VALUES (1, 'batch');"));
+
+		// A transaction that spills the page cache can't be a batch, so goes through the rollback journal
+		bSuccess &= TestDb.Execute(TEXT("PRAGMA cache_size=2;"));
+		bSuccess &= TestDb.Execute(TEXT("BEGIN;"));
+		bSuccess &= TestDb.Execute(TEXT("WITH RECURSIVE seq(n) AS (SELECT 2 UNION ALL SELECT n + 1 FROM seq WHERE n < 201) INSERT INTO items (id, value) SELECT n, hex(randomblob(500)) FROM seq;"));
+		bSuccess &= TestDb.Execute(TEXT("UPDATE items SET value = 'journal' WHERE id = 1;"));
+		bSuccess &= TestDb.Execute(TEXT("COMMIT;"));
+		bSuccess &= TestDb.Close();
+	}
+	bSuccess &= !PlatformFile.FileExists(*LogPath);
+	{
+		FSQLiteDatabase TestDb;
+		bSuccess &= TestDb.Open(*Path, ESQLiteDatabaseOpenMode::ReadWrite);
+
+		FString Value;
+		int64 NumItems = 0;
+		bSuccess &= TestDb.Execute(TEXT("SELECT (SELECT value FROM items WHERE id = 1), count(*) FROM items;"), [&Value, &NumItems](const FSQLitePreparedStatement& InStatement)
+		{
+			InStatement.GetColumnValueByIndex(0, Value);
+			InStatement.GetColumnValueByIndex(1, NumItems);
+			return ESQLitePreparedStatementExecuteRowResult::Stop;
+		}) == 1;
+		bSuccess &= Value == TEXT("journal") && NumItems == 201;
+		bSuccess &= TestDb.PerformQuickIntegrityCheck();
+		bSuccess &= TestDb.Close();
+	}
+	IFileManager::Get().Delete(*Path);
+
+	// Drive the VFS directly, so the batch is certain to be left pending in the redo log
+	sqlite3_vfs* Vfs = sqlite3_vfs_find("unreal-fs");
+	bSuccess &= Vfs != nullptr;
+	if (Vfs)
+	{
+		const int32 PageSizeBytes = 4096;
+		TArray<uint8> FileStorage;
+		FileStorage.SetNumZeroed(Vfs->szOsFile);
+		sqlite3_file* File = (sqlite3_file*)FileStorage.GetData();
+
+		// A page filled with a value, with a change counter in the header
+		auto MakePage = [PageSizeBytes](const uint8 InFill, const uint32 InChangeCounter)
+		{
+			TArray<uint8> Page;
+			Page.Init(InFill, PageSizeBytes);
+			FMemory::Memcpy(Page.GetData() + 24, &InChangeCounter, sizeof(uint32));
+			return Page;
+		};
+		auto OpenFile = [Vfs, File, &Path]()
+		{
+			int OpenedFlags = 0;
+			return Vfs->xOpen(Vfs, TCHAR_TO_UTF8(*Path), File, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_MAIN_DB, &OpenedFlags) == SQLITE_OK;
+		};
+		auto WritePage = [File, PageSizeBytes](const TArray<uint8>& InPage)
+		{
+			return File->pMethods->xWrite(File, InPage.GetData(), PageSizeBytes, 0) == SQLITE_OK;
+		};
+		auto PageMatches = [File, PageSizeBytes](const TArray<uint8>& InPage)
+		{
+			TArray<uint8> Page;
+			Page.SetNumZeroed(PageSizeBytes);
+			return File->pMethods->xRead(File, Page.GetData(), PageSizeBytes, 0) == SQLITE_OK && Page == InPage;
+		};
+
+		const TArray<uint8> BeforeBatchPage = MakePage(0xAA, 1);
+		const TArray<uint8> BatchPage = MakePage(0xBB, 2);
+		const TArray<uint8> AfterBatchPage = MakePage(0xCC, 3);
+
+		// Commit a batch that is never synced, keep a copy of its redo log, then write over it without a batch
+		if (OpenFile())
+		{
+			bSuccess &= WritePage(BeforeBatchPage);
+			bSuccess &= File->pMethods->xFileControl(File, SQLITE_FCNTL_BEGIN_ATOMIC_WRITE, nullptr) == SQLITE_OK;
+			bSuccess &= WritePage(BatchPage);
+			bSuccess &= File->pMethods->xFileControl(File, SQLITE_FCNTL_COMMIT_ATOMIC_WRITE, nullptr) == SQLITE_OK;
+			bSuccess &= PlatformFile.CopyFile(*SavedLogPath, *LogPath);
+			bSuccess &= WritePage(AfterBatchPage);
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+		bSuccess &= !PlatformFile.FileExists(*LogPath);
+
+		// The later write survives a reopen
+		if (OpenFile())
+		{
+			bSuccess &= PageMatches(AfterBatchPage);
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+
+		// A stale redo log (eg, left by a crash) isn't replayed over a file that has changed since its batch
+		bSuccess &= PlatformFile.CopyFile(*LogPath, *SavedLogPath);
+		if (OpenFile())
+		{
+			bSuccess &= PageMatches(AfterBatchPage);
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+		bSuccess &= !PlatformFile.FileExists(*LogPath);
+
+		// But it is replayed over the file it was committed against, as if the batch was interrupted
+		if (OpenFile())
+		{
+			bSuccess &= WritePage(BeforeBatchPage);
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+		bSuccess &= PlatformFile.CopyFile(*LogPath, *SavedLogPath);
+		if (OpenFile())
+		{
+			bSuccess &= PageMatches(BatchPage);
+			bSuccess &= File->pMethods->xClose(File) == SQLITE_OK;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+	}
+
+	IFileManager::Get().Delete(*Path);
+	IFileManager::Get().Delete(*LogPath);
+	IFileManager::Get().Delete(*SavedLogPath);
+
+	return bSuccess;
+}
+
+#endif // SQLITE_OS_OTHER
+
 #endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "Serialization/Archive.h"
+
+class FSQLiteDatabase;
+
+/**
+ * Archive that streams the blob stored in a single column of a single row, using SQLite incremental blob I/O (see sqlite3_blob_open).
+ * This allows large blobs to be read or written in chunks, without ever holding the whole blob in memory.
+ *
+ * @note Incremental blob I/O cannot change the size of a blob, so to write a new blob the row must first be given a blob of the final size
+ *       (eg, using FSQLitePreparedStatement::SetBindingZeroBlobByName or the SQL zeroblob function), which this archive can then fill.
+ * @note The archive becomes invalid if the row it is reading/writing is modified or deleted by anything else (any further Serialize will set the error state).
+ * @note The archive must be destroyed (or closed) before the database it was opened on is closed.
+ */
+class SQLITECOREX_API FSQLiteBlobArchive : public FArchive
+{
+public:
+	/**
+	 * Open the blob stored in the given column of the given row, for loading or saving.
+	 * @note Check IsValid after construction to know whether the blob was opened.
+	 */
+	FSQLiteBlobArchive(FSQLiteDatabase& InDatabase, const TCHAR* InTableName, const TCHAR* InColumnName, const int64 InRowId, const bool bInIsSaving = false, const TCHAR* InSchemaName = TEXT("main"));
+
+	/**
+	 * Closes the blob (if open).
+	 */
+	virtual ~FSQLiteBlobArchive();
+
+	/** Non-copyable */
+	FSQLiteBlobArchive(const FSQLiteBlobArchive&) = delete;
+	FSQLiteBlobArchive& operator=(const FSQLiteBlobArchive&) = delete;
+
+	/**
+	 * Is this a valid archive? (ie, has a blob open).
+	 */
+	bool IsValid() const
+	{
+		return Blob != nullptr;
+	}
+
+	/**
+	 * Point this archive at the blob stored in the same column of another row of the same table, and seek back to the start.
+	 * @note This is much cheaper than opening a new archive, so should be preferred when walking many rows.
+	 * @return true if the reopen was a success (on failure the archive is left empty until another row is successfully reopened).
+	 */
+	bool Reopen(const int64 InRowId);
+
+	/**
+	 * Get the rowid of the row that the blob is stored in.
+	 */
+	int64 GetRowId() const
+	{
+		return RowId;
+	}
+
+	//~ FArchive interface
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual int64 Tell() override;
+	virtual int64 TotalSize() override;
+	virtual void Seek(int64 InPos) override;
+	/** Close the blob, leaving this archive invalid (returns false if the archive had an error, or the blob failed to close) */
+	virtual bool Close() override;
+	virtual FString GetArchiveName() const override;
+
+private:
+	/** Internal SQLite blob handle */
+	struct sqlite3_blob* Blob = nullptr;
+
+	/** Rowid of the row that the blob is stored in */
+	int64 RowId = 0;
+
+	/** Size of the blob, in bytes */
+	int64 BlobSizeBytes = 0;
+
+	/** Current offset into the blob, in bytes */
+	int64 Offset = 0;
+};
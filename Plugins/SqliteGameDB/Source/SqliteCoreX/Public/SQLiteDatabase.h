@@ -4,6 +4,10 @@
 
 #include "CoreTypes.h"
 #include "SQLitePreparedStatement.h"
+#include "SQLiteFunction.h"
+#include "SQLiteVirtualTable.h"
+#include "Templates/Identity.h"
+#include "SQLiteIoStats.h"
 
 /**
  * Modes used when opening a database.
@@ -20,6 +24,58 @@ enum class ESQLiteDatabaseOpenMode : uint8
 	ReadWriteCreate,
 };
 
+/**
+ * Threading modes that can be used by a database connection.
+ * @note SQLite's single-thread mode applies to the whole process rather than a connection; MultiThread is the per-connection equivalent.
+ * @see SQLITE_OPEN_NOMUTEX and SQLITE_OPEN_FULLMUTEX.
+ */
+enum class ESQLiteDatabaseThreadingMode : uint8
+{
+	/** The connection is only used by one thread at a time (eg, only ever from the game thread), so SQLite doesn't need to lock the connection during each call. */
+	MultiThread,
+
+	/** The connection may be used by multiple threads at the same time, so SQLite serializes each call through the connection mutex. */
+	Serialized,
+};
+
+/**
+ * Journal modes that can be used by a database.
+ * @see PRAGMA journal_mode.
+ */
+enum class ESQLiteDatabaseJournalMode : uint8
+{
+	/** The rollback journal is deleted at the conclusion of each transaction. */
+	Delete,
+
+	/** The rollback journal is truncated to zero-length at the conclusion of each transaction. */
+	Truncate,
+
+	/** The rollback journal is left in place, and its header overwritten, at the conclusion of each transaction. */
+	Persist,
+
+	/** The rollback journal is stored in memory rather than on disk. */
+	Memory,
+
+	/** A write-ahead log is used instead of a rollback journal, which allows readers to continue while a writer appends to the log. */
+	WAL,
+
+	/** No journal is used (the ROLLBACK command no longer works, and a crash mid-transaction will likely corrupt the database). */
+	Off,
+};
+
+/**
+ * Text encodings that can be used by a database.
+ * @see PRAGMA encoding.
+ */
+enum class ESQLiteDatabaseTextEncoding : uint8
+{
+	/** Text is stored as UTF-8 (the SQLite default), which is the most compact encoding for mostly ASCII text. */
+	UTF8,
+
+	/** Text is stored as UTF-16 (in native byte order), which matches TCHAR, so strings can be bound and read without being transcoded. */
+	UTF16,
+};
+
 /**
  * Wrapper around an SQLite database.
  * @see sqlite3.
@@ -47,7 +103,28 @@ public:
 	/**
 	 * Open (or create) an SQLite database file.
 	 */
-	bool Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode = ESQLiteDatabaseOpenMode::ReadWriteCreate);
+	bool Open(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode = ESQLiteDatabaseOpenMode::ReadWriteCreate, const ESQLiteDatabaseThreadingMode InThreadingMode = ESQLiteDatabaseThreadingMode::Serialized);
+
+	/**
+	 * Open an SQLite database from a copy of the given serialized database image, held entirely in memory.
+	 * @note Changes made to the database only exist in memory; use Serialize to retrieve them.
+	 * @note ESQLiteDatabaseOpenMode::ReadOnly prevents any changes, otherwise the in-memory database may grow as needed.
+	 */
+	bool OpenFromMemory(TArrayView<const uint8> InDatabaseImage, const ESQLiteDatabaseOpenMode InOpenMode = ESQLiteDatabaseOpenMode::ReadWrite, const ESQLiteDatabaseThreadingMode InThreadingMode = ESQLiteDatabaseThreadingMode::Serialized);
+
+	/**
+	 * Open an SQLite database file by reading the whole file with a single sequential read, and holding it entirely in memory.
+	 * @note Changes made to the database only exist in memory and are not written back to the file; use Serialize to retrieve them.
+	 * @note ESQLiteDatabaseOpenMode::ReadOnly prevents any changes, otherwise the in-memory database may grow as needed. Fails if the file doesn't exist.
+	 */
+	bool OpenFileIntoMemory(const TCHAR* InFilename, const ESQLiteDatabaseOpenMode InOpenMode = ESQLiteDatabaseOpenMode::ReadWrite, const ESQLiteDatabaseThreadingMode InThreadingMode = ESQLiteDatabaseThreadingMode::Serialized);
+
+	/**
+	 * Serialize the main database into an image that is identical to the file that would be written to disk for it.
+	 * @note The resulting image can be passed to OpenFromMemory, or written to disk as a regular database file.
+	 * @return true if the serialization was a success.
+	 */
+	bool Serialize(TArray<uint8>& OutDatabaseImage) const;
 
 	/**
 	 * Close an open SQLite database file.
@@ -86,6 +163,40 @@ public:
 	 */
 	bool SetUserVersion(const int32 InUserVersion);
 
+	/**
+	 * Get the journal mode currently used by the database.
+	 * @return true if the get was a success.
+	 */
+	bool GetJournalMode(ESQLiteDatabaseJournalMode& OutJournalMode) const;
+
+	/**
+	 * Set the journal mode used by the database.
+	 * @note WAL requires shared memory support from the VFS, and will fail for in-memory databases.
+	 * @return true if the set was a success (ie, the database is now using the requested journal mode).
+	 */
+	bool SetJournalMode(const ESQLiteDatabaseJournalMode InJournalMode);
+
+	/**
+	 * Get the text encoding used by the database.
+	 * @return true if the get was a success.
+	 */
+	bool GetTextEncoding(ESQLiteDatabaseTextEncoding& OutTextEncoding) const;
+
+	/**
+	 * Set the text encoding used by the database.
+	 * @note The encoding can only be set before the database content is created (ie, before its first table is created), and attached databases always use the encoding of the main database.
+	 * @note Prepared statements use the native text functions of the encoding that was in use when they were created.
+	 * @return true if the set was a success (ie, the database is now using the requested encoding).
+	 */
+	bool SetTextEncoding(const ESQLiteDatabaseTextEncoding InTextEncoding);
+
+	/**
+	 * Set the maximum number of bytes of the database file that SQLite may access via memory mapped I/O, rather than via reads into its page cache.
+	 * @note Databases opened as ESQLiteDatabaseOpenMode::ReadOnly default to a non-zero limit. A limit of zero disables memory mapped I/O.
+	 * @return true if the set was a success.
+	 */
+	bool SetMemoryMapSizeLimit(const int64 InSizeBytes);
+
 	/**
 	 * Execute a statement that requires no result state.
 	 * @note For statements that require a result, or that you wish to reuse repeatedly (including using bindings), you should consider using FSQLitePreparedStatement.
@@ -120,6 +231,81 @@ public:
 			: T();
 	}
 
+	/**
+	 * Register an SQL scalar function on this database connection, replacing any existing function with the same name and number of arguments.
+	 * @note Functions are invoked on whichever thread is stepping the statement that uses them, and remain registered until the database is closed.
+	 * @param InNumArgs The number of arguments the function takes, or -1 to accept any number of arguments.
+	 * @return true if the registration was a success.
+	 */
+	bool RegisterScalarFunction(const TCHAR* InFunctionName, const int32 InNumArgs, const ESQLiteFunctionFlags InFlags, TFunction<void(const FSQLiteFunctionArgs&, FSQLiteFunctionResult&)> InFunction);
+
+	/**
+	 * Register a typed SQL scalar function on this database connection, eg:
+	 *   Database.RegisterScalarFunction<double, double, double>(TEXT("max2"), [](double A, double B) { return FMath::Max(A, B); });
+	 * Arguments are converted to the requested types, and the function is not called if any argument is NULL (the result is NULL instead).
+	 * A TOptional return type can be used to return NULL.
+	 * @return true if the registration was a success.
+	 */
+	template <typename RetType, typename... ArgTypes>
+	bool RegisterScalarFunction(const TCHAR* InFunctionName, typename TIdentity<TFunction<RetType(ArgTypes...)>>::Type InFunction, const ESQLiteFunctionFlags InFlags = ESQLiteFunctionFlags::Deterministic)
+	{
+		return RegisterScalarFunction(InFunctionName, (int32)sizeof...(ArgTypes), InFlags, [Function = MoveTemp(InFunction)](const FSQLiteFunctionArgs& InArgs, FSQLiteFunctionResult& OutResult)
+		{
+			if (InArgs.HasNull())
+			{
+				OutResult.SetNull();
+				return;
+			}
+			SQLiteFunctionImpl::InvokeScalar(Function, InArgs, OutResult, TMakeIntegerSequence<uint32, sizeof...(ArgTypes)>());
+		});
+	}
+
+	/**
+	 * Register an SQL aggregate function on this database connection, replacing any existing function with the same name and number of arguments.
+	 * @param InNumArgs The number of arguments the function takes, or -1 to accept any number of arguments.
+	 * @param InCreateState Called to create the state of each evaluation of the aggregate.
+	 * @return true if the registration was a success.
+	 */
+	bool RegisterAggregateFunction(const TCHAR* InFunctionName, const int32 InNumArgs, const ESQLiteFunctionFlags InFlags, TFunction<TUniquePtr<ISQLiteAggregateState>()> InCreateState);
+
+	/**
+	 * Register a typed SQL aggregate function on this database connection, eg:
+	 *   Database.RegisterAggregateFunction<double, double, double>(TEXT("sum_sq"), [](double& State, double Value) { State += Value * Value; }, [](const double& State) { return State; });
+	 * Each evaluation starts from a value-initialized StateType. Arguments are converted to the requested types, and rows with a NULL argument are skipped.
+	 * @return true if the registration was a success.
+	 */
+	template <typename StateType, typename RetType, typename... ArgTypes>
+	bool RegisterAggregateFunction(const TCHAR* InFunctionName, typename TIdentity<TFunction<void(StateType&, ArgTypes...)>>::Type InStep, typename TIdentity<TFunction<RetType(const StateType&)>>::Type InFinal, const ESQLiteFunctionFlags InFlags = ESQLiteFunctionFlags::Deterministic)
+	{
+		using FAggregateState = SQLiteFunctionImpl::TAggregateState<StateType, RetType, ArgTypes...>;
+		TSharedRef<const typename FAggregateState::FFunctions> Functions = MakeShared<typename FAggregateState::FFunctions>(typename FAggregateState::FFunctions{ MoveTemp(InStep), MoveTemp(InFinal) });
+		return RegisterAggregateFunction(InFunctionName, (int32)sizeof...(ArgTypes), InFlags, [Functions]() -> TUniquePtr<ISQLiteAggregateState>
+		{
+			return MakeUnique<FAggregateState>(Functions);
+		});
+	}
+
+	/**
+	 * Unregister an SQL function (scalar or aggregate) from this database connection.
+	 * @return true if the unregistration was a success.
+	 */
+	bool UnregisterFunction(const TCHAR* InFunctionName, const int32 InNumArgs);
+
+	/**
+	 * Register a read-only virtual table on this database connection, whose rows are read from the given source as the table is queried.
+	 * The table is eponymous (ie, it exists in every schema as soon as it is registered, without a CREATE VIRTUAL TABLE), replacing any existing table module with the same name.
+	 * @note The source remains registered until it is unregistered or the database is closed.
+	 * @return true if the registration was a success.
+	 */
+	bool RegisterVirtualTable(const TCHAR* InTableName, TSharedRef<ISQLiteVirtualTableSource> InSource);
+
+	/**
+	 * Unregister a virtual table registered via RegisterVirtualTable from this database connection.
+	 * @note Statements reading the table must be destroyed first.
+	 * @return true if the unregistration was a success.
+	 */
+	bool UnregisterVirtualTable(const TCHAR* InTableName);
+
 	/**
 	 * Get the last error reported by this database.
 	 */
@@ -131,12 +317,29 @@ public:
 	 */
 	int64 GetLastInsertRowId() const;
 
+	/**
+	 * Get the I/O counters of the files used by this database (the main database, and any attached databases).
+	 * @note Only files accessed through the unreal-fs VFS record counters, so in-memory databases will have no entry.
+	 * @return true if the get was a success.
+	 */
+	bool GetIoStats(TArray<FSQLiteIoStats>& OutIoStats) const;
+
 	/** Performs a quick check on the integrity of the database, returns true if everything is ok. */
 	bool PerformQuickIntegrityCheck() const;
 
 private:
 	friend class FSQLitePreparedStatement;
+	friend class FSQLiteBlobArchive;
+
+	/** Open an in-memory database from the given image, which must have been allocated by sqlite3_malloc64 (ownership is always taken, even on failure) */
+	bool OpenDeserialized(uint8* InDatabaseImage, const int64 InDatabaseImageSizeBytes, const ESQLiteDatabaseOpenMode InOpenMode, const ESQLiteDatabaseThreadingMode InThreadingMode);
+
+	/** Update TextEncoding from the encoding currently used by the database */
+	void CacheTextEncoding();
 
 	/** Internal SQLite database handle */
 	struct sqlite3* Database;
+
+	/** Text encoding used by the database (cached when the database is opened, or its encoding is set), used by prepared statements to pick their text functions */
+	ESQLiteDatabaseTextEncoding TextEncoding;
 };
@@ -0,0 +1,229 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "SQLiteTypes.h"
+#include "Misc/Guid.h"
+#include "Misc/Optional.h"
+#include "Misc/EnumClassFlags.h"
+#include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+#include "Containers/UnrealString.h"
+#include "Templates/Decay.h"
+#include "Templates/IntegerSequence.h"
+#include "Templates/SharedPointer.h"
+#include "Templates/UniquePtr.h"
+#include "Templates/Function.h"
+
+/**
+ * Flags used when registering an SQL function.
+ * @see sqlite3_create_function_v2.
+ */
+enum class ESQLiteFunctionFlags : uint8
+{
+	/** No special flags. */
+	None = 0,
+
+	/** The function always returns the same result for the same arguments, which allows SQLite to factor it out of loops, and use it in indexes and CHECK constraints. */
+	Deterministic = 1<<0,
+
+	/** The function may only be invoked from top-level SQL (not from views, triggers, or schema structures such as CHECK constraints and indexes). */
+	DirectOnly = 1<<1,
+
+	/** The function has no side-effects, so is safe to use from views, triggers, and schema structures even when the schema may be untrusted. */
+	Innocuous = 1<<2,
+};
+ENUM_CLASS_FLAGS(ESQLiteFunctionFlags);
+
+/**
+ * Arguments passed to an invocation of an SQL function.
+ * @note Instances are created by FSQLiteDatabase for the duration of a single invocation, and must not be retained.
+ */
+class SQLITECOREX_API FSQLiteFunctionArgs
+{
+public:
+	FSQLiteFunctionArgs(struct sqlite3_value** InValues, const int32 InNumValues, const bool bInUseUTF16Text);
+
+	/** Non-copyable */
+	FSQLiteFunctionArgs(const FSQLiteFunctionArgs&) = delete;
+	FSQLiteFunctionArgs& operator=(const FSQLiteFunctionArgs&) = delete;
+
+	/**
+	 * Get the number of arguments passed to the function.
+	 */
+	int32 Num() const
+	{
+		return NumValues;
+	}
+
+	/**
+	 * Is any argument NULL?
+	 */
+	bool HasNull() const;
+
+	/**
+	 * Get the type of the given argument.
+	 * @return true if the get was a success.
+	 */
+	bool GetType(const int32 InArgIndex, ESQLiteColumnType& OutType) const;
+
+	/**
+	 * Get the given argument, converting it to the requested type (using the same conversions as FSQLitePreparedStatement::GetColumnValueByIndex).
+	 * @return true if the get was a success.
+	 */
+	bool GetValue(const int32 InArgIndex, int32& OutValue) const;
+	bool GetValue(const int32 InArgIndex, int64& OutValue) const;
+	bool GetValue(const int32 InArgIndex, bool& OutValue) const;
+	bool GetValue(const int32 InArgIndex, float& OutValue) const;
+	bool GetValue(const int32 InArgIndex, double& OutValue) const;
+	bool GetValue(const int32 InArgIndex, FString& OutValue) const;
+	bool GetValue(const int32 InArgIndex, TArray<uint8>& OutValue) const;
+	bool GetValue(const int32 InArgIndex, FGuid& OutValue) const;
+
+private:
+	/** Internal SQLite argument values */
+	struct sqlite3_value** Values;
+
+	/** Number of entries in Values */
+	int32 NumValues;
+
+	/** True if text should be read natively as UTF-16 (as the function is running on a UTF-16 database) */
+	bool bUseUTF16Text;
+};
+
+/**
+ * Result of an invocation of an SQL function.
+ * @note Instances are created by FSQLiteDatabase for the duration of a single invocation, and must not be retained.
+ * @note If no result is set, the function returns NULL.
+ */
+class SQLITECOREX_API FSQLiteFunctionResult
+{
+public:
+	FSQLiteFunctionResult(struct sqlite3_context* InContext, const bool bInUseUTF16Text);
+
+	/** Non-copyable */
+	FSQLiteFunctionResult(const FSQLiteFunctionResult&) = delete;
+	FSQLiteFunctionResult& operator=(const FSQLiteFunctionResult&) = delete;
+
+	/**
+	 * Set the result of the function.
+	 * GUIDs are returned as blobs, in the same form as FSQLitePreparedStatement::SetBindingValueByIndex uses for an FGuid binding.
+	 */
+	void SetValue(const int32 InValue);
+	void SetValue(const int64 InValue);
+	void SetValue(const bool InValue);
+	void SetValue(const float InValue);
+	void SetValue(const double InValue);
+	void SetValue(const FString& InValue);
+	void SetValue(TArrayView<const uint8> InBlobData);
+	void SetValue(const FGuid& InValue);
+
+	/**
+	 * Set the result of the function, or set it to NULL if the value is unset.
+	 */
+	template <typename T>
+	void SetValue(const TOptional<T>& InValue)
+	{
+		if (InValue.IsSet())
+		{
+			SetValue(InValue.GetValue());
+		}
+		else
+		{
+			SetNull();
+		}
+	}
+
+	/**
+	 * Set the result of the function to NULL.
+	 */
+	void SetNull();
+
+	/**
+	 * Fail the function with the given error message, which causes the statement invoking it to fail.
+	 */
+	void SetError(const TCHAR* InErrorMessage);
+
+private:
+	/** Internal SQLite function context */
+	struct sqlite3_context* Context;
+
+	/** True if text should be returned natively as UTF-16 (as the function is running on a UTF-16 database) */
+	bool bUseUTF16Text;
+};
+
+/**
+ * State of a single evaluation of an SQL aggregate function (eg, for one group of a GROUP BY).
+ * A new state is created for each evaluation, fed each row via Step, and then destroyed once Final has set the result.
+ */
+class ISQLiteAggregateState
+{
+public:
+	virtual ~ISQLiteAggregateState() = default;
+
+	/** Accumulate the arguments of a row (errors may be reported via OutResult.SetError) */
+	virtual void Step(const FSQLiteFunctionArgs& InArgs, FSQLiteFunctionResult& OutResult) = 0;
+
+	/** Set the result of the aggregate (called once all rows have been stepped, including when there were no rows) */
+	virtual void Final(FSQLiteFunctionResult& OutResult) = 0;
+};
+
+namespace SQLiteFunctionImpl
+{
+
+template <typename T>
+T GetArg(const FSQLiteFunctionArgs& InArgs, const int32 InArgIndex)
+{
+	T Value{};
+	InArgs.GetValue(InArgIndex, Value);
+	return Value;
+}
+
+template <typename RetType, typename... ArgTypes, uint32... ArgIndices>
+void InvokeScalar(const TFunction<RetType(ArgTypes...)>& InFunction, const FSQLiteFunctionArgs& InArgs, FSQLiteFunctionResult& OutResult, TIntegerSequence<uint32, ArgIndices...>)
+{
+	OutResult.SetValue(InFunction(GetArg<typename TDecay<ArgTypes>::Type>(InArgs, ArgIndices)...));
+}
+
+template <typename StateType, typename RetType, typename... ArgTypes>
+class TAggregateState : public ISQLiteAggregateState
+{
+public:
+	struct FFunctions
+	{
+		TFunction<void(StateType&, ArgTypes...)> Step;
+		TFunction<RetType(const StateType&)> Final;
+	};
+
+	explicit TAggregateState(const TSharedRef<const FFunctions>& InFunctions)
+		: Functions(InFunctions)
+	{
+	}
+
+	virtual void Step(const FSQLiteFunctionArgs& InArgs, FSQLiteFunctionResult& OutResult) override
+	{
+		// Rows with a NULL argument are skipped, matching the behavior of the built-in aggregates
+		if (!InArgs.HasNull())
+		{
+			StepImpl(InArgs, TMakeIntegerSequence<uint32, sizeof...(ArgTypes)>());
+		}
+	}
+
+	virtual void Final(FSQLiteFunctionResult& OutResult) override
+	{
+		OutResult.SetValue(Functions->Final(State));
+	}
+
+private:
+	template <uint32... ArgIndices>
+	void StepImpl(const FSQLiteFunctionArgs& InArgs, TIntegerSequence<uint32, ArgIndices...>)
+	{
+		Functions->Step(State, GetArg<typename TDecay<ArgTypes>::Type>(InArgs, ArgIndices)...);
+	}
+
+	TSharedRef<const FFunctions> Functions;
+	StateType State{};
+};
+
+} // namespace SQLiteFunctionImpl
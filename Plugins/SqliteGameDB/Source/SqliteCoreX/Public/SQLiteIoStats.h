@@ -0,0 +1,80 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "HAL/PlatformTime.h"
+#include "Math/NumericLimits.h"
+#include "Stats/Stats.h"
+
+/** Stat group for the SQLite databases (VFS file operations are reported as part of this group) */
+DECLARE_STATS_GROUP(TEXT("SqliteGameDB"), STATGROUP_SqliteGameDB, STATCAT_Advanced);
+
+/**
+ * Counters for a single kind of file operation (eg, Read) performed by the unreal-fs VFS.
+ */
+struct FSQLiteIoOpStats
+{
+	/** Number of buckets in LatencyHistogram */
+	static constexpr int32 NumLatencyBuckets = 8;
+
+	/** Number of operations performed */
+	uint64 NumOps = 0;
+
+	/** Number of bytes transferred by the operations (zero for operations that don't transfer data, eg, Sync) */
+	uint64 NumBytes = 0;
+
+	/** Total time spent in the operations, in cycles (see GetTotalSeconds) */
+	uint64 TotalCycles = 0;
+
+	/** Number of operations whose latency fell into each bucket (see GetLatencyBucketUpperBoundSeconds) */
+	uint64 LatencyHistogram[NumLatencyBuckets] = {};
+
+	/** Get the total time spent in the operations, in seconds */
+	double GetTotalSeconds() const
+	{
+		return FPlatformTime::ToSeconds64(TotalCycles);
+	}
+
+	/**
+	 * Get the (exclusive) upper bound of the latency bucket at the given index, in seconds.
+	 * @note Buckets are 4x wider than the one before them, starting from 16us; the last bucket has no upper bound.
+	 */
+	static double GetLatencyBucketUpperBoundSeconds(const int32 InBucketIndex)
+	{
+		return InBucketIndex < NumLatencyBuckets - 1
+			? 16e-6 * (double)(1 << (InBucketIndex * 2))
+			: TNumericLimits<double>::Max();
+	}
+
+	/** Get the index of the latency bucket that an operation with the given duration falls into */
+	static int32 GetLatencyBucketIndex(const double InSeconds)
+	{
+		int32 BucketIndex = 0;
+		while (BucketIndex < NumLatencyBuckets - 1 && InSeconds >= GetLatencyBucketUpperBoundSeconds(BucketIndex))
+		{
+			++BucketIndex;
+		}
+		return BucketIndex;
+	}
+};
+
+/**
+ * I/O counters for a database file, as recorded by the unreal-fs VFS.
+ * @note Operations on the journals of a database (rollback journal, WAL, and super-journal) are attributed to the database itself.
+ * @note Counters cover the lifetime of the process (not just the current connection), so snapshots can be compared to measure the I/O performed between them.
+ */
+struct FSQLiteIoStats
+{
+	/** SQLite file control opcode that the unreal-fs VFS handles by writing a snapshot of the FSQLiteIoStats of a file into the given pointer (see sqlite3_file_control) */
+	static constexpr int FileControlOp = 0x55450001;
+
+	/** Filename of the database these stats belong to, or an empty string for the stats shared by all temporary files */
+	FString Filename;
+
+	FSQLiteIoOpStats Read;
+	FSQLiteIoOpStats Write;
+	FSQLiteIoOpStats Sync;
+	FSQLiteIoOpStats Truncate;
+};
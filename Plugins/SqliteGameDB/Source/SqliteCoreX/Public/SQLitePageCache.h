@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+
+/**
+ * Page cache shared by every SQLite connection (see SQLITE_CONFIG_PCACHE2).
+ * Pages are allocated from slab pools under a single memory budget, and once the budget is reached the least recently used unpinned page of
+ * any connection (or attached database) is recycled. The share of the budget used by each database is set via its cache size (see PRAGMA cache_size),
+ * as a database that has reached its own cache size recycles its own pages rather than taking pages from other databases.
+ */
+class SQLITECOREX_API FSQLitePageCache
+{
+public:
+	/** Register the page cache with SQLite - called from FSqliteCoreX::StaticInitializeSQLite, as it must happen before sqlite3_initialize */
+	static void Register();
+
+	/**
+	 * Set the memory budget shared by the pages of every database, evicting unpinned pages if the new budget is already exceeded.
+	 * @note Pages that SQLite requires (eg, pinned pages) may still be allocated over budget, but only once nothing else can be recycled or spilled.
+	 */
+	static void SetMemoryBudget(const int64 InBudgetBytes);
+
+	/** Get the memory budget shared by the pages of every database */
+	static int64 GetMemoryBudget();
+
+	/** Get the memory currently used by the pages of every database */
+	static int64 GetMemoryUsed();
+};
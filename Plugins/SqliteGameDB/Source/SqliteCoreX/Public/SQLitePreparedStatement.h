@@ -9,10 +9,14 @@
 #include "Misc/EnumClassFlags.h"
 #include "UObject/NameTypes.h"
 #include "Containers/ArrayView.h"
+#include "Containers/Map.h"
+#include "Containers/StringView.h"
 #include "Containers/UnrealString.h"
 #include "Internationalization/Text.h"
+#include "Misc/Crc.h"
 #include "Templates/EnableIf.h"
 #include "Templates/IsEnumClass.h"
+#include "Templates/Tuple.h"
 #include "Delegates/IntegerSequence.h"
 
 class FSQLiteDatabase;
@@ -63,6 +67,81 @@ enum class ESQLitePreparedStatementExecuteRowResult : uint8
 	Error,
 };
 
+namespace SQLitePreparedStatementImpl
+{
+
+/**
+ * Key funcs for the binding name to index map of a prepared statement.
+ * Binding names are case-sensitive in SQLite, and the map can be queried with a raw string so that no temporary FString is needed for a look-up.
+ */
+struct FBindingNameKeyFuncs : BaseKeyFuncs<TPair<FString, int32>, FString, /*bInAllowDuplicateKeys*/false>
+{
+	static const FString& GetSetKey(const TPair<FString, int32>& InElement)
+	{
+		return InElement.Key;
+	}
+
+	static bool Matches(const FString& InA, const FString& InB)
+	{
+		return InA.Equals(InB, ESearchCase::CaseSensitive);
+	}
+
+	static bool Matches(const FString& InA, const TCHAR* InB)
+	{
+		return FCString::Strcmp(*InA, InB) == 0;
+	}
+
+	static uint32 GetKeyHash(const FString& InKey)
+	{
+		return GetKeyHash(*InKey);
+	}
+
+	static uint32 GetKeyHash(const TCHAR* InKey)
+	{
+		return FCrc::StrCrc32(InKey);
+	}
+};
+
+/**
+ * Key funcs for the column name to index map of a prepared statement.
+ * Column names are case-insensitive in SQLite, and the map can be queried with a raw string so that no temporary FString is needed for a look-up.
+ */
+struct FColumnNameKeyFuncs : BaseKeyFuncs<TPair<FString, int32>, FString, /*bInAllowDuplicateKeys*/false>
+{
+	static const FString& GetSetKey(const TPair<FString, int32>& InElement)
+	{
+		return InElement.Key;
+	}
+
+	static bool Matches(const FString& InA, const FString& InB)
+	{
+		return InA.Equals(InB, ESearchCase::IgnoreCase);
+	}
+
+	static bool Matches(const FString& InA, const TCHAR* InB)
+	{
+		return FCString::Stricmp(*InA, InB) == 0;
+	}
+
+	static uint32 GetKeyHash(const FString& InKey)
+	{
+		return GetKeyHash(*InKey);
+	}
+
+	/** Hashes the lower case form of each character (as Stricmp compares them), so names that Match always hash the same, without allocating a lower case copy */
+	static uint32 GetKeyHash(const TCHAR* InKey)
+	{
+		uint32 Hash = 0;
+		for (const TCHAR* Char = InKey; *Char; ++Char)
+		{
+			Hash = (Hash * 31) + (uint32)FChar::ToLower(*Char);
+		}
+		return Hash;
+	}
+};
+
+} // namespace SQLitePreparedStatementImpl
+
 /**
  * Wrapper around an SQLite prepared statement.
  * @see sqlite3_stmt.
@@ -122,6 +201,7 @@ public:
 
 	/**
 	 * Get the index of a given binding from its name.
+	 * @note Binding names are cached when the statement is created, so this is a hash look-up; however it's still better to look-up a binding index once rather than look it up for each bind.
 	 * @return The binding index, or 0 if it could not be found.
 	 */
 	int32 GetBindingIndexByName(const TCHAR* InBindingName) const;
@@ -189,6 +269,26 @@ public:
 	bool SetBindingValueByName(const TCHAR* InBindingName, const FGuid& InValue);
 	bool SetBindingValueByIndex(const int32 InBindingIndex, const FGuid& InValue);
 
+	/**
+	 * Set the given binding from its name or index to a blob of the given size that is filled with zeros.
+	 * @note This is used to reserve space for a blob that will be written incrementally (see FSQLiteBlobArchive).
+	 */
+	bool SetBindingZeroBlobByName(const TCHAR* InBindingName, const int64 InBlobSizeBytes);
+	bool SetBindingZeroBlobByIndex(const int32 InBindingIndex, const int64 InBlobSizeBytes);
+
+	/**
+	 * Set the given binding from its name or index to an array of values, to be expanded by the carray table-valued function.
+	 * This allows an IN-list of any length to be bound to a single parameter, eg, "SELECT * FROM Items WHERE Id IN carray(@Ids)", rather than
+	 * building a new statement for each length of list. GUIDs are bound as blobs, in the same form as SetBindingValueByIndex uses for a single FGuid.
+	 * @note The values are copied when bound, so the given array doesn't need to outlive the binding.
+	 */
+	bool SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<int64> InValues);
+	bool SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<int64> InValues);
+	bool SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<FString> InValues);
+	bool SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<FString> InValues);
+	bool SetBindingArrayByName(const TCHAR* InBindingName, TConstArrayView<FGuid> InValues);
+	bool SetBindingArrayByIndex(const int32 InBindingIndex, TConstArrayView<FGuid> InValues);
+
 	/**
 	 * Set the given null binding from its name or index.
 	 */
@@ -209,6 +309,16 @@ public:
 	 */
 	int64 Execute(TFunctionRef<ESQLitePreparedStatementExecuteRowResult(const FSQLitePreparedStatement&)> InCallback);
 
+	/**
+	 * Execute a statement that requires no result state once per row of a batch, reusing the statement for every row.
+	 * The rows are executed within a single transaction (or nested within the current transaction, if there is one), so either every row is applied or none are.
+	 * @note The statement must not be active. The bind callback is called with the row index to set the bindings for that row before it is executed, and should return false to abort the batch.
+	 * @note The bindings are cleared once the batch is complete.
+	 * @param OutErrorMessage If set, receives the error that failed the batch (captured before the rollback, which would otherwise replace the last error of the database).
+	 * @return The number of rows executed, or INDEX_NONE if an error occurred (in which case any changes made by the batch have been rolled back).
+	 */
+	int64 ExecuteBatch(const int64 InNumRows, TFunctionRef<bool(const int64 InRowIndex)> InBindRowCallback, FString* OutErrorMessage = nullptr);
+
 	/**
 	 * Step the SQLite prepared statement to try and move on to the next result from the statement.
 	 * @note See FSQLiteDatabase::Execute for a simple example of stepping a statement.
@@ -280,6 +390,22 @@ public:
 	bool GetColumnValueByName(const TCHAR* InColumnName, FGuid& OutValue) const;
 	bool GetColumnValueByIndex(const int32 InColumnIndex, FGuid& OutValue) const;
 
+	/**
+	 * Get a view of the string value of a column from its name or index, in the UTF-8 encoding that SQLite stores it in.
+	 * This avoids the allocation and conversion of the FString overloads, so should be preferred when the value is only hashed, compared, or parsed.
+	 * @note The view points into memory owned by SQLite, and is only valid until the statement is stepped, reset, or destroyed, or until another accessor reads the same column as a different type or encoding (eg, as an FString from a UTF-16 database).
+	 */
+	bool GetColumnUtf8ViewByName(const TCHAR* InColumnName, FUtf8StringView& OutValue) const;
+	bool GetColumnUtf8ViewByIndex(const int32 InColumnIndex, FUtf8StringView& OutValue) const;
+
+	/**
+	 * Get a view of the blob value of a column from its name or index.
+	 * This avoids the allocation and copy of the TArray overloads, so should be preferred when the value is only hashed, compared, or parsed.
+	 * @note The view points into memory owned by SQLite, and is only valid until the statement is stepped, reset, or destroyed, or until another accessor reads the same column as a different type.
+	 */
+	bool GetColumnBlobViewByName(const TCHAR* InColumnName, TArrayView<const uint8>& OutValue) const;
+	bool GetColumnBlobViewByIndex(const int32 InColumnIndex, TArrayView<const uint8>& OutValue) const;
+
 	/**
 	 * Get the type of a column from its name or index.
 	 * @note Column types in SQLite are somewhat arbitrary are not enforced, nor need to be consistent between the same column in different rows.
@@ -287,13 +413,35 @@ public:
 	bool GetColumnTypeByName(const TCHAR* InColumnName, ESQLiteColumnType& OutColumnType) const;
 	bool GetColumnTypeByIndex(const int32 InColumnIndex, ESQLiteColumnType& OutColumnType) const;
 
+	/**
+	 * Get the declared type of a column from its name or index (ie, the type given to the column in its CREATE TABLE statement).
+	 * @note The declared type is a property of the statement rather than of a row, so unlike GetColumnTypeByIndex this can be used before stepping the statement.
+	 * @note Columns that are not a direct reference to a table column (eg, expressions) have no declared type, and will return an empty string.
+	 */
+	bool GetColumnDeclaredTypeByName(const TCHAR* InColumnName, FString& OutDeclaredType) const;
+	bool GetColumnDeclaredTypeByIndex(const int32 InColumnIndex, FString& OutDeclaredType) const;
+
 	/**
 	 * Get the column names affected by this statement.
 	 */
 	const TArray<FString>& GetColumnNames() const;
 
+	/**
+	 * Get the declared types of the columns affected by this statement (in the same order as GetColumnNames).
+	 */
+	const TArray<FString>& GetColumnDeclaredTypes() const;
+
+	/**
+	 * Get the number of times SQLite has re-prepared this statement (eg, when stepped after a schema change), which may have changed its columns.
+	 * Anything derived from the columns of the statement can be reused for as long as this is unchanged.
+	 */
+	int32 GetReprepareCount() const;
+
 private:
-	/** Attempt to cache the column names, if required and possible */
+	/** Cache the binding names of the statement (called when the statement is created) */
+	void CacheBindingNames();
+
+	/** Attempt to cache the column names (and their indices and declared types), if required and possible (including re-caching them after a re-prepare) */
 	void CacheColumnNames() const;
 
 	/** Check whether the given column index is within the range of available columns */
@@ -315,6 +463,11 @@ private:
 	template <typename T>
 	bool SetBindingValueByIndex_Real(const int32 InBindingIndex, const T InValue);
 
+	/**
+	 * Set the given string binding from its index, using the native text function of the database encoding.
+	 */
+	bool SetBindingValueByIndex_Text(const int32 InBindingIndex, const TCHAR* InValue, const int32 InValueLen);
+
 	/**
 	 * Get the integer value of a column from its name or index.
 	 */
@@ -331,11 +484,33 @@ private:
 	template <typename T>
 	bool GetColumnValueByIndex_Real(const int32 InColumnIndex, T& OutValue) const;
 
+	/**
+	 * Get the string value of a column from its index, using the native text function of the database encoding.
+	 * The callback is given the string data and its length (the data is only valid during the callback).
+	 */
+	template <typename CallbackType>
+	bool GetColumnValueByIndex_Text(const int32 InColumnIndex, CallbackType&& InCallback) const;
+
 	/** Internal SQLite prepared statement handle */
 	struct sqlite3_stmt* Statement;
 
+	/** True if the database stored text as UTF-16 when this statement was created, so text can be bound and read as TCHAR without transcoding */
+	bool bUseUTF16Text = false;
+
+	/** Cached map of binding names to their binding index (generated when the statement is created) */
+	TMap<FString, int32, FDefaultSetAllocator, SQLitePreparedStatementImpl::FBindingNameKeyFuncs> CachedBindingIndices;
+
 	/** Cached array of column names (generated on-demand when needed by the API) */
 	mutable TArray<FString> CachedColumnNames;
+
+	/** Cached map of column names to their column index (generated alongside CachedColumnNames) */
+	mutable TMap<FString, int32, FDefaultSetAllocator, SQLitePreparedStatementImpl::FColumnNameKeyFuncs> CachedColumnIndices;
+
+	/** Cached array of column declared types (generated alongside CachedColumnNames) */
+	mutable TArray<FString> CachedColumnDeclaredTypes;
+
+	/** The re-prepare count of the statement when the columns were cached, or INDEX_NONE if they aren't cached */
+	mutable int32 CachedColumnsReprepareCount = INDEX_NONE;
 };
 
 /** Macro wrapper for the columns and bindings mixin template types, so that they can be used as an argument to other macros */
@@ -434,6 +609,23 @@ public:
 		return bResult;
 	}
 
+	/**
+	 * Set the value of all bindings from each row of a batch, and execute a statement that requires no result state once per row.
+	 * The rows are executed within a single transaction (or nested within the current transaction, if there is one), so either every row is applied or none are.
+	 * @note The statement must not be active.
+	 * @return The number of rows executed, or INDEX_NONE if an error occurred (in which case any changes made by the batch have been rolled back).
+	 */
+	int64 ExecuteBatch(TConstArrayView<TTuple<Bindings...>> InBindingRows)
+	{
+		return FSQLitePreparedStatement::ExecuteBatch(InBindingRows.Num(), [this, &InBindingRows](const int64 InRowIndex)
+		{
+			return InBindingRows[InRowIndex].ApplyAfter([this](const Bindings&... BindingArgs)
+			{
+				return SetBindingValues(BindingArgs...);
+			});
+		});
+	}
+
 	/**
 	 * Execute a statement and enumerate the result state.
 	 * @note The statement must not be active, and any required bindings must have been set before calling this function (this function will not modify bindings).
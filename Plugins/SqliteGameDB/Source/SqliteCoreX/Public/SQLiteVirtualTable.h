@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "SQLiteFunction.h"
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "Templates/UniquePtr.h"
+
+/**
+ * A column of a virtual table registered via FSQLiteDatabase::RegisterVirtualTable.
+ */
+struct FSQLiteVirtualTableColumn
+{
+	/** Name of the column */
+	FString Name;
+
+	/** Declared type of the column (eg, INTEGER, REAL, TEXT, or BLOB), which gives the column its affinity */
+	FString Type;
+};
+
+/**
+ * Index of the rows of a virtual table by key, created via ISQLiteVirtualTableSource::CreateKeyIndex.
+ */
+class ISQLiteVirtualTableKeyIndex
+{
+public:
+	virtual ~ISQLiteVirtualTableKeyIndex() = default;
+
+	/**
+	 * Get the indexed rows whose key column equals the given value (with the same rules as ISQLiteVirtualTableSource::FindRows).
+	 */
+	virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const = 0;
+};
+
+/**
+ * Read-only source of the rows of a virtual table registered via FSQLiteDatabase::RegisterVirtualTable.
+ * This allows SQL to read (and join against) data that lives in memory, in place, rather than it first being copied into a table.
+ *
+ * Rows are opaque pointers owned by the source, which only need to remain valid until the statement reading them is reset.
+ * @note The source is only called while a statement reading the table is being stepped, on whichever thread is stepping it.
+ */
+class ISQLiteVirtualTableSource
+{
+public:
+	virtual ~ISQLiteVirtualTableSource() = default;
+
+	/**
+	 * Get the columns of the table (called when the table is first used by a connection, so the columns must not change once registered).
+	 */
+	virtual TArray<FSQLiteVirtualTableColumn> GetColumns() const = 0;
+
+	/**
+	 * Get the index of the key column, or INDEX_NONE if the table has no key.
+	 * Equality constraints on the key column are given to FindRows, rather than SQLite having to scan every row to test them.
+	 */
+	virtual int32 GetKeyColumnIndex() const
+	{
+		return INDEX_NONE;
+	}
+
+	/**
+	 * Can the table be read from the calling thread?
+	 * If not, the statement reading it fails with SQLITE_MISUSE and the given error, rather than the source being asked for rows.
+	 */
+	virtual bool CanRead(FString& OutError) const
+	{
+		return true;
+	}
+
+	/**
+	 * Get every row of the table.
+	 */
+	virtual void GetRows(TArray<const void*>& OutRows) const = 0;
+
+	/**
+	 * Get the rows of the table whose key column equals the given value (the first and only argument of InKey).
+	 * SQLite still tests the constraint against the rows returned, so the source may return extra rows (the default returns every row).
+	 */
+	virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const
+	{
+		GetRows(OutRows);
+	}
+
+	/**
+	 * Create an index of the current rows by key, for a cursor that looks up more than one key (eg, the inner table of a join).
+	 * The cursor uses the index for the rest of its lookups, and destroys it when the statement reading the table is reset,
+	 * so each lookup costs a hash probe rather than a call to FindRows.
+	 * @return null (the default) to have every lookup call FindRows.
+	 */
+	virtual TUniquePtr<ISQLiteVirtualTableKeyIndex> CreateKeyIndex() const
+	{
+		return nullptr;
+	}
+
+	/**
+	 * Set the value of the given column of a row (leaving the result unset returns NULL).
+	 */
+	virtual void GetColumnValue(const void* InRow, const int32 InColumnIndex, FSQLiteFunctionResult& OutResult) const = 0;
+};
@@ -22,6 +22,9 @@ public SqliteCoreX(ReadOnlyTargetRules Target) : base(Target)
 			// We call sqlite3_initialize ourselves during module init
 			PrivateDefinitions.Add("SQLITE_OMIT_AUTOINIT");
 
+			// Don't track memory usage statistics, as doing so takes a global mutex for every allocation
+			PrivateDefinitions.Add("SQLITE_DEFAULT_MEMSTATUS=0");
+
 			// Use the math.h version of isnan rather than the SQLite version to avoid a -ffast-math error
 			PrivateDefinitions.Add("SQLITE_HAVE_ISNAN=1");
 
@@ -50,12 +53,15 @@ public SqliteCoreX(ReadOnlyTargetRules Target) : base(Target)
 			if (Target.bCompileCustomSQLitePlatform)
 			{
 				// Note: The Unreal HAL doesn't provide an implementation of shared memory (as not all platforms implement it),
-				// nor does it provide an implementation of granular file locks. These two things affect the concurrency of an
-				// SQLite database as only one FSQLiteDatabase can have the file open at the same time.
+				// so we provide an in-process one (see FSQLiteShmNode) which allows WAL journaling within a single process.
+				// It also doesn't provide an implementation of granular file locks, so we provide in-process ones (see FSQLiteFileNode)
+				// which allow multiple FSQLiteDatabase connections to the same file within a single process.
 				PrivateDefinitions.Add("SQLITE_OS_OTHER=1");			// We are a custom OS
 				PrivateDefinitions.Add("SQLITE_ZERO_MALLOC");			// We provide our own malloc implementation
 				PrivateDefinitions.Add("SQLITE_MUTEX_NOOP");			// We provide our own mutex implementation
 				PrivateDefinitions.Add("SQLITE_OMIT_LOAD_EXTENSION");	// We disable extension loading
+				PrivateDefinitions.Add("SQLITE_MAX_MMAP_SIZE=0x7fff0000");	// We provide memory mapped I/O (SQLite only enables it by default for the platforms it knows about)
+				PrivateDefinitions.Add("SQLITE_ENABLE_BATCH_ATOMIC_WRITE");	// We provide batch atomic writes, so small transactions can skip the rollback journal
 			}
 
 			bEnableUndefinedIdentifierWarnings = false; // The embedded SQLite implementation generates a lot of these warnings
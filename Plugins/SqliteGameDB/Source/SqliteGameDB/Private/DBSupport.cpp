@@ -0,0 +1,182 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "DBSupport.h"
+
+#pragma region Columnar Query Result
+
+int32 FColumnarQueryResult::FindColumn(const FString& ColumnName) const
+{
+	return Columns.IndexOfByPredicate([&ColumnName](const FQueryResultColumn& Column)
+	{
+		return Column.Name.Equals(ColumnName, ESearchCase::IgnoreCase);
+	});
+}
+
+int64 FColumnarQueryResult::GetInteger(const int32 Row, const int32 Column) const
+{
+	switch (GetType(Row, Column))
+	{
+	case EDbValueType::Integer:
+		return Columns[Column].Values[Row];
+	case EDbValueType::Float:
+		return static_cast<int64>(GetFloat(Row, Column));
+	default:
+		return 0;
+	}
+}
+
+double FColumnarQueryResult::GetFloat(const int32 Row, const int32 Column) const
+{
+	switch (GetType(Row, Column))
+	{
+	case EDbValueType::Integer:
+		return static_cast<double>(Columns[Column].Values[Row]);
+	case EDbValueType::Float:
+		{
+			double Value;
+			FMemory::Memcpy(&Value, &Columns[Column].Values[Row], sizeof(double));
+			return Value;
+		}
+	default:
+		return 0.0;
+	}
+}
+
+FString FColumnarQueryResult::GetString(const int32 Row, const int32 Column) const
+{
+	switch (GetType(Row, Column))
+	{
+	case EDbValueType::Integer:
+		return FString::Printf(TEXT("%lld"), GetInteger(Row, Column));
+	case EDbValueType::Float:
+		return FString::Printf(TEXT("%f"), GetFloat(Row, Column));
+	case EDbValueType::String:
+		{
+			const FUtf8StringView Text = GetStringView(Row, Column);
+			const FUTF8ToTCHAR Converted(Text.GetData(), Text.Len());
+			return FString(Converted.Length(), Converted.Get());
+		}
+	default:
+		return FString();
+	}
+}
+
+FUtf8StringView FColumnarQueryResult::GetStringView(const int32 Row, const int32 Column) const
+{
+	if (GetType(Row, Column) != EDbValueType::String)
+		return FUtf8StringView();
+
+	const int32 StringIdx = static_cast<int32>(Columns[Column].Values[Row]);
+	return FUtf8StringView(StringData.GetData() + StringOffsets[StringIdx],
+	                       StringOffsets[StringIdx + 1] - StringOffsets[StringIdx]);
+}
+
+TConstArrayView<uint8> FColumnarQueryResult::GetBlob(const int32 Row, const int32 Column) const
+{
+	if (GetType(Row, Column) != EDbValueType::Blob)
+		return TConstArrayView<uint8>();
+
+	const int32 BlobIdx = static_cast<int32>(Columns[Column].Values[Row]);
+	return TConstArrayView<uint8>(BlobData.GetData() + BlobOffsets[BlobIdx],
+	                              BlobOffsets[BlobIdx + 1] - BlobOffsets[BlobIdx]);
+}
+
+FQueryResultField FColumnarQueryResult::GetField(const int32 Row, const int32 Column) const
+{
+	FQueryResultField Field;
+
+	switch (GetType(Row, Column))
+	{
+	case EDbValueType::Integer:
+		Field = FQueryResultField(GetInteger(Row, Column));
+		break;
+	case EDbValueType::Float:
+		Field = FQueryResultField(GetFloat(Row, Column));
+		break;
+	case EDbValueType::String:
+		Field = FQueryResultField(GetString(Row, Column));
+		break;
+	case EDbValueType::Blob:
+		Field = FQueryResultField(TArray<uint8>(GetBlob(Row, Column)));
+		break;
+	default:
+		break;
+	}
+
+	if (Columns.IsValidIndex(Column))
+		Field.ColName = Columns[Column].Name;
+
+	return Field;
+}
+
+FQueryResultRow FColumnarQueryResult::GetRow(const int32 Row) const
+{
+	FQueryResultRow ResultRow;
+	ResultRow.Fields.Reserve(Columns.Num());
+	for (int32 ColIdx = 0; ColIdx < Columns.Num(); ColIdx++)
+		ResultRow.Fields.Add(GetField(Row, ColIdx));
+	return ResultRow;
+}
+
+FQueryResult FColumnarQueryResult::ToQueryResult() const
+{
+	FQueryResult Results;
+	Results.Rows.Reserve(NumRows);
+	for (int32 RowIdx = 0; RowIdx < NumRows; RowIdx++)
+		Results.Rows.Add(GetRow(RowIdx));
+	return Results;
+}
+
+SIZE_T FColumnarQueryResult::GetAllocatedSize() const
+{
+	SIZE_T Size = Columns.GetAllocatedSize() + StringData.GetAllocatedSize() + StringOffsets.GetAllocatedSize()
+		+ BlobData.GetAllocatedSize() + BlobOffsets.GetAllocatedSize();
+	for (const FQueryResultColumn& Column : Columns)
+		Size += Column.Name.GetAllocatedSize() + Column.Types.GetAllocatedSize() + Column.Values.GetAllocatedSize();
+	return Size;
+}
+
+void FColumnarQueryResult::AddColumn(const FString& ColumnName)
+{
+	FQueryResultColumn& Column = Columns.AddDefaulted_GetRef();
+	Column.Name = ColumnName;
+}
+
+void FColumnarQueryResult::AddNull(const int32 Column)
+{
+	Columns[Column].Types.Add(EDbValueType::Null);
+	Columns[Column].Values.Add(0);
+}
+
+void FColumnarQueryResult::AddInteger(const int32 Column, const int64 Value)
+{
+	Columns[Column].Types.Add(EDbValueType::Integer);
+	Columns[Column].Values.Add(Value);
+}
+
+void FColumnarQueryResult::AddFloat(const int32 Column, const double Value)
+{
+	int64 ValueBits;
+	FMemory::Memcpy(&ValueBits, &Value, sizeof(double));
+
+	Columns[Column].Types.Add(EDbValueType::Float);
+	Columns[Column].Values.Add(ValueBits);
+}
+
+void FColumnarQueryResult::AddString(const int32 Column, const FUtf8StringView Value)
+{
+	Columns[Column].Types.Add(EDbValueType::String);
+	Columns[Column].Values.Add(StringOffsets.Num() - 1);
+	StringData.Append(Value.GetData(), Value.Len());
+	StringOffsets.Add(StringData.Num());
+}
+
+void FColumnarQueryResult::AddBlob(const int32 Column, const TConstArrayView<uint8> Value)
+{
+	Columns[Column].Types.Add(EDbValueType::Blob);
+	Columns[Column].Values.Add(BlobOffsets.Num() - 1);
+	BlobData.Append(Value.GetData(), Value.Num());
+	BlobOffsets.Add(BlobData.Num());
+}
+
+#pragma endregion
@@ -3,10 +3,13 @@
 
 #include "DbBase.h"
 #include "DbStatement.h"
+#include "DbLiveTableSource.h"
 #include "CustomLogging.h"
 #include "PreparedStatementManager.h"
 #include "SqliteGameDBSettings.h"
+#include "Engine/Engine.h"
 #include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
 #include "HAL/PlatformFileManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetSystemLibrary.h"
@@ -33,12 +36,37 @@ void UDbBase::Initialize(FString DatabaseFilePath, FGameDbConfig Config)
 	// All the basic checks return OK, time to try to connect to the Db...
 	SqliteDb = new FSQLiteDatabase();
 
-	verifyf(SqliteDb->Open(*DbFilePath, ESQLiteDatabaseOpenMode::ReadWrite),
+	/* Read-only databases don't need an exclusive (writable) handle, so they can be served from inside the pak. */
+	const ESQLiteDatabaseOpenMode OpenMode = Config.bReadOnly
+		                                         ? ESQLiteDatabaseOpenMode::ReadOnly
+		                                         : ESQLiteDatabaseOpenMode::ReadWrite;
+
+	const ESQLiteDatabaseThreadingMode ThreadingMode = Config.bGameThreadOnly
+		                                                   ? ESQLiteDatabaseThreadingMode::MultiThread
+		                                                   : ESQLiteDatabaseThreadingMode::Serialized;
+
+	/* Small, hot databases can be read in one go and served from memory, rather than paging them in through the file system. */
+	const bool bOpened = Config.bLoadIntoMemory
+		                     ? SqliteDb->OpenFileIntoMemory(*DbFilePath, OpenMode, ThreadingMode)
+		                     : SqliteDb->Open(*DbFilePath, OpenMode, ThreadingMode);
+
+	verifyf(bOpened,
 		TEXT("Attempt to open DB connection failed, reason: %s \n"),
-		TEXT("Unreal requires an exclusive lock to the DB file."));
+		Config.bReadOnly
+			? TEXT("Read-only mode requires a shared (read) lock on the DB file, which fails if another process holds it exclusively.")
+			: TEXT("Read-write mode requires the DB file to be writable and not exclusively locked by another process."));
 
 	UE_LOG(LogSqliteGameDB, Log, TEXT("Connection to DB opened successfully. %s"), *DbFilePath);
 
+	/* A negative cache size is in KiB rather than pages. */
+	if (Config.CacheSizeKiB > 0)
+	{
+		SqliteDb->Execute(*FString::Printf(TEXT("PRAGMA cache_size = -%d;"), Config.CacheSizeKiB));
+	}
+
+	/* Functions must be registered before any statement that uses them is prepared. */
+	RegisterBuiltinFunctions();
+
 	QueryManager = NewObject<UPreparedStatementManager>();
 	QueryManager->Initialize(this);
 
@@ -47,6 +75,88 @@ void UDbBase::Initialize(FString DatabaseFilePath, FGameDbConfig Config)
 	Startup(DatabaseFilePath, Config);
 }
 
+void UDbBase::RegisterBuiltinFunctions() const
+{
+	/* dist3(LocationX, LocationY, LocationZ, x, y, z) - distance between two points, or NULL if any argument isn't a number (or numeric text). */
+	SqliteDb->RegisterScalarFunction(
+		TEXT("dist3"), 6, ESQLiteFunctionFlags::Deterministic,
+		[](const FSQLiteFunctionArgs& Args, FSQLiteFunctionResult& Result)
+		{
+			double Coords[6];
+			for (int32 ArgIdx = 0; ArgIdx < 6; ArgIdx++)
+			{
+				ESQLiteColumnType ArgType;
+				if (!Args.GetType(ArgIdx, ArgType))
+				{
+					Result.SetNull();
+					return;
+				}
+
+				/* The typed overloads would read 'abc' as 0, which silently measures from the origin. */
+				if (ArgType == ESQLiteColumnType::String)
+				{
+					FString Text;
+					if (!Args.GetValue(ArgIdx, Text) || !FCString::IsNumeric(*Text))
+					{
+						Result.SetNull();
+						return;
+					}
+				}
+				else if (ArgType != ESQLiteColumnType::Integer && ArgType != ESQLiteColumnType::Float)
+				{
+					Result.SetNull();
+					return;
+				}
+				Args.GetValue(ArgIdx, Coords[ArgIdx]);
+			}
+			Result.SetValue(FVector::Dist(FVector(Coords[0], Coords[1], Coords[2]), FVector(Coords[3], Coords[4], Coords[5])));
+		});
+
+	/* within_box(LocationX, LocationY, LocationZ, MinX, MinY, MinZ, MaxX, MaxY, MaxZ) - 1 if the point is inside the box (inclusive). */
+	SqliteDb->RegisterScalarFunction<bool, double, double, double, double, double, double, double, double, double>(
+		TEXT("within_box"),
+		[](const double X, const double Y, const double Z,
+		   const double MinX, const double MinY, const double MinZ,
+		   const double MaxX, const double MaxY, const double MaxZ)
+		{
+			return FBox(FVector(MinX, MinY, MinZ), FVector(MaxX, MaxY, MaxZ)).IsInsideOrOn(FVector(X, Y, Z));
+		});
+
+	/* guid_parse(Text) - the GUID as a blob (the form FGuid parameters are bound in), or NULL if the text isn't a GUID. */
+	SqliteDb->RegisterScalarFunction<TOptional<FGuid>, FString>(
+		TEXT("guid_parse"),
+		[](const FString& Text) -> TOptional<FGuid>
+		{
+			FGuid Guid;
+			if (!FGuid::Parse(Text, Guid))
+			{
+				return TOptional<FGuid>();
+			}
+			return Guid;
+		});
+
+	/* guid_format(Blob) - the GUID blob as text, or NULL if the argument isn't a 16 byte blob. */
+	SqliteDb->RegisterScalarFunction(
+		TEXT("guid_format"), 1, ESQLiteFunctionFlags::Deterministic,
+		[](const FSQLiteFunctionArgs& Args, FSQLiteFunctionResult& Result)
+		{
+			/* Text (or a number) would otherwise be read back as its bytes, so a 16 character string would format as a GUID. */
+			ESQLiteColumnType ArgType;
+			TArray<uint8>     Blob;
+			if (!Args.GetType(0, ArgType) || ArgType != ESQLiteColumnType::Blob
+				|| !Args.GetValue(0, Blob) || Blob.Num() != sizeof(FGuid))
+			{
+				Result.SetNull();
+				return;
+			}
+
+			FGuid Guid;
+			FMemoryReader GuidReader(Blob);
+			GuidReader << Guid;
+			Result.SetValue(Guid.ToString());
+		});
+}
+
 void UDbBase::BeginDestroy()
 {
 	TearDown();
@@ -82,6 +192,37 @@ void UDbBase::TearDown()
 	//checkNoEntry();
 }
 
+#pragma region Live Tables
+
+bool UDbBase::RegisterActorTable(const UObject* WorldContextObject, const FString TableName,
+                                 TSubclassOf<AActor> ActorClass, const FName KeyPropertyName)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World || !ActorClass || !SqliteDb || !SqliteDb->IsValid())
+		return false;
+
+	return SqliteDb->RegisterVirtualTable(*TableName, MakeShared<FDbActorTableSource>(World, ActorClass, KeyPropertyName));
+}
+
+bool UDbBase::RegisterStructArrayTable(const FString& TableName, const UScriptStruct* RowStruct,
+                                       const FScriptArray* Rows, const FName KeyPropertyName)
+{
+	if (!RowStruct || !Rows || !SqliteDb || !SqliteDb->IsValid())
+		return false;
+
+	return SqliteDb->RegisterVirtualTable(*TableName, MakeShared<FDbStructArrayTableSource>(RowStruct, Rows, KeyPropertyName));
+}
+
+bool UDbBase::UnregisterLiveTable(const FString TableName)
+{
+	if (!SqliteDb || !SqliteDb->IsValid())
+		return false;
+
+	return SqliteDb->UnregisterVirtualTable(*TableName);
+}
+
+#pragma endregion
+
 FString UDbBase::GetDbName() const
 {
 	if (SqliteDb && SqliteDb->IsValid())
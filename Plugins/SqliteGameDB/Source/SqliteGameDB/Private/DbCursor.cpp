@@ -0,0 +1,184 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "DbCursor.h"
+
+FDbCursor::FDbCursor(FSQLitePreparedStatement* InStatement)
+	: Statement(InStatement)
+{
+}
+
+FDbCursor::~FDbCursor()
+{
+	Close();
+}
+
+FDbCursor::FDbCursor(FDbCursor&& Other)
+	: Statement(Other.Statement)
+	, bStarted(Other.bStarted)
+	, bHasRow(Other.bHasRow)
+{
+	Other.Statement = nullptr;
+	Other.bHasRow   = false;
+}
+
+FDbCursor& FDbCursor::operator=(FDbCursor&& Other)
+{
+	if (this != &Other)
+	{
+		Close();
+
+		Statement = Other.Statement;
+		bStarted  = Other.bStarted;
+		bHasRow   = Other.bHasRow;
+
+		Other.Statement = nullptr;
+		Other.bHasRow   = false;
+	}
+	return *this;
+}
+
+void FDbCursor::Close()
+{
+	if (Statement)
+	{
+		Statement->Reset();
+		Statement = nullptr;
+	}
+	bHasRow = false;
+}
+
+bool FDbCursor::Next()
+{
+	bStarted = true;
+	bHasRow  = Statement && Statement->Step() == ESQLitePreparedStatementStepResult::Row;
+	return bHasRow;
+}
+
+FDbCursor::FIterator FDbCursor::begin()
+{
+	if (!bStarted)
+		Next();
+	return FIterator{this};
+}
+
+int32 FDbCursor::NumColumns() const
+{
+	return Statement ? Statement->GetColumnNames().Num() : 0;
+}
+
+const FString& FDbCursor::GetColumnName(const int32 Column) const
+{
+	static const FString NoName;
+	if (!Statement || !Statement->GetColumnNames().IsValidIndex(Column))
+		return NoName;
+	return Statement->GetColumnNames()[Column];
+}
+
+int32 FDbCursor::GetColumnIndex(const FString& ColumnName) const
+{
+	return Statement ? Statement->GetColumnIndexByName(*ColumnName) : INDEX_NONE;
+}
+
+EDbValueType FDbCursor::GetType(const int32 Column) const
+{
+	ESQLiteColumnType ColType = ESQLiteColumnType::Null;
+	if (!bHasRow || !Statement->GetColumnTypeByIndex(Column, ColType))
+		return EDbValueType::Null;
+
+	switch (ColType)
+	{
+	case ESQLiteColumnType::Integer:
+		return EDbValueType::Integer;
+	case ESQLiteColumnType::Float:
+		return EDbValueType::Float;
+	case ESQLiteColumnType::String:
+		return EDbValueType::String;
+	case ESQLiteColumnType::Blob:
+		return EDbValueType::Blob;
+	default:
+		return EDbValueType::Null;
+	}
+}
+
+int64 FDbCursor::GetInteger(const int32 Column) const
+{
+	int64 Value = 0;
+	GetValue(Column, Value);
+	return Value;
+}
+
+double FDbCursor::GetFloat(const int32 Column) const
+{
+	double Value = 0.0;
+	GetValue(Column, Value);
+	return Value;
+}
+
+FString FDbCursor::GetString(const int32 Column) const
+{
+	FString Value;
+	GetValue(Column, Value);
+	return Value;
+}
+
+TArray<uint8> FDbCursor::GetBlob(const int32 Column) const
+{
+	TArray<uint8> Value;
+	GetValue(Column, Value);
+	return Value;
+}
+
+FUtf8StringView FDbCursor::GetStringView(const int32 Column) const
+{
+	FUtf8StringView Value;
+	if (bHasRow)
+		Statement->GetColumnUtf8ViewByIndex(Column, Value);
+	return Value;
+}
+
+TArrayView<const uint8> FDbCursor::GetBlobView(const int32 Column) const
+{
+	TArrayView<const uint8> Value;
+	if (bHasRow)
+		Statement->GetColumnBlobViewByIndex(Column, Value);
+	return Value;
+}
+
+FQueryResultField FDbCursor::GetField(const int32 Column) const
+{
+	/* Read the value as the type sqlite holds it as, as ExecuteSelect always has. */
+	FQueryResultField Field;
+
+	switch (GetType(Column))
+	{
+	case EDbValueType::Integer:
+		Field = FQueryResultField(GetInteger(Column));
+		break;
+	case EDbValueType::Float:
+		Field = FQueryResultField(GetFloat(Column));
+		break;
+	case EDbValueType::String:
+		Field = FQueryResultField(GetString(Column));
+		break;
+	case EDbValueType::Blob:
+		Field = FQueryResultField(GetBlob(Column));
+		break;
+	default:
+		break;
+	}
+
+	Field.ColName = GetColumnName(Column);
+	return Field;
+}
+
+FQueryResultRow FDbCursor::GetRow() const
+{
+	FQueryResultRow Row;
+
+	const int32 NumberOfColumns = NumColumns();
+	Row.Fields.Reserve(NumberOfColumns);
+	for (int32 ColumnIdx = 0; ColumnIdx < NumberOfColumns; ColumnIdx++)
+		Row.Fields.Add(GetField(ColumnIdx));
+
+	return Row;
+}
@@ -0,0 +1,161 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "DbHydrationPlan.h"
+#include "UObject/TextProperty.h"
+#include "CustomLogging.h"
+#include "DbStringSerializer.h"
+
+namespace DbHydrationPlanImpl
+{
+	/* Cache key: the type being filled, and the names of the statement's columns, in order. */
+	struct FPlanKey
+	{
+		TWeakObjectPtr<const UStruct> Type;
+		FString                       ColumnSignature;
+
+		bool operator==(const FPlanKey& Other) const
+		{
+			return Type == Other.Type && ColumnSignature == Other.ColumnSignature;
+		}
+
+		friend uint32 GetTypeHash(const FPlanKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Type), GetTypeHash(Key.ColumnSignature));
+		}
+	};
+
+	FCriticalSection                                   PlansLock;
+	TMap<FPlanKey, TSharedRef<const FDbHydrationPlan>> Plans;
+
+	/* Values the statement can read directly (integers, floats, strings, names and text),
+	 * with SQLite's own conversions, so a NULL reads as 0 or an empty string. */
+	template <typename T>
+	void SetValue(const FSQLitePreparedStatement& Statement, const int32 ColumnIndex, const FProperty* Property,
+	              void* ValuePtr)
+	{
+		Statement.GetColumnValueByIndex(ColumnIndex, *static_cast<T*>(ValuePtr));
+	}
+
+	/* Bools may be bitfields, so must be set through their property. */
+	void SetBool(const FSQLitePreparedStatement& Statement, const int32 ColumnIndex, const FProperty* Property,
+	             void* ValuePtr)
+	{
+		int64 Value = 0;
+		Statement.GetColumnValueByIndex(ColumnIndex, Value);
+		static_cast<const FBoolProperty*>(Property)->SetPropertyValue(ValuePtr, Value != 0);
+	}
+
+	/* Enum classes may have any size of underlying type. */
+	void SetEnum(const FSQLitePreparedStatement& Statement, const int32 ColumnIndex, const FProperty* Property,
+	             void* ValuePtr)
+	{
+		int64 Value = 0;
+		Statement.GetColumnValueByIndex(ColumnIndex, Value);
+		static_cast<const FEnumProperty*>(Property)->GetUnderlyingProperty()->SetIntPropertyValue(ValuePtr, Value);
+	}
+
+	/* Structs inheriting from FDbStringSerializer parse their values out of a single string column. */
+	void SetFromDbString(const FSQLitePreparedStatement& Statement, const int32 ColumnIndex, const FProperty* Property,
+	                     void* ValuePtr)
+	{
+		FString Value;
+		Statement.GetColumnValueByIndex(ColumnIndex, Value);
+		static_cast<FDbStringSerializer*>(ValuePtr)->FromDbString(MoveTemp(Value));
+	}
+
+	/* Chooses how to set a property, or returns nullptr if its type is unsupported. */
+	FDbHydrationPlan::FSetter FindSetter(const FProperty* Property)
+	{
+		switch (static_cast<EClassCastFlags>(Property->GetClass()->GetId()))
+		{
+		case CASTCLASS_FStructProperty:
+			{
+				/* See FDbStringSerializer. Any other struct can't be filled from a column. */
+				const UScriptStruct* Struct = static_cast<const FStructProperty*>(Property)->Struct;
+				if (Struct && Struct->IsChildOf(FDbStringSerializer::StaticStruct()))
+					return &SetFromDbString;
+				LOG_GDB(Error, TEXT("Attempt to read a CASTCLASS_FStructProperty from the database, "
+					        "but target UStruct does not inherit from FDbStringSerializer."));
+				return nullptr;
+			}
+		case CASTCLASS_FBoolProperty:   return &SetBool;
+		case CASTCLASS_FByteProperty:   return &SetValue<uint8>;
+		case CASTCLASS_FInt8Property:   return &SetValue<int8>;
+		case CASTCLASS_FInt16Property:  return &SetValue<int16>;
+		case CASTCLASS_FUInt16Property: return &SetValue<uint16>;
+		case CASTCLASS_FIntProperty:    return &SetValue<int32>;
+		case CASTCLASS_FUInt32Property: return &SetValue<uint32>;
+		case CASTCLASS_FInt64Property:  return &SetValue<int64>;
+		case CASTCLASS_FUInt64Property: return &SetValue<uint64>;
+		case CASTCLASS_FFloatProperty:  return &SetValue<float>;
+		case CASTCLASS_FDoubleProperty: return &SetValue<double>;
+		case CASTCLASS_FEnumProperty:   return &SetEnum;
+		case CASTCLASS_FStrProperty:    return &SetValue<FString>;
+		case CASTCLASS_FNameProperty:   return &SetValue<FName>;
+		case CASTCLASS_FTextProperty:   return &SetValue<FText>;
+
+		default: // Currently unsupported property types
+			LOG_GDB(Error, TEXT("Attempt to read an unsupported Property Type (CASTCLASS) from the database"));
+			return nullptr;
+		}
+	}
+}
+
+FThreadSafeCounter FDbHydrationPlan::CacheGeneration;
+
+TSharedRef<const FDbHydrationPlan> FDbHydrationPlan::Get(const UStruct* Type, const FSQLitePreparedStatement& Statement)
+{
+	using namespace DbHydrationPlanImpl;
+
+	FPlanKey Key{Type, FString::Join(Statement.GetColumnNames(), TEXT("\n"))};
+
+	FScopeLock Lock(&PlansLock);
+	if (const TSharedRef<const FDbHydrationPlan>* Plan = Plans.Find(Key))
+		return *Plan;
+
+	/* Plans are only added here, so this is when to evict those for types that have since been destroyed. */
+	for (auto It = Plans.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().Type.IsValid())
+			It.RemoveCurrent();
+	}
+
+	return Plans.Add(MoveTemp(Key), Build(Type, Statement));
+}
+
+void FDbHydrationPlan::FlushCache()
+{
+	using namespace DbHydrationPlanImpl;
+
+	FScopeLock Lock(&PlansLock);
+	Plans.Empty();
+	CacheGeneration.Increment();
+}
+
+TSharedRef<const FDbHydrationPlan> FDbHydrationPlan::Build(const UStruct* Type, const FSQLitePreparedStatement& Statement)
+{
+	TSharedRef<FDbHydrationPlan> Plan = MakeShared<FDbHydrationPlan>();
+	Plan->Generation = CacheGeneration.GetValue();
+
+	for (TFieldIterator<FProperty> Prop(Type); Prop; ++Prop)
+	{
+		const FProperty* Property = *Prop;
+		if (!Property->HasAnyPropertyFlags(CPF_SaveGame))
+			continue;
+
+		/* Column names are matched to property names case-insensitively. */
+		const int32 ColIdx = Statement.GetColumnIndexByName(*Property->GetAuthoredName());
+		if (ColIdx == INDEX_NONE)
+			continue;
+
+		const FSetter Setter = DbHydrationPlanImpl::FindSetter(Property);
+		if (!Setter)
+		{
+			checkNoEntry();
+			continue;
+		}
+		Plan->Bindings.Add({Property, ColIdx, Setter});
+	}
+
+	return Plan;
+}
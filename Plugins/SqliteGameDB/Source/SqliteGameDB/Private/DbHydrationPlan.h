@@ -0,0 +1,61 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "SQLitePreparedStatement.h"
+
+/* How the columns of a statement's result-set map onto the SaveGame properties of a class (or struct).
+ * Matching property names to column names, and choosing how to set each property, is done once
+ * when the plan is built; each row is then applied by column index, with no name lookups.
+ * Plans are cached by type and column names, so statements returning the same columns share them; a statement only
+ * looks a plan up again once SQLite has re-prepared it (see FSQLitePreparedStatement::GetReprepareCount).
+ * They hold raw property pointers, so every cached plan is dropped when classes are reinstanced or reloaded. */
+struct FDbHydrationPlan
+{
+	/* Reads one column of the current row straight into a property's value. */
+	using FSetter = void (*)(const FSQLitePreparedStatement& Statement, const int32 ColumnIndex,
+	                         const FProperty* Property, void* ValuePtr);
+
+	struct FBinding
+	{
+		const FProperty* Property    = nullptr;
+		int32            ColumnIndex = INDEX_NONE;
+		FSetter          Setter      = nullptr;
+	};
+
+	/* One binding per SaveGame property with a matching column (in property order). */
+	TArray<FBinding> Bindings;
+
+	/* The cache generation the plan was built in; it is stale once the cache has been flushed since. */
+	int32 Generation = 0;
+
+	/* Has the cache not been flushed since the plan was built? */
+	bool IsCurrent() const
+	{
+		return Generation == CacheGeneration.GetValue();
+	}
+
+	/* Sets the bound properties of an object (or struct) from the statement's current row. */
+	void Apply(const FSQLitePreparedStatement& Statement, void* Container) const
+	{
+		for (const FBinding& Binding : Bindings)
+			Binding.Setter(Statement, Binding.ColumnIndex, Binding.Property,
+			               Binding.Property->ContainerPtrToValuePtr<void>(Container));
+	}
+
+	/* Gets the plan for filling the given type from the statement's current columns, building it on first use.
+	 * SQLite re-prepares a statement after a schema change, which can change its columns,
+	 * so this is only reliable once the statement has been stepped. */
+	static TSharedRef<const FDbHydrationPlan> Get(const UStruct* Type, const FSQLitePreparedStatement& Statement);
+
+	/* Drops every cached plan, including those held by statements, as their properties may no longer exist.
+	 * Bound to the delegates for reinstanced and reloaded classes by the module. */
+	static void FlushCache();
+
+private:
+	/* Bumped by FlushCache, to make plans held outside the shared cache stale. */
+	static FThreadSafeCounter CacheGeneration;
+
+	static TSharedRef<const FDbHydrationPlan> Build(const UStruct* Type, const FSQLitePreparedStatement& Statement);
+};
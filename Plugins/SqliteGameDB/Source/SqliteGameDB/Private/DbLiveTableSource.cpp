@@ -0,0 +1,356 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "DbLiveTableSource.h"
+#include "DbStringSerializer.h"
+#include "EngineUtils.h"
+
+#pragma region Live Table Source
+
+TArray<FSQLiteVirtualTableColumn> FDbLiveTableSource::GetColumns() const
+{
+	TArray<FSQLiteVirtualTableColumn> TableColumns;
+	for (const FColumn& Column : Columns)
+		TableColumns.Add({Column.Name, Column.Type});
+	return TableColumns;
+}
+
+FDbLiveTableSource::FKeyValue FDbLiveTableSource::FKeyValue::FromArgs(const FSQLiteFunctionArgs& InKey)
+{
+	FKeyValue Key;
+	InKey.GetValue(0, Key.IntVal);
+	InKey.GetValue(0, Key.DblVal);
+	InKey.GetValue(0, Key.StrVal);
+	return Key;
+}
+
+bool FDbLiveTableSource::FColumn::MatchesKey(const void* Row, const FKeyValue& Key) const
+{
+	FKeyValue RowKey;
+	GetKey(Row, RowKey);
+
+	switch (KeyCompare)
+	{
+	case EKeyCompare::Integer: return RowKey.IntVal == Key.IntVal;
+	case EKeyCompare::Real: return RowKey.DblVal == Key.DblVal;
+	case EKeyCompare::Text: return RowKey.StrVal.Equals(Key.StrVal, ESearchCase::CaseSensitive);
+	case EKeyCompare::TextIgnoreCase: return RowKey.StrVal.Equals(Key.StrVal, ESearchCase::IgnoreCase);
+	}
+	return false;
+}
+
+uint32 FDbLiveTableSource::FColumn::HashKey(const FKeyValue& Key) const
+{
+	switch (KeyCompare)
+	{
+	case EKeyCompare::Integer: return GetTypeHash(Key.IntVal);
+	/* -0.0 equals 0.0, so must hash the same. */
+	case EKeyCompare::Real: return GetTypeHash(Key.DblVal == 0.0 ? 0.0 : Key.DblVal);
+	/* FString hashes ignore case, so serve both kinds of text. */
+	case EKeyCompare::Text:
+	case EKeyCompare::TextIgnoreCase: return GetTypeHash(Key.StrVal);
+	}
+	return 0;
+}
+
+void FDbLiveTableSource::FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const
+{
+	const FKeyValue Key = FKeyValue::FromArgs(InKey);
+
+	/* Compare only the key of each row, rather than have SQLite read every column of every row. */
+	TArray<const void*> AllRows;
+	GetRows(AllRows);
+
+	const FColumn& KeyColumn = Columns[KeyColumnIndex];
+	for (const void* Row : AllRows)
+	{
+		if (KeyColumn.MatchesKey(Row, Key))
+			OutRows.Add(Row);
+	}
+}
+
+TUniquePtr<ISQLiteVirtualTableKeyIndex> FDbLiveTableSource::CreateKeyIndex() const
+{
+	return MakeUnique<FKeyIndex>(*this);
+}
+
+FDbLiveTableSource::FKeyIndex::FKeyIndex(const FDbLiveTableSource& InSource)
+	: KeyColumn(InSource.Columns[InSource.KeyColumnIndex])
+{
+	TArray<const void*> AllRows;
+	InSource.GetRows(AllRows);
+
+	FKeyValue RowKey;
+	for (const void* Row : AllRows)
+	{
+		KeyColumn.GetKey(Row, RowKey);
+		RowsByKeyHash.Add(KeyColumn.HashKey(RowKey), Row);
+	}
+}
+
+void FDbLiveTableSource::FKeyIndex::FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const
+{
+	/* Rows whose key only shares the hash are returned too, as SQLite still checks the rows returned. */
+	RowsByKeyHash.MultiFind(KeyColumn.HashKey(FKeyValue::FromArgs(InKey)), OutRows, true);
+}
+
+void FDbLiveTableSource::GetColumnValue(const void* InRow, const int32 InColumnIndex,
+                                        FSQLiteFunctionResult& OutResult) const
+{
+	if (Columns.IsValidIndex(InColumnIndex) && IsRowValid(InRow))
+		Columns[InColumnIndex].GetValue(InRow, OutResult);
+}
+
+bool FDbLiveTableSource::AddPropertyColumn(const FProperty* Property)
+{
+	FColumn Column;
+	Column.Name = Property->GetAuthoredName();
+
+	if (const FBoolProperty* PropBool = CastField<FBoolProperty>(Property))
+	{
+		Column.Type     = TEXT("INTEGER");
+		Column.GetValue = [PropBool](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(PropBool->GetPropertyValue_InContainer(Row));
+		};
+		Column.GetKey = [PropBool](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.IntVal = PropBool->GetPropertyValue_InContainer(Row) ? 1 : 0;
+		};
+	}
+	else if (const FNumericProperty* PropNumeric = CastField<FNumericProperty>(Property))
+	{
+		if (PropNumeric->IsFloatingPoint())
+		{
+			Column.Type     = TEXT("REAL");
+			Column.GetValue = [PropNumeric](const void* Row, FSQLiteFunctionResult& OutResult)
+			{
+				OutResult.SetValue(PropNumeric->GetFloatingPointPropertyValue(PropNumeric->ContainerPtrToValuePtr<void>(Row)));
+			};
+			Column.GetKey = [PropNumeric](const void* Row, FKeyValue& OutKey)
+			{
+				OutKey.DblVal = PropNumeric->GetFloatingPointPropertyValue(PropNumeric->ContainerPtrToValuePtr<void>(Row));
+			};
+			Column.KeyCompare = EKeyCompare::Real;
+		}
+		else
+		{
+			Column.Type     = TEXT("INTEGER");
+			Column.GetValue = [PropNumeric](const void* Row, FSQLiteFunctionResult& OutResult)
+			{
+				OutResult.SetValue(PropNumeric->GetSignedIntPropertyValue(PropNumeric->ContainerPtrToValuePtr<void>(Row)));
+			};
+			Column.GetKey = [PropNumeric](const void* Row, FKeyValue& OutKey)
+			{
+				OutKey.IntVal = PropNumeric->GetSignedIntPropertyValue(PropNumeric->ContainerPtrToValuePtr<void>(Row));
+			};
+		}
+	}
+	else if (const FEnumProperty* PropEnum = CastField<FEnumProperty>(Property))
+	{
+		/* Enums are stored as their underlying value, as elsewhere in the database. */
+		const FNumericProperty* PropUnderlying = PropEnum->GetUnderlyingProperty();
+		Column.Type     = TEXT("INTEGER");
+		Column.GetValue = [PropEnum, PropUnderlying](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(PropUnderlying->GetSignedIntPropertyValue(PropEnum->ContainerPtrToValuePtr<void>(Row)));
+		};
+		Column.GetKey = [PropEnum, PropUnderlying](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.IntVal = PropUnderlying->GetSignedIntPropertyValue(PropEnum->ContainerPtrToValuePtr<void>(Row));
+		};
+	}
+	else if (const FStrProperty* PropStr = CastField<FStrProperty>(Property))
+	{
+		Column.Type     = TEXT("TEXT");
+		Column.GetValue = [PropStr](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(PropStr->GetPropertyValue_InContainer(Row));
+		};
+		Column.GetKey = [PropStr](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.StrVal = PropStr->GetPropertyValue_InContainer(Row);
+		};
+		Column.KeyCompare = EKeyCompare::Text;
+	}
+	else if (const FNameProperty* PropName = CastField<FNameProperty>(Property))
+	{
+		/* FName comparisons ignore case, so may match more rows than SQLite's, which is fine for a key. */
+		Column.Type     = TEXT("TEXT");
+		Column.GetValue = [PropName](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(PropName->GetPropertyValue_InContainer(Row).ToString());
+		};
+		Column.GetKey = [PropName](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.StrVal = PropName->GetPropertyValue_InContainer(Row).ToString();
+		};
+		Column.KeyCompare = EKeyCompare::TextIgnoreCase;
+	}
+	else if (const FTextProperty* PropText = CastField<FTextProperty>(Property))
+	{
+		Column.Type     = TEXT("TEXT");
+		Column.GetValue = [PropText](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(PropText->GetPropertyValue_InContainer(Row).ToString());
+		};
+		Column.GetKey = [PropText](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.StrVal = PropText->GetPropertyValue_InContainer(Row).ToString();
+		};
+		Column.KeyCompare = EKeyCompare::Text;
+	}
+	else if (const FStructProperty* PropStruct = CastField<FStructProperty>(Property);
+		PropStruct && PropStruct->Struct->IsChildOf(FDbStringSerializer::StaticStruct()))
+	{
+		/* Serializable structs are exposed in the same form they are saved in. */
+		Column.Type     = TEXT("TEXT");
+		Column.GetValue = [PropStruct](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(const_cast<FDbStringSerializer*>(PropStruct->ContainerPtrToValuePtr<FDbStringSerializer>(Row))->ToDbString());
+		};
+		Column.GetKey = [PropStruct](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.StrVal = const_cast<FDbStringSerializer*>(PropStruct->ContainerPtrToValuePtr<FDbStringSerializer>(Row))->ToDbString();
+		};
+		Column.KeyCompare = EKeyCompare::Text;
+	}
+	else
+	{
+		return false;
+	}
+
+	Columns.Add(MoveTemp(Column));
+	return true;
+}
+
+bool FDbLiveTableSource::SetKeyColumn(const FString& ColumnName)
+{
+	KeyColumnIndex = Columns.IndexOfByPredicate([&ColumnName](const FColumn& Column)
+	{
+		return Column.Name.Equals(ColumnName, ESearchCase::IgnoreCase);
+	});
+	return KeyColumnIndex != INDEX_NONE;
+}
+
+#pragma endregion
+
+#pragma region Struct Array Table Source
+
+FDbStructArrayTableSource::FDbStructArrayTableSource(const UScriptStruct* InRowStruct, const FScriptArray* InRows,
+                                                     const FName KeyPropertyName)
+	: Rows(InRows)
+	, RowSize(InRowStruct->GetStructureSize())
+{
+	for (TFieldIterator<FProperty> Prop(InRowStruct); Prop; ++Prop)
+		AddPropertyColumn(*Prop);
+
+	if (!KeyPropertyName.IsNone())
+		SetKeyColumn(KeyPropertyName.ToString());
+}
+
+void FDbStructArrayTableSource::GetRows(TArray<const void*>& OutRows) const
+{
+	const uint8* RowData = static_cast<const uint8*>(Rows->GetData());
+	for (int32 RowIdx = 0; RowIdx < Rows->Num(); RowIdx++)
+		OutRows.Add(RowData + RowIdx * RowSize);
+}
+
+#pragma endregion
+
+#pragma region Actor Table Source
+
+FDbActorTableSource::FDbActorTableSource(UWorld* InWorld, const TSubclassOf<AActor> InActorClass,
+                                         const FName KeyPropertyName)
+	: World(InWorld)
+	, ActorClass(InActorClass)
+{
+	/* The actor's name, and the location columns in the form the spatial statements expect. */
+	Columns.Add({
+		TEXT("ActorName"), TEXT("TEXT"),
+		[](const void* Row, FSQLiteFunctionResult& OutResult)
+		{
+			OutResult.SetValue(static_cast<const AActor*>(Row)->GetName());
+		},
+		[](const void* Row, FKeyValue& OutKey)
+		{
+			OutKey.StrVal = static_cast<const AActor*>(Row)->GetName();
+		},
+		EKeyCompare::TextIgnoreCase
+	});
+
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Columns.Add({
+			FString::Printf(TEXT("Location%c"), TEXT("XYZ")[Axis]), TEXT("REAL"),
+			[Axis](const void* Row, FSQLiteFunctionResult& OutResult)
+			{
+				OutResult.SetValue(static_cast<const AActor*>(Row)->GetActorLocation()[Axis]);
+			},
+			[Axis](const void* Row, FKeyValue& OutKey)
+			{
+				OutKey.DblVal = static_cast<const AActor*>(Row)->GetActorLocation()[Axis];
+			},
+			EKeyCompare::Real
+		});
+	}
+
+	for (TFieldIterator<FProperty> Prop(InActorClass); Prop; ++Prop)
+	{
+		if (Prop->HasAnyPropertyFlags(CPF_SaveGame))
+			AddPropertyColumn(*Prop);
+	}
+
+	SetKeyColumn(KeyPropertyName.IsNone() ? TEXT("ActorName") : KeyPropertyName.ToString());
+}
+
+bool FDbActorTableSource::CanRead(FString& OutError) const
+{
+	/* Failing the statement is safer than crashing whichever thread happened to step it. */
+	if (!IsInGameThread())
+	{
+		OutError = TEXT("Actor tables can only be queried from the game thread.");
+		return false;
+	}
+	return true;
+}
+
+void FDbActorTableSource::GetRows(TArray<const void*>& OutRows) const
+{
+	/* Forget the actors destroyed since the table was last read, so the map only holds live actors. */
+	for (auto It = RowActors.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+			It.RemoveCurrent();
+	}
+
+	UWorld* ActorWorld = World.Get();
+	if (!ActorWorld)
+		return;
+
+	for (TActorIterator<AActor> It(ActorWorld, ActorClass); It; ++It)
+	{
+		const AActor* Actor = *It;
+		RowActors.Add(Actor, Actor);
+		OutRows.Add(Actor);
+	}
+}
+
+void FDbActorTableSource::GetColumnValue(const void* InRow, const int32 InColumnIndex,
+                                         FSQLiteFunctionResult& OutResult) const
+{
+	/* Rows are only found on the game thread (see CanRead), but a statement could still be stepped on from another one. */
+	if (!IsInGameThread())
+	{
+		OutResult.SetError(TEXT("Actor tables can only be queried from the game thread."));
+		return;
+	}
+	FDbLiveTableSource::GetColumnValue(InRow, InColumnIndex, OutResult);
+}
+
+bool FDbActorTableSource::IsRowValid(const void* Row) const
+{
+	const TWeakObjectPtr<const AActor>* Actor = RowActors.Find(Row);
+	return Actor && Actor->IsValid();
+}
+
+#pragma endregion
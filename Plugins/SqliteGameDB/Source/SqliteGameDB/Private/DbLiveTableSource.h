@@ -0,0 +1,125 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SQLiteVirtualTable.h"
+#include "GameFramework/Actor.h"
+
+/* Base of the live table sources, which expose in-memory game data to SQL as read-only tables
+ * (see UDbBase::RegisterStructArrayTable and UDbBase::RegisterActorTable).
+ * Each column reads its value straight from the row, so nothing is copied into the database. */
+class FDbLiveTableSource : public ISQLiteVirtualTableSource
+{
+public:
+	virtual TArray<FSQLiteVirtualTableColumn> GetColumns() const override;
+	virtual int32 GetKeyColumnIndex() const override { return KeyColumnIndex; }
+	virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const override;
+	virtual TUniquePtr<ISQLiteVirtualTableKeyIndex> CreateKeyIndex() const override;
+	virtual void GetColumnValue(const void* InRow, const int32 InColumnIndex,
+	                            FSQLiteFunctionResult& OutResult) const override;
+
+protected:
+	/* The value of a key constraint, converted once up front, to be compared against every row. */
+	struct FKeyValue
+	{
+		int64   IntVal = 0;
+		double  DblVal = 0.0;
+		FString StrVal;
+
+		static FKeyValue FromArgs(const FSQLiteFunctionArgs& InKey);
+	};
+
+	/* Which field of FKeyValue a column's keys are compared by. */
+	enum class EKeyCompare : uint8
+	{
+		Integer,
+		Real,
+		Text,
+		TextIgnoreCase
+	};
+
+	struct FColumn
+	{
+		FString Name;
+		FString Type;
+
+		/* Sets the column's value for a row. */
+		TFunction<void(const void* Row, FSQLiteFunctionResult& OutResult)> GetValue;
+
+		/* Reads the row's value into the field of the key that KeyCompare compares. */
+		TFunction<void(const void* Row, FKeyValue& OutKey)> GetKey;
+		EKeyCompare KeyCompare = EKeyCompare::Integer;
+
+		/* Does the row's value equal the key? (It may say yes to more rows than truly match,
+		 * as SQLite still checks the rows returned, but must never say no to a matching row.) */
+		bool MatchesKey(const void* Row, const FKeyValue& Key) const;
+
+		/* Hashes a key, so that keys MatchesKey considers equal have equal hashes. */
+		uint32 HashKey(const FKeyValue& Key) const;
+	};
+
+	/* The rows read when the index was created, by the hash of their key. */
+	class FKeyIndex : public ISQLiteVirtualTableKeyIndex
+	{
+	public:
+		explicit FKeyIndex(const FDbLiveTableSource& InSource);
+
+		virtual void FindRows(const FSQLiteFunctionArgs& InKey, TArray<const void*>& OutRows) const override;
+
+	private:
+		const FColumn&                 KeyColumn;
+		TMultiMap<uint32, const void*> RowsByKeyHash;
+	};
+
+	/* Adds a column reading the given property of each row, whose data must begin at the row pointer.
+	 * Returns false (adding no column) if the property's type has no SQL equivalent. */
+	bool AddPropertyColumn(const FProperty* Property);
+
+	/* Makes the column with the given name the key, returning false if there is no such column. */
+	bool SetKeyColumn(const FString& ColumnName);
+
+	/* Can the row still be read? Rows that can't are read as NULL in every column. */
+	virtual bool IsRowValid(const void* Row) const { return true; }
+
+	TArray<FColumn> Columns;
+	int32           KeyColumnIndex = INDEX_NONE;
+};
+
+/* Exposes the elements of a TArray of USTRUCTs as rows, with a column per reflected property. */
+class FDbStructArrayTableSource : public FDbLiveTableSource
+{
+public:
+	FDbStructArrayTableSource(const UScriptStruct* InRowStruct, const FScriptArray* InRows, const FName KeyPropertyName);
+
+	virtual void GetRows(TArray<const void*>& OutRows) const override;
+
+private:
+	const FScriptArray* Rows;
+	int32               RowSize;
+};
+
+/* Exposes the actors of a class in a world as rows.
+ * The columns are ActorName (the default key), LocationX, LocationY and LocationZ,
+ * followed by a column per property of the class flagged with the SaveGame specifier.
+ * NOTE: Actors can only be read on the game thread, so a statement reading the table from any other thread fails. */
+class FDbActorTableSource : public FDbLiveTableSource
+{
+public:
+	FDbActorTableSource(UWorld* InWorld, const TSubclassOf<AActor> InActorClass, const FName KeyPropertyName);
+
+	virtual bool CanRead(FString& OutError) const override;
+	virtual void GetRows(TArray<const void*>& OutRows) const override;
+	virtual void GetColumnValue(const void* InRow, const int32 InColumnIndex,
+	                            FSQLiteFunctionResult& OutResult) const override;
+
+protected:
+	virtual bool IsRowValid(const void* Row) const override;
+
+private:
+	TWeakObjectPtr<UWorld> World;
+	TSubclassOf<AActor>    ActorClass;
+
+	/* The actor behind each row handed out by GetRows, so a row whose actor has been destroyed
+	 * while a statement was still reading it is never dereferenced. */
+	mutable TMap<const void*, TWeakObjectPtr<const AActor>> RowActors;
+};
@@ -4,6 +4,7 @@
 #include "UObject/TextProperty.h"
 #include "CustomLogging.h"
 #include "DbStringSerializer.h"
+#include "DbHydrationPlan.h"
 
 void UDbStatement::Initialize(FSQLiteDatabase* InDatabase, const FString SqlQueryText)
 {
@@ -12,6 +13,8 @@ void UDbStatement::Initialize(FSQLiteDatabase* InDatabase, const FString SqlQuer
 	PreparedStatement = new FSQLitePreparedStatement();
 	bool CreateOk     = PreparedStatement->Create(*SqliteDb, *SqlQueryText, ESQLitePreparedStatementFlags::Persistent);
 	check(CreateOk);
+	HydrationPlans.Reset();
+	HydrationPlansReprepareCount = PreparedStatement->GetReprepareCount();
 }
 
 void UDbStatement::InitStatement(UDbBase* DbConnection, const FString SqlQueryText)
@@ -122,11 +125,59 @@ bool UDbStatement::SetBindingValue(const FString InBindingName, const FGuid& InV
 	return PreparedStatement->SetBindingValueByName(*InBindingName, InValue);
 }
 
+bool UDbStatement::SetBindingArray(const FString InBindingName, TConstArrayView<int64> InValues)
+{
+	return PreparedStatement->SetBindingArrayByName(*InBindingName, InValues);
+}
+
+bool UDbStatement::SetBindingArray(const FString InBindingName, TConstArrayView<FString> InValues)
+{
+	return PreparedStatement->SetBindingArrayByName(*InBindingName, InValues);
+}
+
+bool UDbStatement::SetBindingArray(const FString InBindingName, TConstArrayView<FGuid> InValues)
+{
+	return PreparedStatement->SetBindingArrayByName(*InBindingName, InValues);
+}
+
 bool UDbStatement::SetBindingValueToNull(const FString InBindingName)
 {
 	return PreparedStatement->SetBindingValueByName(*InBindingName);
 }
 
+FDbParamHandle UDbStatement::GetParamHandle(const FString& InBindingName) const
+{
+	FDbParamHandle Param;
+	Param.Index = PreparedStatement->GetBindingIndexByName(*InBindingName);
+	return Param;
+}
+
+bool UDbStatement::SetBindingValue(const FDbParamHandle InParam, const void* InBlobData,
+                                   const int32          InBlobDataSizeBytes, const bool bCopy)
+{
+	return PreparedStatement->SetBindingValueByIndex(InParam.Index, InBlobData, InBlobDataSizeBytes, bCopy);
+}
+
+bool UDbStatement::SetBindingValueToNull(const FDbParamHandle InParam)
+{
+	return PreparedStatement->SetBindingValueByIndex(InParam.Index);
+}
+
+bool UDbStatement::SetBindingArray(const FDbParamHandle InParam, TConstArrayView<int64> InValues)
+{
+	return PreparedStatement->SetBindingArrayByIndex(InParam.Index, InValues);
+}
+
+bool UDbStatement::SetBindingArray(const FDbParamHandle InParam, TConstArrayView<FString> InValues)
+{
+	return PreparedStatement->SetBindingArrayByIndex(InParam.Index, InValues);
+}
+
+bool UDbStatement::SetBindingArray(const FDbParamHandle InParam, TConstArrayView<FGuid> InValues)
+{
+	return PreparedStatement->SetBindingArrayByIndex(InParam.Index, InValues);
+}
+
 void UDbStatement::SetBoolParameterValue(const FString InBindingName, const bool InValue)
 {
 	SetBindingValue(InBindingName, (int32)InValue);
@@ -177,100 +228,317 @@ bool UDbStatement::ExecuteAction()
 	return result;
 }
 
+bool UDbStatement::ExecuteActionBatch(const TArray<FDbParamColumn>& ParamColumns)
+{
+	if (!PreparedStatement || !PreparedStatement->IsValid())
+	{
+		LOG_GDB(Error, TEXT("INVALID PREPARED STATEMENT"));
+		return false;
+	}
+
+	/* Resolve every parameter up front, so the per-row loop only binds by index. */
+	const int32   NumRows = ParamColumns.Num() > 0 ? ParamColumns[0].Values.Num() : 0;
+	TArray<int32> BindingIndices;
+	BindingIndices.Reserve(ParamColumns.Num());
+	for (const FDbParamColumn& Column : ParamColumns)
+	{
+		if (Column.Values.Num() != NumRows)
+		{
+			LOG_GDB(Error, *FString::Printf(TEXT("Batch parameter %s has %d values, expected %d"),
+			                                *Column.BindingName, Column.Values.Num(), NumRows));
+			return false;
+		}
+
+		const int32 Idx = PreparedStatement->GetBindingIndexByName(*Column.BindingName);
+		if (Idx == 0)
+		{
+			LOG_GDB(Error, *FString::Printf(TEXT("Batch parameter %s not found in query"), *Column.BindingName));
+			return false;
+		}
+		BindingIndices.Add(Idx);
+	}
+
+	PreparedStatement->Reset();
+
+	/* The batch is rolled back on failure, which replaces the DB's last error, so ask for the error that failed it instead. */
+	FString BatchError;
+	const int64 NumExecuted = PreparedStatement->ExecuteBatch(NumRows, [&](const int64 RowIdx)
+	{
+		bool bBound = true;
+		for (int32 ColIdx = 0; ColIdx < ParamColumns.Num(); ColIdx++)
+		{
+			bBound &= SetBindingValueFromField(BindingIndices[ColIdx], ParamColumns[ColIdx].Values[RowIdx]);
+		}
+		return bBound;
+	}, &BatchError);
+
+	if (NumExecuted == INDEX_NONE)
+	{
+		LOG_GDB(Error, *BatchError);
+		return false;
+	}
+	return true;
+}
+
+bool UDbStatement::SetBindingValueFromField(const int32 InBindingIndex, const FQueryResultField& InValue) const
+{
+	switch (InValue.GetType())
+	{
+	case EDbValueType::Integer:
+		return PreparedStatement->SetBindingValueByIndex(InBindingIndex, InValue.GetInteger());
+	case EDbValueType::Float:
+		return PreparedStatement->SetBindingValueByIndex(InBindingIndex, InValue.GetFloat());
+	case EDbValueType::String:
+		return PreparedStatement->SetBindingValueByIndex(InBindingIndex, InValue.GetString());
+	case EDbValueType::Blob:
+		return PreparedStatement->SetBindingValueByIndex(InBindingIndex, TArrayView<const uint8>(InValue.GetBlob()));
+	default:
+		return PreparedStatement->SetBindingValueByIndex(InBindingIndex);
+	}
+}
+
 FQueryResultField UDbStatement::ExecuteScalar()
 {
-	FQueryResult Results = ExecuteSelect();
-	if (Results.Rows.Num() > 0)
-		return Results.Rows[0].Fields[0];
+	/* Only the first row is stepped to, however many rows the statement would return. */
+	FDbCursor Cursor = OpenCursor();
+	if (Cursor.Next())
+		return Cursor.GetField(0);
 
 	FQueryResultField NoData;
 	return NoData;
 }
 
+int64 UDbStatement::ExecuteScalarInt64(const int64 DefaultValue)
+{
+	FDbCursor Cursor = OpenCursor();
+	if (!Cursor.Next() || Cursor.IsNull(0))
+		return DefaultValue;
+
+	return Cursor.GetInteger(0);
+}
+
+FString UDbStatement::ExecuteScalarString(const FString& DefaultValue)
+{
+	FDbCursor Cursor = OpenCursor();
+	if (!Cursor.Next() || Cursor.IsNull(0))
+		return DefaultValue;
+
+	return Cursor.GetString(0);
+}
+
+bool UDbStatement::ExecuteExists()
+{
+	FDbCursor Cursor = OpenCursor();
+	return Cursor.Next();
+}
+
 FQueryResult UDbStatement::ExecuteSelect()
 {
 	FQueryResult Results;
 
+	for (const FDbCursor& Row : OpenCursor())
+		Results.Rows.Add(Row.GetRow());
+
+	return Results;
+}
+
+FDbCursor UDbStatement::OpenCursor()
+{
+	check(PreparedStatement && PreparedStatement->IsValid());
+
+	return FDbCursor(PreparedStatement);
+}
+
+FColumnarQueryResult UDbStatement::ExecuteSelectColumnar()
+{
+	FColumnarQueryResult Results;
+
 	check(PreparedStatement && PreparedStatement->IsValid());
 
-	TArray<ESQLiteColumnType> ColumnTypes;
-	TArray<FString>           ColumnNames;
-	int32                     NumberOfColumns = 0;
-	bool                      ColumnsParsed   = false;
+	int32 NumberOfColumns = 0;
+	bool  ColumnsParsed   = false;
 
 	while (PreparedStatement->Step() == ESQLitePreparedStatementStepResult::Row)
 	{
-		// create a new row
-		FQueryResultRow newRow;
-
 		if (!ColumnsParsed)
 		{
-			ColumnNames     = PreparedStatement->GetColumnNames();
-			NumberOfColumns = ColumnNames.Num();
+			for (const FString& ColumnName : PreparedStatement->GetColumnNames())
+				Results.AddColumn(ColumnName);
+			NumberOfColumns = Results.Columns.Num();
 			ColumnsParsed   = true;
 		}
 
-		for (int columnIdx = 0; columnIdx < NumberOfColumns; columnIdx++)
+		for (int32 ColumnIdx = 0; ColumnIdx < NumberOfColumns; ColumnIdx++)
 		{
-			/* create a new field, which is NULL by default. */
-			FQueryResultField newField;
-
-			/* get the sqlite datatype for this column. */
-			ESQLiteColumnType ColType;
-			PreparedStatement->GetColumnTypeByIndex(columnIdx, ColType);
+			ESQLiteColumnType ColType = ESQLiteColumnType::Null;
+			PreparedStatement->GetColumnTypeByIndex(ColumnIdx, ColType);
 
+			/* Text and blobs are copied straight from sqlite into the result's packed data. */
 			switch (ColType)
 			{
 			case ESQLiteColumnType::Integer:
 				{
-					int64 IntValue;
-					if (PreparedStatement->GetColumnValueByIndex(columnIdx, IntValue))
-						newField = FQueryResultField(IntValue);
+					int64 IntValue = 0;
+					PreparedStatement->GetColumnValueByIndex(ColumnIdx, IntValue);
+					Results.AddInteger(ColumnIdx, IntValue);
 					break;
 				}
 			case ESQLiteColumnType::Float:
 				{
-					double FloatValue;
-					if (PreparedStatement->GetColumnValueByIndex(columnIdx, FloatValue))
-						newField = FQueryResultField(FloatValue);
+					double FloatValue = 0.0;
+					PreparedStatement->GetColumnValueByIndex(ColumnIdx, FloatValue);
+					Results.AddFloat(ColumnIdx, FloatValue);
 					break;
 				}
 			case ESQLiteColumnType::String:
 				{
-					FString StringValue;
-					if (PreparedStatement->GetColumnValueByIndex(columnIdx, StringValue))
-						newField = FQueryResultField(StringValue);
+					FUtf8StringView StringValue;
+					PreparedStatement->GetColumnUtf8ViewByIndex(ColumnIdx, StringValue);
+					Results.AddString(ColumnIdx, StringValue);
 					break;
 				}
 			case ESQLiteColumnType::Blob:
 				{
-					TArray<uint8> BlobValue;
-					if (PreparedStatement->GetColumnValueByIndex(columnIdx, BlobValue))
-						newField = FQueryResultField(BlobValue);
+					TArrayView<const uint8> BlobValue;
+					PreparedStatement->GetColumnBlobViewByIndex(ColumnIdx, BlobValue);
+					Results.AddBlob(ColumnIdx, BlobValue);
 					break;
 				}
 			default:
-				newField = FQueryResultField();
+				Results.AddNull(ColumnIdx);
 				break;
 			}
-
-			/* What is the name of this column? */
-			newField.ColName = ColumnNames[columnIdx];
-
-			/* Append the column to the current resultset row. */
-			newRow.Fields.Add(newField);
 		}
 
-		/* add the new row to the resultset. */
-		Results.Rows.Add(newRow);
+		Results.NumRows++;
 	}
 
-	FString DbErr = SqliteDb->GetLastError();
 	PreparedStatement->Reset();
 
 	return Results;
 }
 
+#pragma region Spatial Queries
+
+FQueryResult UDbStatement::ExecuteSelectInBox(const FBox& Box)
+{
+	SetSpatialBindings(Box);
+	return ExecuteSelect();
+}
+
+FQueryResult UDbStatement::ExecuteSelectInRadius(const FVector& Center, const double Radius)
+{
+	/* A negative limit returns every row. */
+	SetSpatialBindings(Center, Radius, -1);
+	return ExecuteSelect();
+}
+
+FQueryResult UDbStatement::ExecuteSelectNearest(const FVector& Center, const int32 Count, const double SearchRadius,
+                                                const double MaxSearchRadius)
+{
+	if (Count <= 0)
+		return FQueryResult();
+
+	/* The rows are ordered by exact distance, and every row outside the sphere is further away
+	 * than every row inside it, so once the sphere holds Count rows they are the nearest Count. */
+	double Radius = FMath::Clamp(SearchRadius, UE_KINDA_SMALL_NUMBER, MaxSearchRadius);
+	for (;;)
+	{
+		SetSpatialBindings(Center, Radius, Count);
+		FQueryResult Results = ExecuteSelect();
+
+		if (Results.Rows.Num() >= Count || Radius >= MaxSearchRadius)
+			return Results;
+
+		Radius = FMath::Min(Radius * 2.0, MaxSearchRadius);
+	}
+}
+
+void UDbStatement::SetSpatialBindings(const FBox& Box)
+{
+	SetBindingValue(P_MinX, Box.Min.X);
+	SetBindingValue(P_MinY, Box.Min.Y);
+	SetBindingValue(P_MinZ, Box.Min.Z);
+	SetBindingValue(P_MaxX, Box.Max.X);
+	SetBindingValue(P_MaxY, Box.Max.Y);
+	SetBindingValue(P_MaxZ, Box.Max.Z);
+}
+
+void UDbStatement::SetSpatialBindings(const FVector& Center, const double Radius, const int32 Count)
+{
+	/* The index is searched with the box bounding the sphere, and the rows in the box are then filtered by exact distance. */
+	SetSpatialBindings(FBox(Center - FVector(Radius), Center + FVector(Radius)));
+	SetBindingValue(P_CenterX, Center.X);
+	SetBindingValue(P_CenterY, Center.Y);
+	SetBindingValue(P_CenterZ, Center.Z);
+	SetBindingValue(P_Radius, Radius);
+	SetBindingValue(P_Count, Count);
+}
+
+#pragma endregion
+
+#pragma region Text Search
+
+FQueryResult UDbStatement::ExecuteTextSearch(const FString& Query, FDbTextSearchPage& Page, const int32 PageSize,
+                                             const bool bRawQuery)
+{
+	if (Page.bFinished || PageSize <= 0)
+		return FQueryResult();
+
+	const FString MatchQuery = bRawQuery ? Query : MakeTextSearchQuery(Query);
+	if (MatchQuery.IsEmpty())
+	{
+		Page.bFinished = true;
+		return FQueryResult();
+	}
+
+	SetBindingValue(P_Query, MatchQuery);
+	SetBindingValue(P_PageSize, PageSize);
+	if (Page.bStarted)
+	{
+		SetBindingValue(P_AfterRank, Page.LastRank);
+		SetBindingValue(P_AfterRowId, Page.LastRowId);
+	}
+	else
+	{
+		SetBindingValueToNull(P_AfterRank);
+		SetBindingValueToNull(P_AfterRowId);
+	}
+
+	FQueryResult Results = ExecuteSelect();
+
+	/* The next page carries on after the last row of this one. */
+	if (Results.Rows.Num() > 0)
+	{
+		for (const FQueryResultField& Field : Results.Rows.Last().Fields)
+		{
+			if (Field.ColName == TEXT("SearchRank"))
+				Page.LastRank = Field.GetFloat();
+			else if (Field.ColName == TEXT("SearchRowId"))
+				Page.LastRowId = Field.GetInteger();
+		}
+		Page.bStarted = true;
+	}
+	Page.bFinished = Results.Rows.Num() < PageSize;
+
+	return Results;
+}
+
+FString UDbStatement::MakeTextSearchQuery(const FString& Text)
+{
+	/* Each word is quoted, so nothing the player types is read as FTS5 syntax, and marked as a prefix. */
+	TArray<FString> Words;
+	Text.ParseIntoArrayWS(Words);
+
+	TArray<FString> Terms;
+	for (const FString& Word : Words)
+		Terms.Add(FString::Printf(TEXT("\"%s\"*"), *Word.Replace(TEXT("\""), TEXT("\"\""))));
+
+	return FString::Join(Terms, TEXT(" "));
+}
+
+#pragma endregion
+
 #pragma region Reflection Utilities
 
 TArray<FProperty*> UDbStatement::FindSaveProperties(UStruct* ThisClass)
@@ -292,70 +560,19 @@ TArray<FProperty*> UDbStatement::FindSaveProperties(UStruct* ThisClass)
 
 bool UDbStatement::ReadIntoObject(UObject* ObjectToFill)
 {
+	check(PreparedStatement && PreparedStatement->IsValid());
+
 	/* NOTE: ObjectToFill->StaticClass() wont work here, as the pointer is UObject*,
 	we would get the UClass* for UObject and not the underlying class.
 	Instead we use GetClass() which returns the UClass for the 'actual' derived class. */
-	UClass*            ObjectClass   = ObjectToFill->GetClass();
-	TArray<FProperty*> SaveGameProps = FindSaveProperties(ObjectClass);
 	bool rc = true;
 
-	check(PreparedStatement && PreparedStatement->IsValid());
-
 	/* We are only interested in the first row of data (if any). */
 	if (PreparedStatement->Step() == ESQLitePreparedStatementStepResult::Row)
 	{
-		TArray<FString> ColumnNames = PreparedStatement->GetColumnNames();
-
-		for (int32 PropIdx = 0; PropIdx < SaveGameProps.Num(); PropIdx++)
-		{
-			FProperty* Property = SaveGameProps[PropIdx];
-			FString    PropName = Property->GetAuthoredName();
-
-			for (int32 ColNameIdx = 0; ColNameIdx < ColumnNames.Num(); ColNameIdx++)
-			{
-				if (FString ColName = ColumnNames[ColNameIdx]; PropName.Compare(*ColName, ESearchCase::IgnoreCase) == 0)
-				{
-					/* We found a property flagged as SaveGame, with a matching column name
-					 * in the resultset row. Set the property's value to the column data. */
-					FQueryResultField Value;
-
-					/* get the sqlite datatype for this column. */
-					ESQLiteColumnType ColType;
-					PreparedStatement->GetColumnTypeByName(*ColName, ColType);
-
-					switch (ColType)
-					{
-					case ESQLiteColumnType::Integer:
-						{
-							Value.Type = EDbValueType::Integer;
-							PreparedStatement->GetColumnValueByName(*ColName, Value.IntVal);
-							break;
-						}
-					case ESQLiteColumnType::Float:
-						{
-							Value.Type = EDbValueType::Float;
-							PreparedStatement->GetColumnValueByName(*ColName, Value.DblVal);
-							break;
-						}
-					case ESQLiteColumnType::String:
-						{
-							Value.Type = EDbValueType::String;
-							PreparedStatement->GetColumnValueByName(*ColName, Value.StrVal);
-							break;
-						}
-					default:
-						{
-							Value.Type = EDbValueType::Null;
-							break;
-						}
-					}
-
-					// ReSharper disable once CppSomeObjectMembersMightNotBeInitialized
-					SetPropertyValue(ObjectToFill, Property, Value);
-					break;
-				}
-			}
-		}
+		/* Set each property flagged as SaveGame, with a matching column name
+		 * in the resultset row, to the column data. */
+		GetHydrationPlan(ObjectToFill->GetClass()).Apply(*PreparedStatement, ObjectToFill);
 	} else 
 	{
 		rc = false;
@@ -539,85 +756,23 @@ void UDbStatement::WriteFromObject(UObject* ObjectToSave)
 
 void UDbStatement::ReadIntoObjectArray(TArray<UObject*>* ArrayToFill, UClass* ObjectClass)
 {
-	// Cache the properties of the object type we need to create, which have the 'SaveGame' specifier.
-	TArray<FProperty*> SaveGameProps = FindSaveProperties(ObjectClass);
-
 	check(PreparedStatement && PreparedStatement->IsValid());
 
 	// We have no idea what the state of the PreparedStatement is, so reset it.
 	PreparedStatement->Reset();
 
+	// The column feeding each 'SaveGame' property of the class, and how to set it, is resolved once,
+	// on the first row (once the columns are known), so each row is just a run of reads by column index.
+	const FDbHydrationPlan* Plan = nullptr;
+
 	// Keep asking for rows until none are returned...
 	while (PreparedStatement->Step() == ESQLitePreparedStatementStepResult::Row)
 	{
-		UObject* NewItem = NewObject<UObject>(this, ObjectClass);
+		if (!Plan)
+			Plan = &GetHydrationPlan(ObjectClass);
 
-		// GetColumnNames() caches them on the first call, so no problem calling it repeatedly.
-		TArray<FString> ColumnNames = PreparedStatement->GetColumnNames();
-
-		// Iterate over all the 'SaveGame' marked properties, 
-		// Fill the NewItem's properties with the corresponding database data.
-		for (int32 PropIdx = 0; PropIdx < SaveGameProps.Num(); PropIdx++)
-		{
-			FProperty* Property = SaveGameProps[PropIdx];
-			FString    PropName = Property->GetAuthoredName();
-
-			for (int32 ColNameIdx = 0; ColNameIdx < ColumnNames.Num(); ColNameIdx++)
-			{
-				FString ColName = ColumnNames[ColNameIdx];
-
-				if (PropName.Compare(*ColName, ESearchCase::IgnoreCase) == 0)
-				{
-					/* We found a property flagged as SaveGame, with a matching column name
-					in the result-set row. Set the property's value to the column data */
-					FQueryResultField NewField;
-
-					// get the sqlite datatype for this column
-					ESQLiteColumnType ColType;
-					PreparedStatement->GetColumnTypeByName(*ColName, ColType);
-
-					switch (ColType)
-					{
-					case ESQLiteColumnType::Integer:
-						{
-							int64 IntValue;
-							if (PreparedStatement->GetColumnValueByName(*ColName, IntValue))
-								NewField = FQueryResultField(IntValue);
-							break;
-						}
-					case ESQLiteColumnType::Float:
-						{
-							double FloatValue;
-							if (PreparedStatement->GetColumnValueByName(*ColName, FloatValue))
-								NewField = FQueryResultField(FloatValue);
-							break;
-						}
-					case ESQLiteColumnType::String:
-						{
-							FString StringValue;
-							if (PreparedStatement->GetColumnValueByName(*ColName, StringValue))
-								NewField = FQueryResultField(StringValue);
-							break;
-						}
-					case ESQLiteColumnType::Blob:
-						{
-							TArray<uint8> BlobValue;
-							if (PreparedStatement->GetColumnValueByName(*ColName, BlobValue))
-								NewField = FQueryResultField(BlobValue);
-							break;
-						}
-					default:
-						NewField = FQueryResultField();
-						break;
-					}
-
-					// ReSharper disable once CppSomeObjectMembersMightNotBeInitialized
-					SetPropertyValue(NewItem, Property, NewField);
-
-					break;
-				}
-			}
-		}
+		UObject* NewItem = NewObject<UObject>(this, ObjectClass);
+		Plan->Apply(*PreparedStatement, NewItem);
 
 		// Add the NewItem to the array.
 		ArrayToFill->Add(NewItem);
@@ -626,168 +781,38 @@ void UDbStatement::ReadIntoObjectArray(TArray<UObject*>* ArrayToFill, UClass* Ob
 	PreparedStatement->Reset();
 }
 
-void UDbStatement::SetPropertyValue(UObject* ObjectToFill, FProperty* PropertyToSet, FQueryResultField Value) const
+const FDbHydrationPlan& UDbStatement::GetHydrationPlan(const UStruct* Type)
 {
-	FString PropName = PropertyToSet->GetAuthoredName();
-
-	FFieldClass*    ThisFieldClass = PropertyToSet->GetClass();
-	EClassCastFlags ThisFieldType  = static_cast<EClassCastFlags>(ThisFieldClass->GetId());
-
-	switch (ThisFieldType)
+	/* SQLite re-prepares the statement when the schema changes (after an ALTER TABLE, say),
+	 * which can change its columns, so the plans are only reused until it has been re-prepared. */
+	const int32 ReprepareCount = PreparedStatement->GetReprepareCount();
+	if (ReprepareCount != HydrationPlansReprepareCount)
 	{
-	case CASTCLASS_FStructProperty:
-		{
-			/* In this case, the property is a USTRUCT, and therefore should contain other properties itself.
-			   This can be handled automatically if the struct inherits from FDbStringSerializer,
-			   and overrides the FromDbString method.
-			   This method allows a query to return compound data in a string,
-			   which the method parses to initialize the struct's values.
-			   For example, you might use a '|' delimited string,
-			   and parse out values into whatever sub properties are required.
-
-			   NOTE of CAUTION: This is intended as a 'development convenience';
-			   both serializing and deserializing data with packed strings obviously comes at the cost
-			   of increased processing overhead.
-			   Use it sparingly for small structs used as properties, which keep the code more organised,
-			   and where the struct may be used in multiple places.
-			*/
-			FStructProperty* PropStruct = CastField<FStructProperty>(PropertyToSet);
-			if (FDbStringSerializer* ActualProp = PropStruct->ContainerPtrToValuePtr<FDbStringSerializer>(ObjectToFill))
-			{
-				ActualProp->FromDbString(Value.StrVal);
-				break;
-			}
-			LOG_GDB(Error, TEXT("Attempt to call SetPropertyValue() with CASTCLASS_FStructProperty, "
-				        "but target UStruct does not inherit from FDbStringSerializer."));
-			checkNoEntry();
-			break;
-		}
-	case CASTCLASS_FBoolProperty:
-		{
-			FBoolProperty* PropBool = CastField<FBoolProperty>(PropertyToSet);
-			if (bool* ValuePtr = PropBool->ContainerPtrToValuePtr<bool>(ObjectToFill))
-				*ValuePtr = (bool)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FByteProperty:
-		{
-			FByteProperty* PropByte = CastField<FByteProperty>(PropertyToSet);
-			if (int8* ValuePtr = PropByte->ContainerPtrToValuePtr<int8>(ObjectToFill))
-				*ValuePtr = (int8)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FInt8Property:
-		{
-			FInt8Property* PropInt8 = CastField<FInt8Property>(PropertyToSet);
-			if (int8* ValuePtr = PropInt8->ContainerPtrToValuePtr<int8>(ObjectToFill))
-				*ValuePtr = (int8)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FInt16Property:
-		{
-			FInt16Property* PropInt16 = CastField<FInt16Property>(PropertyToSet);
-			if (int16* ValuePtr = PropInt16->ContainerPtrToValuePtr<int16>(ObjectToFill))
-				*ValuePtr = (int16)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FUInt16Property:
-		{
-			FUInt16Property* PropInt16_2 = CastField<FUInt16Property>(PropertyToSet);
-			if (int16* ValuePtr = PropInt16_2->ContainerPtrToValuePtr<int16>(ObjectToFill))
-				*ValuePtr = (int16)Value.IntVal;
-			break;
-		}
-	case CASTCLASS_FIntProperty:
-		{
-			FIntProperty* PropInt32 = CastField<FIntProperty>(PropertyToSet);
-			if (int32* ValuePtr = PropInt32->ContainerPtrToValuePtr<int32>(ObjectToFill))
-				*ValuePtr = (int32)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FUInt32Property:
-		{
-			FUInt32Property* PropInt32_2 = CastField<FUInt32Property>(PropertyToSet);
-			if (int32* ValuePtr = PropInt32_2->ContainerPtrToValuePtr<int32>(ObjectToFill))
-				*ValuePtr = (int32)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FInt64Property:
-		{
-			FInt64Property* PropInt64 = CastField<FInt64Property>(PropertyToSet);
-			if (int64* ValuePtr = PropInt64->ContainerPtrToValuePtr<int64>(ObjectToFill))
-				*ValuePtr = Value.IntVal;
-			break;
-		}
-	case CASTCLASS_FUInt64Property:
-		{
-			FUInt64Property* PropInt64_2 = CastField<FUInt64Property>(PropertyToSet);
-			if (int64* ValuePtr = PropInt64_2->ContainerPtrToValuePtr<int64>(ObjectToFill))
-				*ValuePtr = Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FFloatProperty:
-		{
-			FFloatProperty* PropFloat = CastField<FFloatProperty>(PropertyToSet);
-			if (float* ValuePtr = PropFloat->ContainerPtrToValuePtr<float>(ObjectToFill))
-				*ValuePtr = (float)Value.DblVal;
-			break;
-		}
-
-	case CASTCLASS_FDoubleProperty:
-		{
-			FDoubleProperty* PropDouble = CastField<FDoubleProperty>(PropertyToSet);
-			if (double* ValuePtr = PropDouble->ContainerPtrToValuePtr<double>(ObjectToFill))
-				*ValuePtr = Value.DblVal;
-			break;
-		}
-
-	case CASTCLASS_FEnumProperty:
-		{
-			FEnumProperty* PropEnum_2 = CastField<FEnumProperty>(PropertyToSet);
-			if (uint8* ValuePtr = PropEnum_2->ContainerPtrToValuePtr<uint8>(ObjectToFill))
-				*ValuePtr = (uint8)Value.IntVal;
-			break;
-		}
-
-	case CASTCLASS_FStrProperty:
-		{
-			FStrProperty* PropStr = CastField<FStrProperty>(PropertyToSet);
-			if (FString* ValuePtr = PropStr->ContainerPtrToValuePtr<FString>(ObjectToFill))
-				*ValuePtr = Value.StrVal;
-			break;
-		}
-
-	case CASTCLASS_FNameProperty:
-		{
-			FNameProperty* Prop_Name = CastField<FNameProperty>(PropertyToSet);
-			if (FString* ValuePtr = Prop_Name->ContainerPtrToValuePtr<FString>(ObjectToFill))
-				*ValuePtr = Value.StrVal;
-			break;
-		}
+		HydrationPlans.Reset();
+		HydrationPlansReprepareCount = ReprepareCount;
+	}
 
-	case CASTCLASS_FTextProperty:
+	TSharedPtr<const FDbHydrationPlan>* Plan = HydrationPlans.Find(Type);
+	if (!Plan)
+	{
+		/* Drop the plans of types destroyed since, before adding another. */
+		for (auto It = HydrationPlans.CreateIterator(); It; ++It)
 		{
-			FTextProperty* PropText = CastField<FTextProperty>(PropertyToSet);
-			if (FString* ValuePtr = PropText->ContainerPtrToValuePtr<FString>(ObjectToFill))
-				*ValuePtr = Value.StrVal;
-			break;
+			if (!It.Key().IsValid())
+				It.RemoveCurrent();
 		}
+		Plan = &HydrationPlans.Add(Type);
+	}
 
+	if (!*Plan || !(*Plan)->IsCurrent())
+		*Plan = FDbHydrationPlan::Get(Type, *PreparedStatement);
+	return **Plan;
+}
 
-	default: // Currently unsupported property types
-		{
-			LOG_GDB(Error, TEXT("Attempt to call SetPropertyValue() with unsupported Property Type (CASTCLASS)"));
-			checkNoEntry();
-			break;
-		}
-	}
+TSharedPtr<const FDbHydrationPlan> UDbStatement::FindHydrationPlan(const UStruct* Type) const
+{
+	const TSharedPtr<const FDbHydrationPlan>* Plan = HydrationPlans.Find(Type);
+	return Plan ? *Plan : TSharedPtr<const FDbHydrationPlan>();
 }
 
 #pragma endregion
@@ -21,17 +21,17 @@ bool UGameDatabaseStatics::TryFillVector(FVector& Vector,
 			{
 				if (EndsWith == "X")
 				{
-					Vector.X = Field.DblVal;
+					Vector.X = Field.GetFloat();
 					FilledCount++;
 				}
 				else if (EndsWith == "Y")
 				{
-					Vector.Y = Field.DblVal;
+					Vector.Y = Field.GetFloat();
 					FilledCount++;
 				}
 				else if (EndsWith == "Z")
 				{
-					Vector.Y = Field.DblVal;
+					Vector.Y = Field.GetFloat();
 					FilledCount++;
 				}
 
@@ -60,22 +60,22 @@ bool UGameDatabaseStatics::TryFillColor(FLinearColor& Color,
 			{
 				if (EndsWith == "R")
 				{
-					Color.R = Field.DblVal;
+					Color.R = Field.GetFloat();
 					ColorCount++;
 				}
 				else if (EndsWith == "G")
 				{
-					Color.G = Field.DblVal;
+					Color.G = Field.GetFloat();
 					ColorCount++;
 				}
 				else if (EndsWith == "B")
 				{
-					Color.B = Field.DblVal;
+					Color.B = Field.GetFloat();
 					ColorCount++;
 				}
 				else if (EndsWith == "A")
 				{
-					Color.A = Field.DblVal;
+					Color.A = Field.GetFloat();
 					AlphaCount++;
 				}
 
@@ -110,17 +110,17 @@ bool UGameDatabaseStatics::TryFillRotation(FRotator& Rotation,
 			{
 				if (EndsWith == "P")
 				{
-					Rotation.Pitch = Field.DblVal;
+					Rotation.Pitch = Field.GetFloat();
 					FilledCount++;
 				}
 				else if (EndsWith == "R")
 				{
-					Rotation.Roll = Field.DblVal;
+					Rotation.Roll = Field.GetFloat();
 					FilledCount++;
 				}
 				else if (EndsWith == "Y")
 				{
-					Rotation.Yaw = Field.DblVal;
+					Rotation.Yaw = Field.GetFloat();
 					FilledCount++;
 				}
 
@@ -233,3 +233,94 @@ bool UGameDatabaseStatics::TryBindActorRotation(UDbStatement* PreparedStatement,
 
 	return SetRotation;
 }
+
+#pragma region Query Result Fields
+
+EDbValueType UGameDatabaseStatics::GetFieldType(const FQueryResultField& Field)
+{
+	return Field.GetType();
+}
+
+bool UGameDatabaseStatics::IsFieldNull(const FQueryResultField& Field)
+{
+	return Field.IsNull();
+}
+
+int64 UGameDatabaseStatics::GetFieldInteger(const FQueryResultField& Field)
+{
+	return Field.GetInteger();
+}
+
+bool UGameDatabaseStatics::GetFieldBool(const FQueryResultField& Field)
+{
+	return Field.GetBool();
+}
+
+double UGameDatabaseStatics::GetFieldFloat(const FQueryResultField& Field)
+{
+	return Field.GetFloat();
+}
+
+FString UGameDatabaseStatics::GetFieldString(const FQueryResultField& Field)
+{
+	return Field.GetString();
+}
+
+TArray<uint8> UGameDatabaseStatics::GetFieldBlob(const FQueryResultField& Field)
+{
+	return Field.GetBlob();
+}
+
+#pragma endregion
+
+#pragma region Columnar Results
+
+int32 UGameDatabaseStatics::GetColumnarRowCount(const FColumnarQueryResult& Result)
+{
+	return Result.NumRows;
+}
+
+int32 UGameDatabaseStatics::GetColumnarColumnIndex(const FColumnarQueryResult& Result, const FString& ColumnName)
+{
+	return Result.FindColumn(ColumnName);
+}
+
+EDbValueType UGameDatabaseStatics::GetColumnarValueType(const FColumnarQueryResult& Result, const int32 Row,
+                                                        const int32 Column)
+{
+	return Result.GetType(Row, Column);
+}
+
+int64 UGameDatabaseStatics::GetColumnarInteger(const FColumnarQueryResult& Result, const int32 Row, const int32 Column)
+{
+	return Result.GetInteger(Row, Column);
+}
+
+bool UGameDatabaseStatics::GetColumnarBool(const FColumnarQueryResult& Result, const int32 Row, const int32 Column)
+{
+	return Result.GetInteger(Row, Column) != 0;
+}
+
+double UGameDatabaseStatics::GetColumnarFloat(const FColumnarQueryResult& Result, const int32 Row, const int32 Column)
+{
+	return Result.GetFloat(Row, Column);
+}
+
+FString UGameDatabaseStatics::GetColumnarString(const FColumnarQueryResult& Result, const int32 Row,
+                                                const int32 Column)
+{
+	return Result.GetString(Row, Column);
+}
+
+TArray<uint8> UGameDatabaseStatics::GetColumnarBlob(const FColumnarQueryResult& Result, const int32 Row,
+                                                    const int32 Column)
+{
+	return TArray<uint8>(Result.GetBlob(Row, Column));
+}
+
+FQueryResultRow UGameDatabaseStatics::GetColumnarRow(const FColumnarQueryResult& Result, const int32 Row)
+{
+	return Result.GetRow(Row);
+}
+
+#pragma endregion
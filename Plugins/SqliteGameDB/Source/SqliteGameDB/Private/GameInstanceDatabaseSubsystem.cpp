@@ -4,6 +4,7 @@
 #include "CustomLogging.h"
 #include "DbBase.h"
 #include "SqliteGameDBSettings.h"
+#include "SQLitePageCache.h"
 
 // forward declare static variables
 UGameInstanceDatabaseSubsystem* UDbManagerStatics::DBSubSystem = nullptr;
@@ -68,6 +69,8 @@ void UGameInstanceDatabaseSubsystem::Initialize(FSubsystemCollectionBase& Collec
 		return;
 	}
 
+	FSQLitePageCache::SetMemoryBudget((int64)DatabaseSettings->PageCacheBudgetMiB * 1024 * 1024);
+
 	/* At this point we are free to initialize any DatabaseBase derived classes
 	 * that are specified in the custom settings. */
 	for (const FGameDbConfig DbConfig : DatabaseSettings->DatabaseConnectionClasses)
@@ -25,6 +25,9 @@ void USplitDbBase::Build(FString DatabaseFilePath, FGameDbConfig Config)
 
 	// TODO: Fix this when you are feeling less stupid!
 	/* Fiasco just to concatenate a '/' between a couple of strings... but the format might change. */
+	LogCacheSizeKiB = LogAttachment.CacheSizeKiB;
+	PlayCacheSizeKiB = PlayAttachment.CacheSizeKiB;
+
 	LogTemplateDbFilePath = FString::Format(*TemplatePath, {DatabaseContentFolder, LogAttachment.FileName});
 	PlayTemplateDbFilePath = FString::Format(*TemplatePath, {DatabaseContentFolder, PlayAttachment.FileName});
 	PlayStagingDbFilePath = FString::Format(*PlayInstancePath,
@@ -70,6 +73,7 @@ void USplitDbBase::ConnectLogDb()
 
 	if (QueryManager->AttachDatabase(InstancedLogDbPath, SchemaLog))
 	{
+		SetSchemaCacheSize(SchemaLog, LogCacheSizeKiB);
 		QueryManager->LoadStatementsIntoGroup(SchemaLog);
 
 		/* Clean the log DB. */
@@ -118,6 +122,17 @@ bool USplitDbBase::ConnectPlayDb(int32 LogIndex)
 		        TEXT("Unable to delete the current working copy playdb."));
 	}
 
+	/* A write-ahead log (or batch redo log) left behind by a crash would otherwise be replayed into the new working copy. */
+	for (const TCHAR* LogSuffix : {TEXT("-wal"), TEXT("-batch")})
+	{
+		const FString WorkingCopyLogPath = WorkingCopyPlayDbPath + LogSuffix;
+		if (FileManager.FileExists(*WorkingCopyLogPath))
+		{
+			verifyf(FileManager.DeleteFile(*WorkingCopyLogPath),
+			        TEXT("Unable to delete the stale working copy log: %s"), *WorkingCopyLogPath);
+		}
+	}
+
 	/* Clone the selected file to the working copy. */
 	verifyf(FileManager.CopyFile(*WorkingCopyPlayDbPath, *CurrentSourcePlayDbPath ),
 	        TEXT("Unable to make a working copy of playdb."));
@@ -125,6 +140,11 @@ bool USplitDbBase::ConnectPlayDb(int32 LogIndex)
 	/* Attach to the new one. */
 	if (QueryManager->AttachDatabase(WorkingCopyPlayDbPath, SchemaPlay))
 	{
+		/* The working copy takes frequent small writes (autosaves),
+		 * so append them to a write-ahead log rather than rewriting pages through a rollback journal. */
+		QueryManager->RunTempActionQuery(Q_PlayJournalModeWal);
+		SetSchemaCacheSize(SchemaPlay, PlayCacheSizeKiB);
+
 		QueryManager->LoadStatementsIntoGroup(SchemaPlay);
 		return true;
 	}
@@ -150,7 +170,7 @@ bool USplitDbBase::IsConnectedPlayDb()
 int32 USplitDbBase::CountLogEntries(TArray<EPlayDbPurpose> FilterBy)
 {
 	UDbStatement* PsLogCount = QueryManager->FindStatementInGroup(SchemaLog, LOG_GetLogFilesCount);
-	return PsLogCount->ExecuteScalar().IntVal;
+	return PsLogCount->ExecuteScalarInt64();
 }
 
 bool USplitDbBase::CreatePlayDbFromTemplate(FString Title, FString Additional,
@@ -174,6 +194,9 @@ bool USplitDbBase::CreatePlayDbFromCurrent(FString Title, FString Additional,
 	UDbStatement* qCleanPlay = QueryManager->FindStatementInGroup(SchemaPlay, PLAY_CleanPlay);
 	qCleanPlay->ExecuteAction();
 
+	/* Move everything in the write-ahead log back into the working copy file, as only that file gets copied. */
+	QueryManager->RunTempActionQuery(Q_PlayWalCheckpoint);
+
 	int32 NewIndex = CreatePlayDbFromSource(WorkingCopyPlayDbPath, Title, Additional, Purpose);
 	return NewIndex != -1;
 }
@@ -196,12 +219,11 @@ bool USplitDbBase::CreateQuickSavePlayDb(FString Additional)
 bool USplitDbBase::ConnectResumePlayDb()
 {
 	UDbStatement* qGetLatestLog = QueryManager->FindStatementInGroup(SchemaLog, LOG_GetLatestLog);
-	return ConnectPlayDb(qGetLatestLog->ExecuteScalar().IntVal);
+	return ConnectPlayDb(qGetLatestLog->ExecuteScalarInt64());
 }
 
 TArray<FLogInfo> USplitDbBase::ListLogEntries(int32 MaxResults, TArray<EPlayDbPurpose> FilterBy)
 {
-	TArray<FLogInfo> Results;
 	FString Purposes = TEXT(",");
 
 	for (int i = 0; i < FilterBy.Num(); ++i)
@@ -214,23 +236,7 @@ TArray<FLogInfo> USplitDbBase::ListLogEntries(int32 MaxResults, TArray<EPlayDbPu
 	qGetLogEntries->SetBindingValue(P_MaxRecords, MaxResults);
 	qGetLogEntries->SetBindingValue(P_Purpose, Purposes);
 
-	FQueryResult RawResults = qGetLogEntries->ExecuteSelect();
-	for (FQueryResultRow RawRow : RawResults.Rows)
-	{
-		FDateTime Created;
-		FDateTime::Parse(RawRow.Fields[1].StrVal, Created);
-
-		FLogInfo LogItem = FLogInfo(
-			RawRow.Fields[0].IntVal,
-			Created,
-			RawRow.Fields[2].StrVal,
-			RawRow.Fields[3].StrVal,
-			static_cast<EPlayDbPurpose>(RawRow.Fields[4].IntVal)
-		);
-		Results.Add(LogItem);
-	}
-
-	return Results;
+	return ReadLogEntries(qGetLogEntries);
 }
 
 TArray<FLogInfo> USplitDbBase::ListLogEntries(int32 MaxResults, TArray<EPlayDbPurpose> FilterBy, bool Unused)
@@ -240,7 +246,6 @@ TArray<FLogInfo> USplitDbBase::ListLogEntries(int32 MaxResults, TArray<EPlayDbPu
 
 TArray<FLogInfo> USplitDbBase::ListLogEntriesPaged(int32 RecordsPerPage, int32 PageNumber, TArray<EPlayDbPurpose> FilterBy)
 {
-	TArray<FLogInfo> Results;
 	FString Purposes = TEXT(",");
 
 	for (int i = 0; i < FilterBy.Num(); ++i)
@@ -254,31 +259,37 @@ TArray<FLogInfo> USplitDbBase::ListLogEntriesPaged(int32 RecordsPerPage, int32 P
 	qGetLogEntries->SetBindingValue(P_PageNumber, PageNumber);
 	qGetLogEntries->SetBindingValue(P_Purpose, Purposes);
 
-	FQueryResult RawResults = qGetLogEntries->ExecuteSelect();
-	for (FQueryResultRow RawRow : RawResults.Rows)
+	return ReadLogEntries(qGetLogEntries);
+}
+
+TArray<FLogInfo> USplitDbBase::ListLogEntriesPaged(int32 RecordsPerPage, int32 PageNumber, TArray<EPlayDbPurpose> FilterBy,
+	bool Unused)
+{
+	return ListLogEntriesPaged(RecordsPerPage, PageNumber, FilterBy);
+}
+
+TArray<FLogInfo> USplitDbBase::ReadLogEntries(UDbStatement* Statement) const
+{
+	TArray<FLogInfo> Results;
+
+	/* Each row is read straight from the statement, into its FLogInfo. */
+	for (const FDbCursor& Row : Statement->OpenCursor())
 	{
 		FDateTime Created;
-		FDateTime::Parse(RawRow.Fields[1].StrVal, Created);
+		FDateTime::Parse(Row.GetString(1), Created);
 
-		FLogInfo LogItem = FLogInfo(
-			RawRow.Fields[0].IntVal,
+		Results.Emplace(
+			Row.GetInteger(0),
 			Created,
-			RawRow.Fields[2].StrVal,
-			RawRow.Fields[3].StrVal,
-			static_cast<EPlayDbPurpose>(RawRow.Fields[4].IntVal)
+			Row.GetString(2),
+			Row.GetString(3),
+			static_cast<EPlayDbPurpose>(Row.GetInteger(4))
 		);
-		Results.Add(LogItem);
 	}
 
 	return Results;
 }
 
-TArray<FLogInfo> USplitDbBase::ListLogEntriesPaged(int32 RecordsPerPage, int32 PageNumber, TArray<EPlayDbPurpose> FilterBy,
-	bool Unused)
-{
-	return ListLogEntriesPaged(RecordsPerPage, PageNumber, FilterBy);
-}
-
 FString USplitDbBase::GetCurrentLogDbPath() const
 {
 	return InstancedLogDbPath;
@@ -315,7 +326,7 @@ int32 USplitDbBase::CreatePlayDbFromSource(FString Source, FString Title, FStrin
 		{
 			/* Retrieve the new LOG record. */
 			UDbStatement* qGetNewLog = QueryManager->FindStatement(LOG_GetLatestLog);
-			NewIndex = qGetNewLog->ExecuteScalar().IntVal;
+			NewIndex = qGetNewLog->ExecuteScalarInt64();
 
 			if (NewIndex > 0)
 			{
@@ -334,6 +345,15 @@ int32 USplitDbBase::CreatePlayDbFromSource(FString Source, FString Title, FStrin
 	return NewIndex;
 }
 
+void USplitDbBase::SetSchemaCacheSize(const FString& SchemaName, int32 CacheSizeKiB) const
+{
+	/* A negative cache size is in KiB rather than pages. */
+	if (CacheSizeKiB > 0)
+	{
+		QueryManager->RunTempActionQuery(FString::Printf(TEXT("PRAGMA %s.cache_size = -%d;"), *SchemaName, CacheSizeKiB));
+	}
+}
+
 bool USplitDbBase::FindAttachmentOfType(TArray<FGameDbAttachment>& Source, EDbFilePurpose Purpose,
                                    FGameDbAttachment& OutAttachment) const
 {
@@ -34,7 +34,7 @@ int32 UPreparedStatementGroup::RefillFromDatabase()
 	/* Check that the database actually has a 'queries' table. */
 	FQueryResult QrHasQueries = Db->QueryManager->RunTempSelectQuery(Q_HasQueries);
 
-	if (QrHasQueries.Rows.Num() > 0 && QrHasQueries.Rows[0].Fields[0].IntVal == 1)
+	if (QrHasQueries.Rows.Num() > 0 && QrHasQueries.Rows[0].Fields[0].GetInteger() == 1)
 	{
 		FString ListFilteredQueries;
 
@@ -59,7 +59,7 @@ int32 UPreparedStatementGroup::RefillFromDatabase()
 		for (int i = 0; i < Result; ++i)
 		{
 			FQueryResultRow ThisRow = QrListQueries.Rows[i];
-			AddStatement(ThisRow.Fields[0].StrVal, ThisRow.Fields[3].StrVal);
+			AddStatement(ThisRow.Fields[0].GetString(), ThisRow.Fields[3].GetString());
 		}
 	}
 
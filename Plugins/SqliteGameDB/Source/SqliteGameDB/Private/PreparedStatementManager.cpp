@@ -3,6 +3,7 @@
 #include "PreparedStatementManager.h"
 #include "DbBase.h"
 #include "DbStatement.h"
+#include "CustomLogging.h"
 
 
 void UPreparedStatementManager::Initialize(UDbBase* InDb)
@@ -133,7 +134,7 @@ bool UPreparedStatementManager::IsSchemaAttached(const FString SchemaName) const
 	TempStatement->SetBindingValue(P_SchemaName, SchemaName);
 
 	/* Execute it. */
-	const bool Result = TempStatement->ExecuteScalar().BoolVal;
+	const bool Result = TempStatement->ExecuteScalarInt64() != 0;
 
 	/* Clean up. */
 	TempStatement->ConditionalBeginDestroy();
@@ -150,7 +151,7 @@ TArray<FString> UPreparedStatementManager::ListAttachedSchemas() const
 	for (int i = 0; i < QResults.Rows.Num(); ++i)
 	{
 		FQueryResultRow ThisRow = QResults.Rows[i];
-		Results.Add(ThisRow.Fields[0].StrVal);
+		Results.Add(ThisRow.Fields[0].GetString());
 	}
 
 	return Results;
@@ -216,15 +217,12 @@ UDbStatement* UPreparedStatementManager::CreateStatementInGroup(const FString Gr
 
 FQueryResultField UPreparedStatementManager::RunTempScalarQuery(const FString SqlToRun) const
 {
-	FQueryResult Results = RunTempSelectQuery(SqlToRun);
-	if (Results.Rows.Num() > 0)
-	{
-		return Results.Rows[0].Fields[0];
-	}
+	UDbStatement* Temp = NewObject<UDbStatement>();
+	Temp->Initialize(Db->SqliteDb, SqlToRun);
+	FQueryResultField Result = Temp->ExecuteScalar();
+	Temp->ConditionalBeginDestroy();
 
-	FQueryResultField NoData;
-	NoData.Type = EDbValueType::Null;
-	return NoData;
+	return Result;
 }
 
 void UPreparedStatementManager::RunTempActionQuery(const FString SqlToRun) const
@@ -247,6 +245,251 @@ void UPreparedStatementManager::RollbackTransaction()
 	Db->SqliteDb->Execute(*Q_TranRollback);
 }
 
+bool UPreparedStatementManager::CreateSpatialIndex(const FString TableName, const FString ColumnPrefix) const
+{
+	const FString Table = QuoteIdentifier(TableName);
+	const FString IndexName = GetSpatialIndexName(TableName, ColumnPrefix);
+	const FString Index = QuoteIdentifier(IndexName);
+	const FString X = QuoteIdentifier(ColumnPrefix + TEXT("X"));
+	const FString Y = QuoteIdentifier(ColumnPrefix + TEXT("Y"));
+	const FString Z = QuoteIdentifier(ColumnPrefix + TEXT("Z"));
+
+	/* The index is keyed by rowid, and each location is stored as a zero-sized box. */
+	const TArray<FString> SqlStatements = {
+		FString::Printf(
+			TEXT("CREATE VIRTUAL TABLE IF NOT EXISTS %s USING rtree(id, minX, maxX, minY, maxY, minZ, maxZ);"),
+			*Index),
+
+		/* Refill from scratch, in case the index was left behind by an earlier run. */
+		FString::Printf(TEXT("DELETE FROM %s;"), *Index),
+		FString::Printf(
+			TEXT("INSERT INTO %s SELECT rowid, %s, %s, %s, %s, %s, %s FROM %s "
+				"WHERE %s IS NOT NULL AND %s IS NOT NULL AND %s IS NOT NULL;"),
+			*Index, *X, *X, *Y, *Y, *Z, *Z, *Table, *X, *Y, *Z),
+
+		/* Inserts remove any stale entry first, as rowids can be reused. */
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s AFTER INSERT ON %s BEGIN "
+				"DELETE FROM %s WHERE id = new.rowid; "
+				"INSERT INTO %s SELECT new.rowid, new.%s, new.%s, new.%s, new.%s, new.%s, new.%s "
+				"WHERE new.%s IS NOT NULL AND new.%s IS NOT NULL AND new.%s IS NOT NULL; "
+				"END;"),
+			*QuoteIdentifier(IndexName + TEXT("_insert")), *Table, *Index, *Index, *X, *X, *Y, *Y, *Z, *Z, *X, *Y, *Z),
+
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s AFTER UPDATE OF %s, %s, %s ON %s BEGIN "
+				"DELETE FROM %s WHERE id = old.rowid; "
+				"INSERT INTO %s SELECT new.rowid, new.%s, new.%s, new.%s, new.%s, new.%s, new.%s "
+				"WHERE new.%s IS NOT NULL AND new.%s IS NOT NULL AND new.%s IS NOT NULL; "
+				"END;"),
+			*QuoteIdentifier(IndexName + TEXT("_update")), *X, *Y, *Z, *Table, *Index, *Index, *X, *X, *Y, *Y, *Z, *Z, *X, *Y, *Z),
+
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s AFTER DELETE ON %s BEGIN "
+				"DELETE FROM %s WHERE id = old.rowid; "
+				"END;"),
+			*QuoteIdentifier(IndexName + TEXT("_delete")), *Table, *Index),
+	};
+
+	return ExecuteInSavepoint(SqlStatements);
+}
+
+bool UPreparedStatementManager::DropSpatialIndex(const FString TableName, const FString ColumnPrefix) const
+{
+	const FString IndexName = GetSpatialIndexName(TableName, ColumnPrefix);
+
+	const TArray<FString> SqlStatements = {
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s;"), *QuoteIdentifier(IndexName + TEXT("_insert"))),
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s;"), *QuoteIdentifier(IndexName + TEXT("_update"))),
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s;"), *QuoteIdentifier(IndexName + TEXT("_delete"))),
+		FString::Printf(TEXT("DROP TABLE IF EXISTS %s;"), *QuoteIdentifier(IndexName)),
+	};
+
+	return ExecuteInSavepoint(SqlStatements);
+}
+
+UDbStatement* UPreparedStatementManager::CreateSpatialBoxStatement(const FString StatementName,
+                                                                   const FString TableName,
+                                                                   const FString ColumnPrefix)
+{
+	const FString QuerySql = FString::Printf(
+		TEXT("SELECT T.* FROM %s AS T JOIN %s AS R ON R.id = T.rowid WHERE %s;"),
+		*QuoteIdentifier(TableName), *QuoteIdentifier(GetSpatialIndexName(TableName, ColumnPrefix)),
+		*GetSpatialBoxCondition(ColumnPrefix));
+
+	return CreateStatement(StatementName, QuerySql);
+}
+
+UDbStatement* UPreparedStatementManager::CreateSpatialRadiusStatement(const FString StatementName,
+                                                                      const FString TableName,
+                                                                      const FString ColumnPrefix)
+{
+	/* dist3 is one of the builtin functions registered on every game database. */
+	const FString QuerySql = FString::Printf(
+		TEXT("SELECT T.*, dist3(T.%s, T.%s, T.%s, @CenterX, @CenterY, @CenterZ) AS SpatialDistance "
+			"FROM %s AS T JOIN %s AS R ON R.id = T.rowid "
+			"WHERE %s AND SpatialDistance <= @Radius "
+			"ORDER BY SpatialDistance LIMIT @Count;"),
+		*QuoteIdentifier(ColumnPrefix + TEXT("X")), *QuoteIdentifier(ColumnPrefix + TEXT("Y")),
+		*QuoteIdentifier(ColumnPrefix + TEXT("Z")),
+		*QuoteIdentifier(TableName), *QuoteIdentifier(GetSpatialIndexName(TableName, ColumnPrefix)),
+		*GetSpatialBoxCondition(ColumnPrefix));
+
+	return CreateStatement(StatementName, QuerySql);
+}
+
+bool UPreparedStatementManager::CreateTextIndex(const FString TableName, const TArray<FString>& ColumnNames,
+                                                const FString SchemaName) const
+{
+	if (ColumnNames.Num() == 0)
+		return false;
+
+	const FString Schema = QuoteIdentifier(SchemaName);
+	const FString Table = QuoteIdentifier(TableName);
+	const FString IndexName = GetTextIndexName(TableName);
+	const FString Index = QuoteIdentifier(IndexName);
+
+	/* Column lists, as used by the index, and by the triggers for the new and old values of a row. */
+	TArray<FString> Columns, NewColumns, OldColumns;
+	for (const FString& ColumnName : ColumnNames)
+	{
+		const FString Column = QuoteIdentifier(ColumnName);
+		Columns.Add(Column);
+		NewColumns.Add(TEXT("new.") + Column);
+		OldColumns.Add(TEXT("old.") + Column);
+	}
+	const FString ColumnList = FString::Join(Columns, TEXT(", "));
+	const FString NewColumnList = FString::Join(NewColumns, TEXT(", "));
+	const FString OldColumnList = FString::Join(OldColumns, TEXT(", "));
+
+	/* An external content index reads the text from the table itself, and is keyed by its rowid.
+	 * Tables inside triggers are unqualified, as they always refer to the trigger's own schema.
+	 * The prefix indexes keep prefix queries (as typed into a search box) fast. */
+	const TArray<FString> SqlStatements = {
+		FString::Printf(
+			TEXT("CREATE VIRTUAL TABLE IF NOT EXISTS %s.%s USING fts5(%s, content='%s', "
+				"tokenize='unicode61 remove_diacritics 2', prefix='2 3');"),
+			*Schema, *Index, *ColumnList, *TableName.Replace(TEXT("'"), TEXT("''"))),
+
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s.%s AFTER INSERT ON %s BEGIN "
+				"INSERT INTO %s(rowid, %s) VALUES (new.rowid, %s); "
+				"END;"),
+			*Schema, *QuoteIdentifier(IndexName + TEXT("_insert")), *Table, *Index, *ColumnList, *NewColumnList),
+
+		/* An external content index must be given the old text of a row to remove it. */
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s.%s AFTER UPDATE OF %s ON %s BEGIN "
+				"INSERT INTO %s(%s, rowid, %s) VALUES ('delete', old.rowid, %s); "
+				"INSERT INTO %s(rowid, %s) VALUES (new.rowid, %s); "
+				"END;"),
+			*Schema, *QuoteIdentifier(IndexName + TEXT("_update")), *ColumnList, *Table,
+			*Index, *Index, *ColumnList, *OldColumnList,
+			*Index, *ColumnList, *NewColumnList),
+
+		FString::Printf(
+			TEXT("CREATE TRIGGER IF NOT EXISTS %s.%s AFTER DELETE ON %s BEGIN "
+				"INSERT INTO %s(%s, rowid, %s) VALUES ('delete', old.rowid, %s); "
+				"END;"),
+			*Schema, *QuoteIdentifier(IndexName + TEXT("_delete")), *Table, *Index, *Index, *ColumnList, *OldColumnList),
+
+		/* Refill from scratch, in case the index was left behind by an earlier run. */
+		FString::Printf(TEXT("INSERT INTO %s.%s(%s) VALUES ('rebuild');"), *Schema, *Index, *Index),
+	};
+
+	return ExecuteInSavepoint(SqlStatements);
+}
+
+bool UPreparedStatementManager::DropTextIndex(const FString TableName, const FString SchemaName) const
+{
+	const FString Schema = QuoteIdentifier(SchemaName);
+	const FString IndexName = GetTextIndexName(TableName);
+
+	const TArray<FString> SqlStatements = {
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s.%s;"), *Schema, *QuoteIdentifier(IndexName + TEXT("_insert"))),
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s.%s;"), *Schema, *QuoteIdentifier(IndexName + TEXT("_update"))),
+		FString::Printf(TEXT("DROP TRIGGER IF EXISTS %s.%s;"), *Schema, *QuoteIdentifier(IndexName + TEXT("_delete"))),
+		FString::Printf(TEXT("DROP TABLE IF EXISTS %s.%s;"), *Schema, *QuoteIdentifier(IndexName)),
+	};
+
+	return ExecuteInSavepoint(SqlStatements);
+}
+
+UDbStatement* UPreparedStatementManager::CreateTextSearchStatement(const FString StatementName,
+                                                                   const FString TableName,
+                                                                   const FString SchemaName,
+                                                                   const FString HighlightStart,
+                                                                   const FString HighlightEnd,
+                                                                   const int32 SnippetTokens)
+{
+	const FString Schema = QuoteIdentifier(SchemaName);
+	const FString Index = QuoteIdentifier(GetTextIndexName(TableName));
+
+	/* Results are keyset paged on (rank, rowid): each page starts after the last row of the previous one.
+	 * The first page binds @AfterRowId to NULL. */
+	const FString QuerySql = FString::Printf(
+		TEXT("SELECT T.*, %s.rowid AS SearchRowId, %s.rank AS SearchRank, "
+			"snippet(%s, -1, '%s', '%s', '...', %d) AS SearchSnippet "
+			"FROM %s.%s JOIN %s.%s AS T ON T.rowid = %s.rowid "
+			"WHERE %s MATCH @Query "
+			"AND (@AfterRowId IS NULL OR %s.rank > @AfterRank OR (%s.rank = @AfterRank AND %s.rowid > @AfterRowId)) "
+			"ORDER BY %s.rank, %s.rowid LIMIT @PageSize;"),
+		*Index, *Index,
+		*Index, *HighlightStart.Replace(TEXT("'"), TEXT("''")), *HighlightEnd.Replace(TEXT("'"), TEXT("''")),
+		FMath::Clamp(SnippetTokens, 1, 64),
+		*Schema, *Index, *Schema, *QuoteIdentifier(TableName), *Index,
+		*Index,
+		*Index, *Index, *Index,
+		*Index, *Index);
+
+	return CreateStatement(StatementName, QuerySql);
+}
+
+FString UPreparedStatementManager::GetTextIndexName(const FString& TableName)
+{
+	return FString::Printf(TEXT("%s_fts"), *TableName);
+}
+
+FString UPreparedStatementManager::GetSpatialIndexName(const FString& TableName, const FString& ColumnPrefix)
+{
+	return FString::Printf(TEXT("%s_%s_rtree"), *TableName, *ColumnPrefix);
+}
+
+FString UPreparedStatementManager::GetSpatialBoxCondition(const FString& ColumnPrefix)
+{
+	/* The index stores 32-bit floats, rounded outwards, so it can return rows slightly outside the box;
+	 * these are removed by the exact test on the table's own columns. */
+	return FString::Printf(
+		TEXT("R.minX <= @MaxX AND R.maxX >= @MinX AND R.minY <= @MaxY AND R.maxY >= @MinY AND R.minZ <= @MaxZ AND R.maxZ >= @MinZ "
+			"AND T.%s BETWEEN @MinX AND @MaxX AND T.%s BETWEEN @MinY AND @MaxY AND T.%s BETWEEN @MinZ AND @MaxZ"),
+		*QuoteIdentifier(ColumnPrefix + TEXT("X")), *QuoteIdentifier(ColumnPrefix + TEXT("Y")),
+		*QuoteIdentifier(ColumnPrefix + TEXT("Z")));
+}
+
+FString UPreparedStatementManager::QuoteIdentifier(const FString& Identifier)
+{
+	return FString::Printf(TEXT("\"%s\""), *Identifier.Replace(TEXT("\""), TEXT("\"\"")));
+}
+
+bool UPreparedStatementManager::ExecuteInSavepoint(const TArray<FString>& SqlStatements) const
+{
+	if (!Db->SqliteDb->Execute(TEXT("SAVEPOINT statement_manager;")))
+		return false;
+
+	for (const FString& SqlStatement : SqlStatements)
+	{
+		if (!Db->SqliteDb->Execute(*SqlStatement))
+		{
+			UE_LOG(LogSqliteGameDB, Warning, TEXT("Statement failed, rolling back: %s"), *(Db->SqliteDb->GetLastError()));
+			Db->SqliteDb->Execute(TEXT("ROLLBACK TO statement_manager;"));
+			Db->SqliteDb->Execute(TEXT("RELEASE statement_manager;"));
+			return false;
+		}
+	}
+
+	return Db->SqliteDb->Execute(TEXT("RELEASE statement_manager;"));
+}
+
 FQueryResult UPreparedStatementManager::RunTempSelectQuery(const FString SqlToRun) const
 {
 	UDbStatement* Temp = NewObject<UDbStatement>();
@@ -256,3 +499,13 @@ FQueryResult UPreparedStatementManager::RunTempSelectQuery(const FString SqlToRu
 
 	return Results;
 }
+
+FColumnarQueryResult UPreparedStatementManager::RunTempSelectQueryColumnar(const FString SqlToRun) const
+{
+	UDbStatement* Temp = NewObject<UDbStatement>();
+	Temp->Initialize(Db->SqliteDb, SqlToRun);
+	FColumnarQueryResult Results = Temp->ExecuteSelectColumnar();
+	Temp->ConditionalBeginDestroy();
+
+	return Results;
+}
@@ -1,18 +1,33 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "SqliteGameDB.h"
+#include "UObject/UObjectGlobals.h"
+#include "DbHydrationPlan.h"
 
 #define LOCTEXT_NAMESPACE "FSqliteGameDBModule"
 
 void FSqliteGameDBModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	/* Hydration plans hold raw property pointers, which a Blueprint recompile or a reload can leave dangling. */
+	ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda(
+		[](const TMap<UObject*, UObject*>&) { FDbHydrationPlan::FlushCache(); });
+	ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda(
+		[](EReloadCompleteReason) { FDbHydrationPlan::FlushCache(); });
+	ReloadReinstancingCompleteHandle = FCoreUObjectDelegates::ReloadReinstancingCompleteDelegate.AddStatic(
+		&FDbHydrationPlan::FlushCache);
 }
 
 void FSqliteGameDBModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+	FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+	FCoreUObjectDelegates::ReloadReinstancingCompleteDelegate.Remove(ReloadReinstancingCompleteHandle);
+	FDbHydrationPlan::FlushCache();
 }
 
 #undef LOCTEXT_NAMESPACE
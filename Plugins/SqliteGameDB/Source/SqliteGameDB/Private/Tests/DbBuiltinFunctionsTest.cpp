@@ -0,0 +1,70 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+#include "PreparedStatementManager.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbBuiltinFunctionsTest, "System.Plugins.Database.SqliteGameDB.BuiltinFunctions", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbBuiltinFunctionsTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("BuiltinFunctions"));
+	const UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+	auto Scalar = [Queries](const TCHAR* Sql)
+	{
+		return Queries->RunTempScalarQuery(Sql);
+	};
+
+	/* dist3 */
+	{
+		TestEqual(TEXT("dist3 of a 3-4-5 triangle"), Scalar(TEXT("SELECT dist3(0, 0, 0, 3, 4, 0)")).GetFloat(), 5.0);
+		TestEqual(TEXT("dist3 of the same point"), Scalar(TEXT("SELECT dist3(1, 2, 3, 1, 2, 3)")).GetFloat(), 0.0);
+		TestTrue(TEXT("dist3 with a NULL argument is NULL"), Scalar(TEXT("SELECT dist3(NULL, 0, 0, 3, 4, 0)")).IsNull());
+		TestEqual(TEXT("dist3 converts numeric text"), Scalar(TEXT("SELECT dist3('3', '4', 0, 0, 0, 0)")).GetFloat(), 5.0);
+		TestTrue(TEXT("dist3 with non-numeric text is NULL"), Scalar(TEXT("SELECT dist3('abc', 0, 0, 3, 4, 0)")).IsNull());
+		TestTrue(TEXT("dist3 with a blob is NULL"), Scalar(TEXT("SELECT dist3(0, 0, 0, 3, 4, zeroblob(8))")).IsNull());
+	}
+
+	/* within_box */
+	{
+		TestEqual(TEXT("within_box inside"), Scalar(TEXT("SELECT within_box(1, 1, 1, 0, 0, 0, 2, 2, 2)")).GetInteger(), (int64)1);
+		TestEqual(TEXT("within_box on the edge"), Scalar(TEXT("SELECT within_box(2, 2, 2, 0, 0, 0, 2, 2, 2)")).GetInteger(), (int64)1);
+		TestEqual(TEXT("within_box outside"), Scalar(TEXT("SELECT within_box(3, 1, 1, 0, 0, 0, 2, 2, 2)")).GetInteger(), (int64)0);
+		TestTrue(TEXT("within_box with a NULL argument is NULL"), Scalar(TEXT("SELECT within_box(1, 1, NULL, 0, 0, 0, 2, 2, 2)")).IsNull());
+		TestEqual(TEXT("within_box converts numeric text"), Scalar(TEXT("SELECT within_box('1', 1, 1, 0, 0, 0, 2, 2, 2)")).GetInteger(), (int64)1);
+	}
+
+	/* guid_parse and guid_format */
+	{
+		const FGuid Guid(0x01234567, 0x89ABCDEF, 0x0F1E2D3C, 0x4B5A6978);
+		const FString GuidText = Guid.ToString(EGuidFormats::DigitsWithHyphens);
+
+		const FQueryResultField Parsed = Scalar(*FString::Printf(TEXT("SELECT guid_parse('%s')"), *GuidText));
+		TestEqual(TEXT("guid_parse returns a blob"), Parsed.GetType(), EDbValueType::Blob);
+		TestEqual(TEXT("guid_parse blob size"), Parsed.GetBlob().Num(), (int32)sizeof(FGuid));
+
+		TestEqual(TEXT("guid_format round trip"),
+		          Scalar(*FString::Printf(TEXT("SELECT guid_format(guid_parse('%s'))"), *GuidText)).GetString(),
+		          Guid.ToString());
+		TestEqual(TEXT("guid_format of an all zero blob"), Scalar(TEXT("SELECT guid_format(zeroblob(16))")).GetString(),
+		          FGuid().ToString());
+
+		TestTrue(TEXT("guid_parse of text that isn't a GUID is NULL"), Scalar(TEXT("SELECT guid_parse('not a guid')")).IsNull());
+		TestTrue(TEXT("guid_parse of an integer is NULL"), Scalar(TEXT("SELECT guid_parse(42)")).IsNull());
+		TestTrue(TEXT("guid_parse of NULL is NULL"), Scalar(TEXT("SELECT guid_parse(NULL)")).IsNull());
+
+		TestTrue(TEXT("guid_format of a short blob is NULL"), Scalar(TEXT("SELECT guid_format(zeroblob(15))")).IsNull());
+		TestTrue(TEXT("guid_format of text is NULL"), Scalar(TEXT("SELECT guid_format('abc')")).IsNull());
+		TestTrue(TEXT("guid_format of 16 character text is NULL"), Scalar(TEXT("SELECT guid_format('0123456789ABCDEF')")).IsNull());
+		TestTrue(TEXT("guid_format of an integer is NULL"), Scalar(TEXT("SELECT guid_format(123)")).IsNull());
+		TestTrue(TEXT("guid_format of NULL is NULL"), Scalar(TEXT("SELECT guid_format(NULL)")).IsNull());
+	}
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,123 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+#include "DbStatement.h"
+#include "PreparedStatementManager.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DbColumnarResultTest
+{
+	/* Heap memory held by a row based result: the rows, each row's fields, and each field's string, blob and name. */
+	SIZE_T GetAllocatedSize(const FQueryResult& Result)
+	{
+		SIZE_T Size = Result.Rows.GetAllocatedSize();
+		for (const FQueryResultRow& Row : Result.Rows)
+		{
+			Size += Row.Fields.GetAllocatedSize();
+			for (const FQueryResultField& Field : Row.Fields)
+				Size += Field.GetAllocatedSize();
+		}
+		return Size;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbColumnarResultTest, "System.Plugins.Database.SqliteGameDB.ColumnarResult", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbColumnarResultTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("ColumnarResult"));
+	UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+
+	/* Every sqlite type, including non-ASCII text, empty text and blobs, NULLs, and a column whose type differs by row. */
+	constexpr int32 NumRows = 1000;
+	Queries->RunTempActionQuery(FString::Printf(TEXT(
+		"CREATE TABLE Source AS "
+		"WITH RECURSIVE Seq(N) AS (SELECT 1 UNION ALL SELECT N + 1 FROM Seq WHERE N < %d) "
+		"SELECT N AS Id, 'Caf' || char(233) || ' ' || N AS Name, N * 0.25 AS Weight, "
+		"CASE WHEN N %% 3 = 0 THEN NULL WHEN N %% 3 = 1 THEN zeroblob(0) ELSE randomblob(N %% 17 + 1) END AS Data, "
+		"CASE N %% 5 WHEN 0 THEN N WHEN 1 THEN N / 3.0 WHEN 2 THEN 'Text ' || N WHEN 3 THEN '' ELSE NULL END AS Mixed "
+		"FROM Seq;"), NumRows));
+
+	UDbStatement* Statement = Queries->CreateStatement(TEXT("ColumnarResult"), TEXT("SELECT * FROM Source ORDER BY Id;"));
+	if (!TestNotNull(TEXT("Statement"), Statement))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	const FQueryResult Rows = Statement->ExecuteSelect();
+	const FColumnarQueryResult Columnar = Statement->ExecuteSelectColumnar();
+
+	TestEqual(TEXT("Row count"), Columnar.NumRows, Rows.Rows.Num());
+	TestEqual(TEXT("Expected row count"), Columnar.NumRows, NumRows);
+	if (!TestEqual(TEXT("Column count"), Columnar.Columns.Num(), Rows.Rows.Num() ? Rows.Rows[0].Fields.Num() : 0))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	int32 NumMismatches = 0;
+	TSet<EDbValueType> TypesSeen;
+	for (int32 RowIdx = 0; RowIdx < Rows.Rows.Num() && NumMismatches < 10; RowIdx++)
+	{
+		const TArray<FQueryResultField>& Fields = Rows.Rows[RowIdx].Fields;
+		for (int32 ColIdx = 0; ColIdx < Fields.Num(); ColIdx++)
+		{
+			const FQueryResultField& Field = Fields[ColIdx];
+			const FString Where = FString::Printf(TEXT("row %d, column %s"), RowIdx, *Field.ColName);
+			TypesSeen.Add(Field.GetType());
+
+			bool bMatches = Columnar.Columns[ColIdx].Name == Field.ColName
+				&& Columnar.GetType(RowIdx, ColIdx) == Field.GetType();
+			if (bMatches)
+			{
+				switch (Field.GetType())
+				{
+				case EDbValueType::Integer:
+					bMatches = Columnar.GetInteger(RowIdx, ColIdx) == Field.GetInteger();
+					break;
+				case EDbValueType::Float:
+					bMatches = Columnar.GetFloat(RowIdx, ColIdx) == Field.GetFloat();
+					break;
+				case EDbValueType::String:
+					bMatches = Columnar.GetString(RowIdx, ColIdx) == Field.GetString();
+					break;
+				case EDbValueType::Blob:
+					bMatches = TArray<uint8>(Columnar.GetBlob(RowIdx, ColIdx)) == Field.GetBlob();
+					break;
+				default:
+					break;
+				}
+			}
+
+			if (!bMatches)
+			{
+				AddError(FString::Printf(TEXT("Columnar value differs at %s: '%s' (type %d), expected '%s' (type %d)"), *Where,
+				                         *Columnar.GetField(RowIdx, ColIdx).ToString(), static_cast<int32>(Columnar.GetType(RowIdx, ColIdx)),
+				                         *Field.ToString(), static_cast<int32>(Field.GetType())));
+				NumMismatches++;
+			}
+		}
+	}
+	TestEqual(TEXT("Every sqlite type was compared"), TypesSeen.Num(), 5);
+
+	/* Converting back gives the row based result */
+	const FQueryResult Converted = Columnar.ToQueryResult();
+	TestEqual(TEXT("Converted names"), DbTest::GetColumnStrings(Converted, TEXT("Name")), DbTest::GetColumnStrings(Rows, TEXT("Name")));
+	TestEqual(TEXT("Converted mixed values"), DbTest::GetColumnStrings(Converted, TEXT("Mixed")), DbTest::GetColumnStrings(Rows, TEXT("Mixed")));
+
+	/* The point of the columnar form is its size, so report both */
+	const SIZE_T RowsSize = DbColumnarResultTest::GetAllocatedSize(Rows);
+	const SIZE_T ColumnarSize = Columnar.GetAllocatedSize();
+	AddInfo(FString::Printf(TEXT("%d rows: ExecuteSelect allocated %llu bytes, ExecuteSelectColumnar allocated %llu bytes"),
+	                        NumRows, static_cast<uint64>(RowsSize), static_cast<uint64>(ColumnarSize)));
+	TestTrue(TEXT("Columnar result is smaller"), ColumnarSize < RowsSize);
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
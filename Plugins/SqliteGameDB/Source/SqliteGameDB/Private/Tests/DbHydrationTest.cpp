@@ -0,0 +1,119 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DbStatement.h"
+#include "DbHydrationPlan.h"
+#include "PreparedStatementManager.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbHydrationTest, "System.Plugins.Database.SqliteGameDB.Hydration", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbHydrationTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("Hydration"));
+	UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+	const UClass* ObjectClass = UDbTestSaveGameObject::StaticClass();
+
+	Queries->RunTempActionQuery(TEXT(
+		"CREATE TABLE Hydration (Id INTEGER PRIMARY KEY, Tag TEXT, Title TEXT, Code INTEGER, bFlag INTEGER, Size INTEGER, NotSaved INTEGER);"));
+	Queries->RunTempActionQuery(TEXT(
+		"INSERT INTO Hydration VALUES (1, 'Sword', 'Iron Sword', 4711, 1, 100000, 99), (2, 'Shield', 'Oak Shield', 42, 0, 1, 99);"));
+
+	UDbStatement* ById = Queries->CreateStatement(TEXT("HydrateById"), TEXT(
+		"SELECT Id, Tag, Title, Code, bFlag, Size, NotSaved FROM Hydration WHERE Id = @Id;"));
+	UDbStatement* Reordered = Queries->CreateStatement(TEXT("HydrateReordered"), TEXT(
+		"SELECT Size, bFlag, Code, Title, Tag, Id FROM Hydration WHERE Id = @Id;"));
+	UDbStatement* All = Queries->CreateStatement(TEXT("HydrateAll"), TEXT("SELECT * FROM Hydration ORDER BY Id;"));
+	if (!TestNotNull(TEXT("By id statement"), ById)
+		|| !TestNotNull(TEXT("Reordered statement"), Reordered)
+		|| !TestNotNull(TEXT("All statement"), All))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	auto Hydrate = [](UDbStatement* Statement, const int32 Id)
+	{
+		Statement->SetBindingValue(TEXT("@Id"), Id);
+		return Statement->CreateObjectFromData<UDbTestSaveGameObject>();
+	};
+
+	auto TestRow = [this](const FString& What, const UDbTestSaveGameObject* Object, const int32 Id, const TCHAR* Tag,
+	                      const TCHAR* Title, const TCHAR* Code, const bool bFlag, const EDbTestWideEnum Size)
+	{
+		if (!TestNotNull(What, Object))
+			return;
+		TestEqual(What + TEXT(": Id"), Object->Id, Id);
+		TestEqual(What + TEXT(": FName"), Object->Tag, FName(Tag));
+		TestEqual(What + TEXT(": FText"), Object->Title.ToString(), FString(Title));
+		TestEqual(What + TEXT(": integer column into an FString"), Object->Code, FString(Code));
+		TestEqual(What + TEXT(": bitfield bool"), (bool)Object->bFlag, bFlag);
+		TestTrue(What + TEXT(": neighbouring bitfield bool is untouched"), (bool)Object->bOtherFlag);
+		TestEqual(What + TEXT(": wide enum"), static_cast<int32>(Object->Size), static_cast<int32>(Size));
+		TestEqual(What + TEXT(": non-SaveGame property is untouched"), Object->NotSaved, -1);
+	};
+
+	/* The same statement hydrates twice, building its plan once and reusing it */
+	TestRow(TEXT("First hydration"), Hydrate(ById, 1), 1, TEXT("Sword"), TEXT("Iron Sword"), TEXT("4711"), true, EDbTestWideEnum::Large);
+	const TSharedPtr<const FDbHydrationPlan> ByIdPlan = ById->FindHydrationPlan(ObjectClass);
+	if (!TestTrue(TEXT("Plan is cached"), ByIdPlan.IsValid()))
+	{
+		TestDb->Close();
+		return false;
+	}
+	TestEqual(TEXT("Plan binds every SaveGame property with a column"), ByIdPlan->Bindings.Num(), 6);
+
+	TestRow(TEXT("Second hydration"), Hydrate(ById, 2), 2, TEXT("Shield"), TEXT("Oak Shield"), TEXT("42"), false, EDbTestWideEnum::Small);
+	TestTrue(TEXT("Plan is reused"), ById->FindHydrationPlan(ObjectClass) == ByIdPlan);
+
+	TestNull(TEXT("No row, no object"), Hydrate(ById, 3));
+	TestTrue(TEXT("Plan is kept when there is no row"), ById->FindHydrationPlan(ObjectClass) == ByIdPlan);
+
+	/* A statement with the same columns in another order gets its own plan */
+	TestRow(TEXT("Reordered hydration"), Hydrate(Reordered, 1), 1, TEXT("Sword"), TEXT("Iron Sword"), TEXT("4711"), true, EDbTestWideEnum::Large);
+	const TSharedPtr<const FDbHydrationPlan> ReorderedPlan = Reordered->FindHydrationPlan(ObjectClass);
+	TestTrue(TEXT("Reordered plan is cached"), ReorderedPlan.IsValid());
+	TestFalse(TEXT("Reordered plan is not the first plan"), ReorderedPlan == ByIdPlan);
+	TestRow(TEXT("First statement after the reordered one"), Hydrate(ById, 2), 2, TEXT("Shield"), TEXT("Oak Shield"), TEXT("42"), false, EDbTestWideEnum::Small);
+
+	/* Arrays are hydrated through the same plans */
+	{
+		TArray<UDbTestSaveGameObject*> Objects;
+		All->CreateObjectArrayFromData(&Objects);
+		if (TestEqual(TEXT("Array hydration row count"), Objects.Num(), 2))
+		{
+			TestRow(TEXT("Array first row"), Objects[0], 1, TEXT("Sword"), TEXT("Iron Sword"), TEXT("4711"), true, EDbTestWideEnum::Large);
+			TestRow(TEXT("Array second row"), Objects[1], 2, TEXT("Shield"), TEXT("Oak Shield"), TEXT("42"), false, EDbTestWideEnum::Small);
+		}
+	}
+	const TSharedPtr<const FDbHydrationPlan> AllPlan = All->FindHydrationPlan(ObjectClass);
+	TestTrue(TEXT("Array plan is shared with the statement with the same columns"), AllPlan == ByIdPlan);
+
+	/* SQLite re-prepares after a schema change, so a SELECT * picks up new columns, and needs a new plan */
+	{
+		Queries->RunTempActionQuery(TEXT("ALTER TABLE Hydration ADD COLUMN Extra INTEGER DEFAULT 0;"));
+
+		TArray<UDbTestSaveGameObject*> Objects;
+		All->CreateObjectArrayFromData(&Objects);
+		if (TestEqual(TEXT("Row count after ALTER TABLE"), Objects.Num(), 2))
+			TestRow(TEXT("First row after ALTER TABLE"), Objects[0], 1, TEXT("Sword"), TEXT("Iron Sword"), TEXT("4711"), true, EDbTestWideEnum::Large);
+
+		const TSharedPtr<const FDbHydrationPlan> AlteredPlan = All->FindHydrationPlan(ObjectClass);
+		TestTrue(TEXT("Plan after ALTER TABLE is cached"), AlteredPlan.IsValid());
+		TestFalse(TEXT("Plan is rebuilt after ALTER TABLE"), AlteredPlan == AllPlan);
+	}
+
+	/* Flushing the cache (as reinstancing a class does) rebuilds every statement's plans */
+	{
+		FDbHydrationPlan::FlushCache();
+		TestRow(TEXT("Hydration after a flush"), Hydrate(ById, 1), 1, TEXT("Sword"), TEXT("Iron Sword"), TEXT("4711"), true, EDbTestWideEnum::Large);
+		TestFalse(TEXT("Plan is rebuilt after a flush"), ById->FindHydrationPlan(ObjectClass) == ByIdPlan);
+	}
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
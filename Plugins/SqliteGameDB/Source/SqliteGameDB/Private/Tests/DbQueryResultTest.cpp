@@ -0,0 +1,119 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DbQueryResultTest
+{
+	/* The layout FQueryResultField had before its value moved into a variant (one member per type),
+	 * kept here only so the benchmark below can measure the difference. */
+	struct FLegacyQueryResultField
+	{
+		bool BoolVal = false;
+		int64 IntVal = 0;
+		double DblVal = 0.0;
+		FString StrVal;
+		TArray<uint8> BlobVal;
+		EDbValueType Type = EDbValueType::Null;
+		FString ColName;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbQueryResultFieldTest, "System.Plugins.Database.SqliteGameDB.QueryResultField", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbQueryResultFieldTest::RunTest(const FString& Parameters)
+{
+	/* Values and conversions */
+	{
+		const FQueryResultField NullField;
+		TestTrue(TEXT("Default field is NULL"), NullField.IsNull());
+		TestEqual(TEXT("NULL field type"), NullField.GetType(), EDbValueType::Null);
+		TestEqual(TEXT("NULL field integer"), NullField.GetInteger(), (int64)0);
+		TestTrue(TEXT("NULL field string"), NullField.GetString().IsEmpty());
+
+		const FQueryResultField IntField = FQueryResultField::MakeInteger(42);
+		TestEqual(TEXT("Integer field type"), IntField.GetType(), EDbValueType::Integer);
+		TestEqual(TEXT("Integer field value"), IntField.GetInteger(), (int64)42);
+		TestEqual(TEXT("Integer field as float"), IntField.GetFloat(), 42.0);
+		TestTrue(TEXT("Integer field as bool"), IntField.GetBool());
+		TestTrue(TEXT("Integer field has no string"), IntField.GetString().IsEmpty());
+
+		const FQueryResultField FloatField = FQueryResultField::MakeFloat(2.75);
+		TestEqual(TEXT("Float field type"), FloatField.GetType(), EDbValueType::Float);
+		TestEqual(TEXT("Float field value"), FloatField.GetFloat(), 2.75);
+		TestEqual(TEXT("Float field as integer"), FloatField.GetInteger(), (int64)2);
+
+		FString Text = TEXT("Moved into the field");
+		const FQueryResultField StringField = FQueryResultField::MakeString(MoveTemp(Text));
+		TestEqual(TEXT("String field type"), StringField.GetType(), EDbValueType::String);
+		TestEqual(TEXT("String field value"), StringField.GetString(), FString(TEXT("Moved into the field")));
+		TestTrue(TEXT("String was moved, not copied"), Text.IsEmpty());
+
+		const FQueryResultField BlobField = FQueryResultField::MakeBlob({ 1, 2, 3 });
+		TestEqual(TEXT("Blob field type"), BlobField.GetType(), EDbValueType::Blob);
+		TestEqual(TEXT("Blob field value"), BlobField.GetBlob().Num(), 3);
+		TestEqual(TEXT("Blob field as integer"), BlobField.GetInteger(), (int64)0);
+
+		FQueryResultField Copy = StringField;
+		TestEqual(TEXT("Copied field value"), Copy.GetString(), StringField.GetString());
+		Copy = IntField;
+		TestEqual(TEXT("Reassigned field type"), Copy.GetType(), EDbValueType::Integer);
+	}
+
+	/* Memory benchmark: a typical result set of mostly numeric cells */
+	{
+		using DbQueryResultTest::FLegacyQueryResultField;
+
+		constexpr int32 NumRows = 5000;
+		constexpr int32 NumColumns = 4;
+
+		TArray<FQueryResultField> Fields;
+		TArray<FLegacyQueryResultField> LegacyFields;
+		Fields.Reserve(NumRows * NumColumns);
+		LegacyFields.Reserve(NumRows * NumColumns);
+
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			Fields.Add(FQueryResultField::MakeInteger(Row));
+			Fields.Add(FQueryResultField::MakeFloat(Row * 0.5));
+			Fields.Add(FQueryResultField::MakeString(FString::Printf(TEXT("Row %d"), Row)));
+			Fields.Add(FQueryResultField());
+
+			FLegacyQueryResultField& LegacyInt = LegacyFields.AddDefaulted_GetRef();
+			LegacyInt.IntVal = Row;
+			LegacyInt.Type = EDbValueType::Integer;
+			FLegacyQueryResultField& LegacyFloat = LegacyFields.AddDefaulted_GetRef();
+			LegacyFloat.DblVal = Row * 0.5;
+			LegacyFloat.Type = EDbValueType::Float;
+			FLegacyQueryResultField& LegacyString = LegacyFields.AddDefaulted_GetRef();
+			LegacyString.StrVal = FString::Printf(TEXT("Row %d"), Row);
+			LegacyString.Type = EDbValueType::String;
+			LegacyFields.AddDefaulted();
+		}
+
+		SIZE_T Bytes = Fields.GetAllocatedSize();
+		for (const FQueryResultField& Field : Fields)
+		{
+			Bytes += Field.GetAllocatedSize();
+		}
+
+		SIZE_T LegacyBytes = LegacyFields.GetAllocatedSize();
+		for (const FLegacyQueryResultField& Field : LegacyFields)
+		{
+			LegacyBytes += Field.StrVal.GetAllocatedSize() + Field.BlobVal.GetAllocatedSize() + Field.ColName.GetAllocatedSize();
+		}
+
+		AddInfo(FString::Printf(TEXT("FQueryResultField: %d bytes per field (was %d), %llu bytes for %d fields (was %llu)"),
+			(int32)sizeof(FQueryResultField), (int32)sizeof(FLegacyQueryResultField),
+			(uint64)Bytes, Fields.Num(), (uint64)LegacyBytes));
+
+		TestTrue(TEXT("Field is smaller than one member per type"), sizeof(FQueryResultField) < sizeof(FLegacyQueryResultField));
+		TestTrue(TEXT("Result set uses less memory"), Bytes < LegacyBytes);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,93 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+#include "DbStatement.h"
+#include "PreparedStatementManager.h"
+#include "SQLiteDatabase.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbScalarQueryTest, "System.Plugins.Database.SqliteGameDB.ScalarQuery", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbScalarQueryTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("ScalarQuery"));
+	UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+
+	/* count_row(N) returns N, counting each row it is called for, so the tests can see how many rows were stepped to. */
+	int32 NumRowsStepped = 0;
+	TestDb->GetSqliteDb()->RegisterScalarFunction<int64, int64>(TEXT("count_row"), [&NumRowsStepped](const int64 Value)
+	{
+		NumRowsStepped++;
+		return Value;
+	}, ESQLiteFunctionFlags::None);
+
+	UDbStatement* NoRows = Queries->CreateStatement(TEXT("NoRows"), TEXT("SELECT 42, 'Text' WHERE 0;"));
+	UDbStatement* NullFirst = Queries->CreateStatement(TEXT("NullFirst"), TEXT("SELECT NULL, 42, 'Text';"));
+	UDbStatement* ManyRows = Queries->CreateStatement(TEXT("ManyRows"), TEXT(
+		"WITH RECURSIVE Seq(N) AS (SELECT @Start UNION ALL SELECT N + 1 FROM Seq WHERE N < @Start + 999) "
+		"SELECT count_row(N), 'Row ' || N FROM Seq;"));
+	if (!TestNotNull(TEXT("No rows statement"), NoRows)
+		|| !TestNotNull(TEXT("NULL first column statement"), NullFirst)
+		|| !TestNotNull(TEXT("Many rows statement"), ManyRows))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	/* No rows: the default is returned */
+	{
+		TestEqual(TEXT("Int64 default with no rows"), NoRows->ExecuteScalarInt64(), (int64)0);
+		TestEqual(TEXT("Int64 given default with no rows"), NoRows->ExecuteScalarInt64(-1), (int64)-1);
+		TestEqual(TEXT("String default with no rows"), NoRows->ExecuteScalarString(), FString());
+		TestEqual(TEXT("String given default with no rows"), NoRows->ExecuteScalarString(TEXT("None")), FString(TEXT("None")));
+		TestFalse(TEXT("Exists with no rows"), NoRows->ExecuteExists());
+	}
+
+	/* A NULL first column: the default is returned, but the row still exists */
+	{
+		TestEqual(TEXT("Int64 given default for NULL"), NullFirst->ExecuteScalarInt64(-1), (int64)-1);
+		TestEqual(TEXT("String given default for NULL"), NullFirst->ExecuteScalarString(TEXT("None")), FString(TEXT("None")));
+		TestTrue(TEXT("Exists with a NULL first column"), NullFirst->ExecuteExists());
+	}
+
+	/* Many rows: only the first row is stepped to, and the statement is reset so it can be run again */
+	{
+		TestTrue(TEXT("Bind the first start"), ManyRows->SetBindingValue(TEXT("@Start"), 1));
+
+		NumRowsStepped = 0;
+		TestEqual(TEXT("Int64 reads the first row"), ManyRows->ExecuteScalarInt64(-1), (int64)1);
+		TestEqual(TEXT("Int64 steps one row"), NumRowsStepped, 1);
+
+		NumRowsStepped = 0;
+		TestEqual(TEXT("Int64 reads the first row when rerun"), ManyRows->ExecuteScalarInt64(-1), (int64)1);
+		TestEqual(TEXT("Int64 steps one row when rerun"), NumRowsStepped, 1);
+
+		NumRowsStepped = 0;
+		TestEqual(TEXT("String reads the first row"), ManyRows->ExecuteScalarString(), FString(TEXT("1")));
+		TestEqual(TEXT("String steps one row"), NumRowsStepped, 1);
+
+		NumRowsStepped = 0;
+		TestTrue(TEXT("Exists with many rows"), ManyRows->ExecuteExists());
+		TestEqual(TEXT("Exists steps one row"), NumRowsStepped, 1);
+
+		/* sqlite refuses new bindings while a statement is still running, so this also shows it was reset. */
+		TestTrue(TEXT("Bind a new start after running"), ManyRows->SetBindingValue(TEXT("@Start"), 500));
+
+		NumRowsStepped = 0;
+		TestEqual(TEXT("Int64 reads the new first row"), ManyRows->ExecuteScalarInt64(-1), (int64)500);
+		TestEqual(TEXT("String reads the new first row"), ManyRows->ExecuteScalarString(), FString(TEXT("500")));
+		TestTrue(TEXT("Exists with the new start"), ManyRows->ExecuteExists());
+		TestEqual(TEXT("Each run steps one row"), NumRowsStepped, 3);
+
+		/* The whole resultset is still there for a full select */
+		TestEqual(TEXT("Select after the scalar runs"), ManyRows->ExecuteSelect().Rows.Num(), 1000);
+	}
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,92 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+#include "DbStatement.h"
+#include "PreparedStatementManager.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbSpatialIndexTest, "System.Plugins.Database.SqliteGameDB.SpatialIndex", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbSpatialIndexTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("SpatialIndex"));
+	UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+
+	/* The table and column names hold quotes and spaces, so every identifier must be quoted properly. */
+	const FString TableName = TEXT("Spawn \"Points\"");
+	const FString ColumnPrefix = TEXT("Pos\"");
+	Queries->RunTempActionQuery(TEXT(
+		"CREATE TABLE \"Spawn \"\"Points\"\"\" (Name TEXT, \"Pos\"\"X\" REAL, \"Pos\"\"Y\" REAL, \"Pos\"\"Z\" REAL);"));
+	Queries->RunTempActionQuery(TEXT(
+		"INSERT INTO \"Spawn \"\"Points\"\"\" VALUES "
+		"('A', 0, 0, 0), ('B', 10, 0, 0), ('C', 0, 20, 0), ('D', 100, 100, 100), ('E', NULL, 0, 0);"));
+
+	const FString CountIndexSql = TEXT("SELECT count(*) FROM \"Spawn \"\"Points\"\"_Pos\"\"_rtree\"");
+
+	/* Index creation fills the index from the existing rows, skipping any with a NULL coordinate */
+	TestTrue(TEXT("Index created"), Queries->CreateSpatialIndex(TableName, ColumnPrefix));
+	TestEqual(TEXT("Existing rows indexed"), Queries->RunTempScalarQuery(CountIndexSql).GetInteger(), (int64)4);
+	TestTrue(TEXT("Creating the index again succeeds"), Queries->CreateSpatialIndex(TableName, ColumnPrefix));
+
+	UDbStatement* BoxStatement = Queries->CreateSpatialBoxStatement(TEXT("SpatialBox"), TableName, ColumnPrefix);
+	UDbStatement* RadiusStatement = Queries->CreateSpatialRadiusStatement(TEXT("SpatialRadius"), TableName, ColumnPrefix);
+	if (!TestNotNull(TEXT("Box statement"), BoxStatement) || !TestNotNull(TEXT("Radius statement"), RadiusStatement))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	const FBox NearOrigin(FVector(-1.0, -1.0, -1.0), FVector(11.0, 1.0, 1.0));
+	auto NamesInBox = [BoxStatement, &NearOrigin]()
+	{
+		TArray<FString> Names = DbTest::GetColumnStrings(BoxStatement->ExecuteSelectInBox(NearOrigin), TEXT("Name"));
+		Names.Sort();
+		return Names;
+	};
+
+	/* Box queries, including a point on the edge of the box */
+	TestEqual(TEXT("Box query"), NamesInBox(), TArray<FString>({ TEXT("A"), TEXT("B") }));
+
+	/* Triggers keep the index up to date as rows are inserted, moved and deleted */
+	Queries->RunTempActionQuery(TEXT("INSERT INTO \"Spawn \"\"Points\"\"\" VALUES ('F', 5, 0, 0);"));
+	TestEqual(TEXT("Box query after insert"), NamesInBox(), TArray<FString>({ TEXT("A"), TEXT("B"), TEXT("F") }));
+
+	Queries->RunTempActionQuery(TEXT("UPDATE \"Spawn \"\"Points\"\"\" SET \"Pos\"\"X\" = 50 WHERE Name = 'B';"));
+	TestEqual(TEXT("Box query after moving a row out"), NamesInBox(), TArray<FString>({ TEXT("A"), TEXT("F") }));
+
+	Queries->RunTempActionQuery(TEXT("UPDATE \"Spawn \"\"Points\"\"\" SET \"Pos\"\"X\" = 1 WHERE Name = 'E';"));
+	TestEqual(TEXT("Box query after giving a row a location"), NamesInBox(), TArray<FString>({ TEXT("A"), TEXT("E"), TEXT("F") }));
+
+	Queries->RunTempActionQuery(TEXT("DELETE FROM \"Spawn \"\"Points\"\"\" WHERE Name = 'A';"));
+	TestEqual(TEXT("Box query after delete"), NamesInBox(), TArray<FString>({ TEXT("E"), TEXT("F") }));
+	TestEqual(TEXT("Index follows the table"), Queries->RunTempScalarQuery(CountIndexSql).GetInteger(), (int64)5);
+
+	/* Radius queries return the rows within the radius, nearest first, with their distance */
+	const FQueryResult InRadius = RadiusStatement->ExecuteSelectInRadius(FVector::ZeroVector, 25.0);
+	TestEqual(TEXT("Radius query"), DbTest::GetColumnStrings(InRadius, TEXT("Name")),
+	          TArray<FString>({ TEXT("E"), TEXT("F"), TEXT("C") }));
+	TestEqual(TEXT("Radius query distance"), DbTest::GetColumnStrings(InRadius, TEXT("SpatialDistance")),
+	          TArray<FString>({ FString::Printf(TEXT("%f"), 1.0), FString::Printf(TEXT("%f"), 5.0), FString::Printf(TEXT("%f"), 20.0) }));
+
+	/* Nearest queries widen the search until enough rows are found */
+	TestEqual(TEXT("Nearest query"),
+	          DbTest::GetColumnStrings(RadiusStatement->ExecuteSelectNearest(FVector::ZeroVector, 3, 1.0), TEXT("Name")),
+	          TArray<FString>({ TEXT("E"), TEXT("F"), TEXT("C") }));
+	TestEqual(TEXT("Nearest query stops at the maximum radius"),
+	          DbTest::GetColumnStrings(RadiusStatement->ExecuteSelectNearest(FVector::ZeroVector, 10, 1.0, 100.0), TEXT("Name")),
+	          TArray<FString>({ TEXT("E"), TEXT("F"), TEXT("C"), TEXT("B") }));
+
+	/* Dropping the index removes its table and triggers */
+	TestTrue(TEXT("Index dropped"), Queries->DropSpatialIndex(TableName, ColumnPrefix));
+	TestEqual(TEXT("Index table and triggers removed"),
+	          Queries->RunTempScalarQuery(TEXT("SELECT count(*) FROM sqlite_master WHERE name LIKE 'Spawn \"Points\"_Pos\"_rtree%';")).GetInteger(),
+	          (int64)0);
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,113 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DbBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "DbTestTypes.generated.h"
+
+namespace DbTest
+{
+	/* The values of the named column in each row of a result, as strings, in row order. */
+	inline TArray<FString> GetColumnStrings(const FQueryResult& Result, const FString& ColumnName)
+	{
+		TArray<FString> Values;
+		for (const FQueryResultRow& Row : Result.Rows)
+		{
+			const FQueryResultField* Field = Row.Fields.FindByPredicate([&ColumnName](const FQueryResultField& Candidate)
+			{
+				return Candidate.ColName == ColumnName;
+			});
+			Values.Add(Field ? Field->ToString() : FString());
+		}
+		return Values;
+	}
+}
+
+/* An enum wider than a byte, as enum class properties may have any size of underlying type. */
+UENUM()
+enum class EDbTestWideEnum : int32
+{
+	None  = 0,
+	Small = 1,
+	Large = 100000
+};
+
+/* An object filled from a resultset by the hydration tests, with a SaveGame property of each awkward kind. */
+UCLASS(NotBlueprintable, Transient)
+class UDbTestSaveGameObject : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UDbTestSaveGameObject()
+		: bFlag(false), bOtherFlag(true)
+	{
+	}
+
+	UPROPERTY(SaveGame)
+	int32 Id = 0;
+
+	UPROPERTY(SaveGame)
+	FName Tag;
+
+	UPROPERTY(SaveGame)
+	FText Title;
+
+	/* Read from an integer column. */
+	UPROPERTY(SaveGame)
+	FString Code;
+
+	/* Bitfield bools share a byte, so setting one must leave its neighbour alone. */
+	UPROPERTY(SaveGame)
+	uint8 bFlag : 1;
+
+	UPROPERTY(SaveGame)
+	uint8 bOtherFlag : 1;
+
+	UPROPERTY(SaveGame)
+	EDbTestWideEnum Size = EDbTestWideEnum::None;
+
+	/* Not SaveGame, so never filled, even with a matching column. */
+	UPROPERTY()
+	int32 NotSaved = -1;
+};
+
+/* A concrete game database for the automation tests, exposing the connection and query manager the tests drive. */
+UCLASS(NotBlueprintable, Transient)
+class UDbTestDb : public UDbBase
+{
+	GENERATED_BODY()
+
+public:
+	/* Opens an empty database held in memory, named after the test so concurrent tests never share a file. */
+	static UDbTestDb* CreateInMemory(const FString& TestName)
+	{
+		/* Initialize requires the file to exist; an empty file is an empty database. */
+		const FString Path = FPaths::ConvertRelativePathToFull(
+			FPaths::AutomationTransientDir() / TEXT("SqliteGameDBTests") / TestName + TEXT(".db"));
+		FFileHelper::SaveStringToFile(FString(), *Path);
+
+		FGameDbConfig Config;
+		Config.bLoadIntoMemory = true;
+
+		UDbTestDb* TestDb = NewObject<UDbTestDb>();
+		TestDb->Initialize(Path, Config);
+
+		/* The in-memory copy doesn't need the file any more. */
+		IFileManager::Get().Delete(*Path);
+		return TestDb;
+	}
+
+	/* Closes the connection now, rather than waiting for garbage collection. */
+	void Close()
+	{
+		ConditionalBeginDestroy();
+	}
+
+	UPreparedStatementManager* GetQueryManager() const { return QueryManager; }
+	FSQLiteDatabase* GetSqliteDb() const { return SqliteDb; }
+};
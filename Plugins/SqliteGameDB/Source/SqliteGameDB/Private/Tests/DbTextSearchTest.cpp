@@ -0,0 +1,114 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "DBSupport.h"
+#include "DbStatement.h"
+#include "PreparedStatementManager.h"
+#include "DbTestTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbTextSearchQueryTest, "System.Plugins.Database.SqliteGameDB.TextSearch.Query", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbTextSearchQueryTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Each word is a prefix"), UDbStatement::MakeTextSearchQuery(TEXT("iron swo")), FString(TEXT("\"iron\"* \"swo\"*")));
+	TestEqual(TEXT("Extra whitespace is ignored"), UDbStatement::MakeTextSearchQuery(TEXT("  iron \t swo ")), FString(TEXT("\"iron\"* \"swo\"*")));
+	TestEqual(TEXT("Quotes are escaped"), UDbStatement::MakeTextSearchQuery(TEXT("say \"hi\"")), FString(TEXT("\"say\"* \"\"\"hi\"\"\"*")));
+	TestEqual(TEXT("FTS5 syntax is quoted"), UDbStatement::MakeTextSearchQuery(TEXT("NOT col:x*")), FString(TEXT("\"NOT\"* \"col:x*\"*")));
+	TestTrue(TEXT("Blank text is an empty query"), UDbStatement::MakeTextSearchQuery(TEXT(" \t ")).IsEmpty());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDbTextSearchIndexTest, "System.Plugins.Database.SqliteGameDB.TextSearch.Index", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FDbTextSearchIndexTest::RunTest(const FString& Parameters)
+{
+	UDbTestDb* TestDb = UDbTestDb::CreateInMemory(TEXT("TextSearchIndex"));
+	UPreparedStatementManager* Queries = TestDb->GetQueryManager();
+
+	/* The table and column names hold quotes and spaces, so every identifier must be quoted properly. */
+	const FString TableName = TEXT("Item \"List\"");
+	const TArray<FString> ColumnNames = { TEXT("Name"), TEXT("Desc\"ription") };
+	Queries->RunTempActionQuery(TEXT("CREATE TABLE \"Item \"\"List\"\"\" (Id INTEGER PRIMARY KEY, Name TEXT, \"Desc\"\"ription\" TEXT);"));
+	Queries->RunTempActionQuery(TEXT(
+		"INSERT INTO \"Item \"\"List\"\"\" (Name, \"Desc\"\"ription\") VALUES "
+		"('Iron Sword', 'A sturdy blade'), ('Iron Shield', 'Blocks arrows'), "
+		"('Wooden Sword', 'A training blade'), ('Steel Axe', 'Heavy and iron bound');"));
+
+	TestTrue(TEXT("Index created"), Queries->CreateTextIndex(TableName, ColumnNames));
+	TestTrue(TEXT("Creating the index again succeeds"), Queries->CreateTextIndex(TableName, ColumnNames));
+
+	UDbStatement* SearchStatement = Queries->CreateTextSearchStatement(TEXT("TextSearch"), TableName);
+	if (!TestNotNull(TEXT("Search statement"), SearchStatement))
+	{
+		TestDb->Close();
+		return false;
+	}
+
+	auto Search = [SearchStatement](const FString& Query)
+	{
+		FDbTextSearchPage Page;
+		TArray<FString> Names = DbTest::GetColumnStrings(SearchStatement->ExecuteTextSearch(Query, Page, 100), TEXT("Name"));
+		Names.Sort();
+		return Names;
+	};
+
+	/* The index is filled from the existing rows, across every indexed column */
+	TestEqual(TEXT("Search existing rows"), Search(TEXT("iron")), TArray<FString>({ TEXT("Iron Shield"), TEXT("Iron Sword"), TEXT("Steel Axe") }));
+	TestEqual(TEXT("Search by prefix"), Search(TEXT("iron swo")), TArray<FString>({ TEXT("Iron Sword") }));
+
+	FDbTextSearchPage SnippetPage;
+	const TArray<FString> Snippets = DbTest::GetColumnStrings(SearchStatement->ExecuteTextSearch(TEXT("iron swo"), SnippetPage), TEXT("SearchSnippet"));
+	TestEqual(TEXT("Snippet highlights the matches"), Snippets, TArray<FString>({ TEXT("<Highlight>Iron</> <Highlight>Sword</>") }));
+
+	/* Triggers keep the index up to date as rows are inserted, edited and deleted */
+	Queries->RunTempActionQuery(TEXT("INSERT INTO \"Item \"\"List\"\"\" (Name, \"Desc\"\"ription\") VALUES ('Iron Helm', 'Protects the head');"));
+	TestEqual(TEXT("Search after insert"), Search(TEXT("iron")),
+	          TArray<FString>({ TEXT("Iron Helm"), TEXT("Iron Shield"), TEXT("Iron Sword"), TEXT("Steel Axe") }));
+
+	Queries->RunTempActionQuery(TEXT("UPDATE \"Item \"\"List\"\"\" SET Name = 'Training Replica' WHERE Name = 'Wooden Sword';"));
+	TestEqual(TEXT("Old text is removed on update"), Search(TEXT("wooden")), TArray<FString>());
+	TestEqual(TEXT("New text is added on update"), Search(TEXT("replica")), TArray<FString>({ TEXT("Training Replica") }));
+
+	Queries->RunTempActionQuery(TEXT("DELETE FROM \"Item \"\"List\"\"\" WHERE Name = 'Iron Shield';"));
+	TestEqual(TEXT("Search after delete"), Search(TEXT("shield")), TArray<FString>());
+	TestEqual(TEXT("Other rows remain after delete"), Search(TEXT("iron")),
+	          TArray<FString>({ TEXT("Iron Helm"), TEXT("Iron Sword"), TEXT("Steel Axe") }));
+
+	/* Keyset paging returns every match exactly once, in the same order as a single page */
+	for (int32 Index = 0; Index < 5; ++Index)
+	{
+		Queries->RunTempActionQuery(FString::Printf(
+			TEXT("INSERT INTO \"Item \"\"List\"\"\" (Name, \"Desc\"\"ription\") VALUES ('Spare Sword %d', 'Spare blade');"), Index));
+	}
+
+	FDbTextSearchPage AllPage;
+	const TArray<FString> AllRowIds = DbTest::GetColumnStrings(SearchStatement->ExecuteTextSearch(TEXT("blade"), AllPage, 100), TEXT("SearchRowId"));
+	TestEqual(TEXT("Matches to page through"), AllRowIds.Num(), 7);
+	TestTrue(TEXT("A short page is the last page"), AllPage.bFinished);
+
+	FDbTextSearchPage Page;
+	TArray<FString> PagedRowIds;
+	int32 NumPages = 0;
+	while (!Page.bFinished && NumPages < 10)
+	{
+		const FQueryResult PageResult = SearchStatement->ExecuteTextSearch(TEXT("blade"), Page, 3);
+		TestTrue(TEXT("Page size is respected"), PageResult.Rows.Num() <= 3);
+		PagedRowIds.Append(DbTest::GetColumnStrings(PageResult, TEXT("SearchRowId")));
+		++NumPages;
+	}
+	TestEqual(TEXT("Number of pages"), NumPages, 3);
+	TestEqual(TEXT("Pages hold every match once, in order"), PagedRowIds, AllRowIds);
+	TestEqual(TEXT("A finished search returns nothing more"), SearchStatement->ExecuteTextSearch(TEXT("blade"), Page, 3).Rows.Num(), 0);
+
+	/* Dropping the index removes its tables and triggers */
+	TestTrue(TEXT("Index dropped"), Queries->DropTextIndex(TableName));
+	TestEqual(TEXT("Index tables and triggers removed"),
+	          Queries->RunTempScalarQuery(TEXT("SELECT count(*) FROM sqlite_master WHERE name LIKE 'Item \"List\"_fts%';")).GetInteger(),
+	          (int64)0);
+
+	TestDb->Close();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
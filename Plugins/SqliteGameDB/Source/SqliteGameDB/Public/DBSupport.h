@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Misc/TVariant.h"
 #include "DBSupport.generated.h"
 
 /* The kinds of data sqlite will return. */
@@ -17,38 +18,30 @@ enum class EDbValueType : uint8
 	Null
 };
 
-/* A single field of data returned from a query. */
+/* A single field of data returned from a query.
+ * The value is held in a tagged union, so a field only takes the space of its largest representation,
+ * rather than one of each. In Blueprint, read it with the 'Field' functions of UGameDatabaseStatics. */
 USTRUCT(BlueprintType)
-struct FQueryResultField
+struct SQLITEGAMEDB_API FQueryResultField
 {
 	GENERATED_BODY()
 
-	/* Overloaded constructors for each type of data we want to store. */
-	FQueryResultField()	{}		/* DB NULL */
-	FQueryResultField(int64 Value) { IntVal = Value; BoolVal = IntVal != 0; Type = EDbValueType::Integer;}
-	FQueryResultField(double Value)	{ DblVal = Value; Type = EDbValueType::Float;}
-	FQueryResultField(FString Value) { StrVal = Value; Type = EDbValueType::String;}
-	FQueryResultField(TArray<uint8> Value) { BlobVal = Value; Type = EDbValueType::Blob;}
+	/* Overloaded constructors for each type of data we want to store.
+	 * Strings and blobs passed as temporaries are moved in, rather than copied. */
+	FQueryResultField() {}		/* DB NULL */
+	FQueryResultField(const int64 InValue) : Value(TInPlaceType<int64>(), InValue) {}
+	FQueryResultField(const double InValue) : Value(TInPlaceType<double>(), InValue) {}
+	FQueryResultField(const FString& InValue) : Value(TInPlaceType<FString>(), InValue) {}
+	FQueryResultField(FString&& InValue) : Value(TInPlaceType<FString>(), MoveTemp(InValue)) {}
+	FQueryResultField(const TArray<uint8>& InValue) : Value(TInPlaceType<TArray<uint8>>(), InValue) {}
+	FQueryResultField(TArray<uint8>&& InValue) : Value(TInPlaceType<TArray<uint8>>(), MoveTemp(InValue)) {}
 
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="Bool Value"))
-	bool BoolVal = false;		/* INT value */
-	
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="Integer Value"))
-	int64 IntVal = 0;			/* INT value */
-	
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="Float Value"))
-	double DblVal = 0.0f;		/* FLOAT value */
-	
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="String Value"))
-	FString StrVal = TEXT("");	/* STRING value */
-	
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="Blob Value"))
-	TArray<uint8> BlobVal;		/* BINARY ARRAY (BLOB) value */
+	/* Factories for each type of data, moving the string or blob in.
+	 * Pass a temporary (or MoveTemp) to avoid copying it at all. */
+	static FQueryResultField MakeInteger(const int64 InValue) { return FQueryResultField(InValue); }
+	static FQueryResultField MakeFloat(const double InValue) { return FQueryResultField(InValue); }
+	static FQueryResultField MakeString(FString InValue) { return FQueryResultField(MoveTemp(InValue)); }
+	static FQueryResultField MakeBlob(TArray<uint8> InValue) { return FQueryResultField(MoveTemp(InValue)); }
 
 	/* The name of the database field */
 	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
@@ -56,33 +49,80 @@ struct FQueryResultField
 	FString ColName;
 
 	/* The actual type reported by the database */
-	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
-		meta = (DisplayName="SQLite Value Type"))
-	EDbValueType Type = EDbValueType::Null; 
+	EDbValueType GetType() const
+	{
+		/* The variant's types are declared in EDbValueType order. */
+		return static_cast<EDbValueType>(Value.GetIndex());
+	}
 
 	/* Convenience function to test for a DB NULL value.
 	 * Just makes the code look 'cleaner' */
-	FORCEINLINE bool IsNull() { return Type == EDbValueType::Null; }
-	
+	bool IsNull() const { return Value.IsType<FEmptyVariantState>(); }
+
+	/* Getters for the value. Integers and Floats are converted to each other,
+	 * any other conversion returns an empty value. */
+	int64 GetInteger() const
+	{
+		if (const int64* IntVal = Value.TryGet<int64>())
+			return *IntVal;
+		if (const double* DblVal = Value.TryGet<double>())
+			return static_cast<int64>(*DblVal);
+		return 0;
+	}
+
+	bool GetBool() const { return GetInteger() != 0; }
+
+	double GetFloat() const
+	{
+		if (const double* DblVal = Value.TryGet<double>())
+			return *DblVal;
+		if (const int64* IntVal = Value.TryGet<int64>())
+			return static_cast<double>(*IntVal);
+		return 0.0;
+	}
+
+	const FString& GetString() const
+	{
+		static const FString NoString;
+		const FString* StrVal = Value.TryGet<FString>();
+		return StrVal ? *StrVal : NoString;
+	}
+
+	const TArray<uint8>& GetBlob() const
+	{
+		static const TArray<uint8> NoBlob;
+		const TArray<uint8>* BlobVal = Value.TryGet<TArray<uint8>>();
+		return BlobVal ? *BlobVal : NoBlob;
+	}
+
+	/* Heap memory held by the field (its string or blob, and its column name). */
+	SIZE_T GetAllocatedSize() const
+	{
+		return ColName.GetAllocatedSize() + GetString().GetAllocatedSize() + GetBlob().GetAllocatedSize();
+	}
+
 	/* Depending on the underlying DB Type, returns the value as an FString.
 	 * Remember; it's only aware of the DATABASE type, not the range of c++ types
 	 * that you might eventually use it as. So even though the struct supports 'bool',
 	 * it isn't supported by this method.
 	 * (Intended *mainly* as debug helper, for log messages.) */
-	FString ToString()
+	FString ToString() const
 	{
-		switch (Type)
+		switch (GetType())
 		{
 		case EDbValueType::Integer:
-			return FString::Printf(TEXT("%lld"), IntVal);
+			return FString::Printf(TEXT("%lld"), GetInteger());
 		case EDbValueType::Float:
-			return FString::Printf(TEXT("%f"), DblVal);
+			return FString::Printf(TEXT("%f"), GetFloat());
 		case EDbValueType::String:
-			return StrVal;
+			return GetString();
 		default:
 			return TEXT("");
 		}
 	}
+
+private:
+	TVariant<int64, double, FString, TArray<uint8>, FEmptyVariantState> Value{TInPlaceType<FEmptyVariantState>()};
 };
 
 /* A row of data returned from a query. */
@@ -104,3 +144,123 @@ struct FQueryResult
 	UPROPERTY(BlueprintReadOnly, Category="Query Result|Rows")
 	TArray<FQueryResultRow> Rows;
 };
+
+/* A column of a columnar query result (see FColumnarQueryResult). */
+USTRUCT(BlueprintType)
+struct FQueryResultColumn
+{
+	GENERATED_BODY()
+
+	/* The name of the database field */
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
+		meta = (DisplayName="Column Name"))
+	FString Name;
+
+	/* The type of each row's value (sqlite types belong to values, not columns, so may differ between rows). */
+	TArray<EDbValueType> Types;
+
+	/* Each row's value: an Integer, the bits of a Float,
+	 * or the index of a String or Blob in the result's string/blob data. */
+	TArray<int64> Values;
+};
+
+/* Resultset of a select query, stored a column at a time.
+ * The column names are held once, rather than by every field, and each value takes 9 bytes
+ * (plus its text or blob data, packed end to end), rather than being a full FQueryResultField with its own allocations.
+ * Prefer it to FQueryResult for large results. In Blueprint, use the 'Columnar Result' functions of UGameDatabaseStatics. */
+USTRUCT(BlueprintType)
+struct SQLITEGAMEDB_API FColumnarQueryResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
+		meta = (DisplayName="Columns"))
+	TArray<FQueryResultColumn> Columns;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Query Result",
+		meta = (DisplayName="Row Count"))
+	int32 NumRows = 0;
+
+	/* Text of every String value, as UTF-8, end to end. */
+	TArray<UTF8CHAR> StringData;
+
+	/* Where each String value starts in StringData, plus a final entry for the end of the data. */
+	TArray<int32> StringOffsets = {0};
+
+	/* Data of every Blob value, end to end. */
+	TArray<uint8> BlobData;
+
+	/* Where each Blob value starts in BlobData, plus a final entry for the end of the data. */
+	TArray<int32> BlobOffsets = {0};
+
+	/* Returns the index of the named column (case-insensitive), or INDEX_NONE. */
+	int32 FindColumn(const FString& ColumnName) const;
+
+	/* Is this a valid row and column? */
+	bool IsValidCell(const int32 Row, const int32 Column) const
+	{
+		return Columns.IsValidIndex(Column) && Row >= 0 && Row < NumRows;
+	}
+
+	/* The type of a value, or Null for an invalid cell. */
+	EDbValueType GetType(const int32 Row, const int32 Column) const
+	{
+		return IsValidCell(Row, Column) ? Columns[Column].Types[Row] : EDbValueType::Null;
+	}
+
+	/* Getters for a value. Integers and Floats are converted to each other,
+	 * and to a String, any other conversion returns an empty value. */
+	int64 GetInteger(const int32 Row, const int32 Column) const;
+	double GetFloat(const int32 Row, const int32 Column) const;
+	FString GetString(const int32 Row, const int32 Column) const;
+
+	/* A view of a String value's text, without converting or copying it.
+	 * It stays valid until this result is changed or destroyed. */
+	FUtf8StringView GetStringView(const int32 Row, const int32 Column) const;
+
+	/* A view of a Blob value's data, without copying it.
+	 * It stays valid until this result is changed or destroyed. */
+	TConstArrayView<uint8> GetBlob(const int32 Row, const int32 Column) const;
+
+	/* Makes a value, or a whole row, in the form FQueryResult holds it. */
+	FQueryResultField GetField(const int32 Row, const int32 Column) const;
+	FQueryResultRow GetRow(const int32 Row) const;
+
+	/* Converts the whole result to an FQueryResult. */
+	FQueryResult ToQueryResult() const;
+
+	/* The memory allocated by this result, not counting the struct itself. */
+	SIZE_T GetAllocatedSize() const;
+
+	/* Used while reading a resultset: add each column, then the values of each row, column by column. */
+	void AddColumn(const FString& ColumnName);
+	void AddNull(const int32 Column);
+	void AddInteger(const int32 Column, const int64 Value);
+	void AddFloat(const int32 Column, const double Value);
+	void AddString(const int32 Column, const FUtf8StringView Value);
+	void AddBlob(const int32 Column, const TConstArrayView<uint8> Value);
+};
+
+/* Where a paged text search is up to (see UDbStatement::ExecuteTextSearch).
+ * Start with a default constructed page, and pass the same page back in to fetch each following page. */
+USTRUCT(BlueprintType)
+struct FDbTextSearchPage
+{
+	GENERATED_BODY()
+
+	/* Rank of the last row returned. */
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Text Search")
+	double LastRank = 0.0;
+
+	/* Rowid of the last row returned. */
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Text Search")
+	int64 LastRowId = 0;
+
+	/* Has a page been returned yet? */
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Text Search")
+	bool bStarted = false;
+
+	/* Has the last page been returned? */
+	UPROPERTY(BlueprintReadOnly, Category = "SQLite Database|Text Search")
+	bool bFinished = false;
+};
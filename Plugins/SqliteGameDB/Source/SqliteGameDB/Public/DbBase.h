@@ -9,6 +9,7 @@
 #include "SQLiteDatabase.h"
 #include "DbBase.generated.h"
 
+class AActor;
 struct FGameDbAttachment;
 class UDbStatement;
 class UPreparedStatementGroup;
@@ -37,6 +38,39 @@ public:
 		meta = (DisplayName="Get Database Filename"))
 	FString GetDbName() const;
 
+#pragma region Live Tables
+
+	/* Exposes an array of structs to SQL as a read-only table named TableName, with a column per reflected property,
+	 * so live game state can be joined against the database without first being copied into a temp table.
+	 * The rows are read from the array in place each time the table is queried, so they are always current.
+	 * If KeyPropertyName is given, 'WHERE Key = ...' only reads the key of each row, rather than every column.
+	 * NOTE: The array must outlive the table. Call UnregisterLiveTable before it is destroyed. */
+	template <typename T>
+	bool RegisterStructArrayTable(const FString TableName, const TArray<T>& Rows, const FName KeyPropertyName = NAME_None)
+	{
+		/* A TArray of reflected structs has the same layout as the FScriptArray used by reflection. */
+		return RegisterStructArrayTable(TableName, T::StaticStruct(), reinterpret_cast<const FScriptArray*>(&Rows),
+		                                KeyPropertyName);
+	}
+
+	/* Exposes the actors of a class in the current world to SQL as a read-only table named TableName.
+	 * The columns are ActorName, LocationX, LocationY and LocationZ, then a column per property flagged SaveGame.
+	 * The key is ActorName unless KeyPropertyName is given.
+	 * The table only sees the world it was registered in, so register it again after changing level.
+	 * NOTE: Actors can only be read on the game thread, so the table must only be queried from it. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Live Tables",
+		meta = (DisplayName="Register Actor Table", WorldContext="WorldContextObject"))
+	bool RegisterActorTable(const UObject* WorldContextObject, const FString TableName, TSubclassOf<AActor> ActorClass,
+	                        const FName KeyPropertyName = NAME_None);
+
+	/* Removes a table registered by RegisterStructArrayTable or RegisterActorTable.
+	 * Any prepared statement reading the table must be destroyed first. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Live Tables",
+		meta = (DisplayName="Unregister Live Table"))
+	bool UnregisterLiveTable(const FString TableName);
+
+#pragma endregion
+
 protected:
 	/* Default DB Schema name. */
 	const FString SchemaMain = TEXT("MAIN");
@@ -72,5 +106,12 @@ protected:
 
 	
 private:
+	/* Registers the SQL functions available to every game database:
+	 * dist3, within_box, guid_parse and guid_format. */
+	void RegisterBuiltinFunctions() const;
+
+	bool RegisterStructArrayTable(const FString& TableName, const UScriptStruct* RowStruct, const FScriptArray* Rows,
+	                              const FName KeyPropertyName);
+
 	GENERATED_BODY()
 };
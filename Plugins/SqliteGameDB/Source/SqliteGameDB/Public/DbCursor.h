@@ -0,0 +1,94 @@
+﻿/* © Copyright 2022 Graham Chabas, All Rights Reserved. */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DBSupport.h"
+#include "SQLitePreparedStatement.h"
+
+/* Steps a prepared statement one row at a time, reading each row's values in place,
+ * so a resultset can be walked (or abandoned part way) without first being copied into an FQueryResult.
+ *
+ *   for (const FDbCursor& Row : Statement->OpenCursor())
+ *   {
+ *       const int64 Id = Row.GetInteger(0);
+ *       ...
+ *   }
+ *
+ * The statement is 'reset' when the cursor is destroyed. Any bound parameters are left as they are.
+ * NOTE: Only one cursor may be open on a statement at a time, and the statement must outlive it. */
+class SQLITEGAMEDB_API FDbCursor
+{
+public:
+	explicit FDbCursor(FSQLitePreparedStatement* InStatement);
+	~FDbCursor();
+
+	/* Move-only, as only one cursor may step a statement. */
+	FDbCursor(FDbCursor&& Other);
+	FDbCursor& operator=(FDbCursor&& Other);
+	FDbCursor(const FDbCursor&) = delete;
+	FDbCursor& operator=(const FDbCursor&) = delete;
+
+	/* Steps to the next row. Returns false once there are no more rows (or an error occurs). */
+	bool Next();
+
+	/* Is the cursor on a row? */
+	bool HasRow() const { return bHasRow; }
+
+	/* Column names are available once the first row has been stepped to. */
+	int32 NumColumns() const;
+	const FString& GetColumnName(const int32 Column) const;
+
+	/* Returns the index of the named column (case-insensitive), or INDEX_NONE. */
+	int32 GetColumnIndex(const FString& ColumnName) const;
+
+	/* Getters for a value of the current row, converted as sqlite converts them. */
+	EDbValueType GetType(const int32 Column) const;
+	bool IsNull(const int32 Column) const { return GetType(Column) == EDbValueType::Null; }
+	int64 GetInteger(const int32 Column) const;
+	bool GetBool(const int32 Column) const { return GetInteger(Column) != 0; }
+	double GetFloat(const int32 Column) const;
+	FString GetString(const int32 Column) const;
+	TArray<uint8> GetBlob(const int32 Column) const;
+
+	/* Any type FSQLitePreparedStatement can read a column as (FDateTime, FGuid, FName, enums...).
+	 * Returns false if the column doesn't exist. */
+	template <typename T>
+	bool GetValue(const int32 Column, T& OutValue) const
+	{
+		return bHasRow && Statement->GetColumnValueByIndex(Column, OutValue);
+	}
+
+	/* Views of a value's text or data, without converting or copying it.
+	 * They stay valid until the cursor moves on, or the value is read as another type. */
+	FUtf8StringView GetStringView(const int32 Column) const;
+	TArrayView<const uint8> GetBlobView(const int32 Column) const;
+
+	/* Makes a value, or the whole row, in the form FQueryResult holds it. */
+	FQueryResultField GetField(const int32 Column) const;
+	FQueryResultRow GetRow() const;
+
+	/* Range-for support: the loop steps the cursor, and gives the cursor itself as each row. */
+	struct FIterator
+	{
+		FDbCursor* Cursor;
+
+		const FDbCursor& operator*() const { return *Cursor; }
+		void operator++() { Cursor->Next(); }
+		bool operator!=(const FIterator& Other) const
+		{
+			return (Cursor && Cursor->bHasRow) != (Other.Cursor && Other.Cursor->bHasRow);
+		}
+	};
+
+	/* Steps to the first row, unless the cursor has already been stepped. */
+	FIterator begin();
+	FIterator end() { return FIterator{nullptr}; }
+
+private:
+	/* Resets the statement, and detaches the cursor from it. */
+	void Close();
+
+	FSQLitePreparedStatement* Statement = nullptr;
+	bool bStarted = false;
+	bool bHasRow  = false;
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "DbBase.h"
+#include "DbCursor.h"
 #include "DBSupport.h"
 #include "SQLiteDatabase.h"
 #include "UObject/Object.h"
@@ -11,6 +12,29 @@
 
 class UGameDbBase;
 class FSQLitePreparedStatement;
+struct FDbHydrationPlan;
+
+/* A parameter of a UDbStatement, resolved to its binding index.
+ * Resolve it once with UDbStatement::GetParamHandle, then reuse it to bind values
+ * (e.g. once per row in a save loop) without any look-up by name. */
+struct FDbParamHandle
+{
+	/* The binding index of the parameter, or 0 if the parameter was not found. */
+	int32 Index = 0;
+
+	bool IsValid() const { return Index > 0; }
+};
+
+/* One column of a columnar parameter buffer, for UDbStatement::ExecuteActionBatch.
+ * Holds the values of a single parameter, one value per execution of the statement. */
+struct FDbParamColumn
+{
+	/* Name of the parameter the values are bound to, e.g. "@InstanceID". */
+	FString BindingName;
+
+	/* The value to bind for each execution; every column in a batch must hold the same number of values. */
+	TArray<FQueryResultField> Values;
+};
 
 /* Further wraps FSQLitePreparedStatement, providing useful management and utility functions. */
 UCLASS(BlueprintType)
@@ -55,9 +79,35 @@ public:
 	                     const bool    bCopy = true);
 	bool SetBindingValue(const FString InBindingName, const FGuid& InValue);
 
+	/* Set the given binding to an array of values, for use with the carray table-valued function,
+	 * eg: "SELECT * FROM EquipmentInstance WHERE InstanceID IN carray(@Ids)".
+	 * A whole IN-list is bound to a single parameter, so one statement serves lists of any length. */
+	bool SetBindingArray(const FString InBindingName, TConstArrayView<int64> InValues);
+	bool SetBindingArray(const FString InBindingName, TConstArrayView<FString> InValues);
+	bool SetBindingArray(const FString InBindingName, TConstArrayView<FGuid> InValues);
+
 	/* Set the given null binding from its name or index. */
 	bool SetBindingValueToNull(const FString InBindingName);
 
+	/* Resolves the named parameter to a handle, which can be reused to bind values to this statement by index.
+	 * The handle is only valid for this statement. */
+	FDbParamHandle GetParamHandle(const FString& InBindingName) const;
+
+	/* Set the given binding from a resolved parameter handle.
+	 * Accepts any value type supported by the by-name overloads above. */
+	template <typename T>
+	bool SetBindingValue(const FDbParamHandle InParam, const T& InValue)
+	{
+		return PreparedStatement->SetBindingValueByIndex(InParam.Index, InValue);
+	}
+
+	bool SetBindingValue(const FDbParamHandle InParam, const void* InBlobData, const int32 InBlobDataSizeBytes,
+	                     const bool           bCopy = true);
+	bool SetBindingValueToNull(const FDbParamHandle InParam);
+	bool SetBindingArray(const FDbParamHandle InParam, TConstArrayView<int64> InValues);
+	bool SetBindingArray(const FDbParamHandle InParam, TConstArrayView<FString> InValues);
+	bool SetBindingArray(const FDbParamHandle InParam, TConstArrayView<FGuid> InValues);
+
 #pragma endregion
 
 #pragma region Blueprint Parameter Bindings
@@ -96,12 +146,37 @@ public:
 		meta = (DisplayName="Execute Action Query"))
 	bool ExecuteAction();
 
+	/* Runs an 'action' query once per row of a columnar parameter buffer, binding
+	 * the Nth value of each column for the Nth execution. All rows run inside a single
+	 * transaction (nested in the current one, if any), so they are applied all or nothing.
+	 * Returns true if every row was executed, false if an error occurs.
+	 * NOTE: Bindings are cleared afterwards. */
+	bool ExecuteActionBatch(const TArray<FDbParamColumn>& ParamColumns);
+
 	/* Executes a prepared statement that retrieves data.
 	 * Returns the value contained in the first field of the first row in the resultset. */
 	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
 		meta = (DisplayName="Execute Scalar Query"))
 	FQueryResultField ExecuteScalar();
 
+	/* Executes a prepared statement that retrieves data, and returns the first field of the first row
+	 * as an integer, or DefaultValue if there are no rows or the field is NULL.
+	 * Only the first row is stepped to, and no FQueryResultField is made. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Scalar Integer Query"))
+	int64 ExecuteScalarInt64(const int64 DefaultValue = 0);
+
+	/* As ExecuteScalarInt64, returning the field as a string. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Scalar String Query"))
+	FString ExecuteScalarString(const FString& DefaultValue = TEXT(""));
+
+	/* Executes a prepared statement that retrieves data, and returns true if it returns any row.
+	 * Only the first row is stepped to, and none of its fields are read. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Exists Query"))
+	bool ExecuteExists();
+
 	/* Executes a prepared statement and returns any resultant data.
 	This overload takes a pointer to the prepared statement you wish to run.
 	The statement is 'reset' AFTER executing it. Any bound parameters are left as they are. */
@@ -109,6 +184,60 @@ public:
 		meta = (DisplayName="Execute Resultset Query"))
 	FQueryResult ExecuteSelect();
 
+	/* Executes a prepared statement and returns any resultant data, stored a column at a time,
+	 * which takes a fraction of the memory and allocations of ExecuteSelect for large results.
+	 * The statement is 'reset' AFTER executing it. Any bound parameters are left as they are. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Columnar Resultset Query"))
+	FColumnarQueryResult ExecuteSelectColumnar();
+
+	/* Executes a prepared statement, returning a cursor that steps through the resultset one row at a time,
+	 * rather than copying every row first (see FDbCursor). Use it for large scans, and loops that stop early.
+	 * The statement is 'reset' when the cursor is destroyed. Any bound parameters are left as they are. */
+	FDbCursor OpenCursor();
+
+#pragma region Spatial Queries
+
+	/* Runs a statement created by UPreparedStatementManager::CreateSpatialBoxStatement,
+	 * returning the rows whose location lies inside (or on the edge of) the box. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Spatial Box Query"))
+	FQueryResult ExecuteSelectInBox(const FBox& Box);
+
+	/* Runs a statement created by UPreparedStatementManager::CreateSpatialRadiusStatement,
+	 * returning the rows whose location lies within Radius of Center, nearest first. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Spatial Radius Query"))
+	FQueryResult ExecuteSelectInRadius(const FVector& Center, const double Radius);
+
+	/* Runs a statement created by UPreparedStatementManager::CreateSpatialRadiusStatement,
+	 * returning (up to) the Count rows whose location is nearest to Center, nearest first.
+	 * The search starts at SearchRadius, and doubles until Count rows are found or MaxSearchRadius is reached,
+	 * so a SearchRadius close to the expected distance of the Nth row keeps the search cheap. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Spatial Nearest Query"))
+	FQueryResult ExecuteSelectNearest(const FVector& Center, const int32 Count, const double SearchRadius = 1000.0,
+	                                  const double MaxSearchRadius = 100000.0);
+
+#pragma endregion
+
+#pragma region Text Search
+
+	/* Runs a statement created by UPreparedStatementManager::CreateTextSearchStatement,
+	 * returning the next page (of up to PageSize rows) matching the query, best match first.
+	 * Page records where the search is up to: pass a new page for the first page, then the same one for each page after.
+	 * Unless bRawQuery is set, each word of the query is matched as a prefix (so "iron swo" finds "Iron Sword"),
+	 * otherwise the query is passed to FTS5 as is, allowing its full syntax (AND, OR, NOT, NEAR, "phrases", column:filters). */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Prepared Statement",
+		meta = (DisplayName="Execute Text Search"))
+	FQueryResult ExecuteTextSearch(const FString& Query, UPARAM(ref) FDbTextSearchPage& Page,
+	                               const int32 PageSize = 20, const bool bRawQuery = false);
+
+	/* Converts text typed by a player into an FTS5 query, matching each word as a prefix. */
+	static FString MakeTextSearchQuery(const FString& Text);
+
+#pragma endregion
+
 #pragma region Extended Functions
 
 	/* Executes a resultset-returning prepared statement, creates a new instance of an
@@ -153,6 +282,9 @@ public:
 		}
 	}
 
+	/* The plan this statement last used to fill the given type, if any (see FDbHydrationPlan). */
+	TSharedPtr<const FDbHydrationPlan> FindHydrationPlan(const UStruct* Type) const;
+
 	template <class T>
 	T* SpawnActorFromData()
 	{
@@ -199,8 +331,41 @@ private:
 	 * Each row of returned data will become an object. */
 	void ReadIntoObjectArray(TArray<UObject*>* ArrayToFill, UClass* ObjectClass);
 
-	/* Utility function to set a property value on a given object using reflection. */
-	void SetPropertyValue(UObject* ObjectToFill, FProperty* PropertyToSet, FQueryResultField Value) const;
+	/* Binds the box (and, for radius queries, the sphere and row limit) searched by a spatial query. */
+	void SetSpatialBindings(const FBox& Box);
+	void SetSpatialBindings(const FVector& Center, const double Radius, const int32 Count);
+
+	/* Parameters of the statements created by UPreparedStatementManager's spatial statement functions. */
+	const FString P_MinX    = TEXT("@MinX");
+	const FString P_MinY    = TEXT("@MinY");
+	const FString P_MinZ    = TEXT("@MinZ");
+	const FString P_MaxX    = TEXT("@MaxX");
+	const FString P_MaxY    = TEXT("@MaxY");
+	const FString P_MaxZ    = TEXT("@MaxZ");
+	const FString P_CenterX = TEXT("@CenterX");
+	const FString P_CenterY = TEXT("@CenterY");
+	const FString P_CenterZ = TEXT("@CenterZ");
+	const FString P_Radius  = TEXT("@Radius");
+	const FString P_Count   = TEXT("@Count");
+
+	/* Text search parameter names. */
+	const FString P_Query      = TEXT("@Query");
+	const FString P_AfterRank  = TEXT("@AfterRank");
+	const FString P_AfterRowId = TEXT("@AfterRowId");
+	const FString P_PageSize   = TEXT("@PageSize");
+
+	/* Binds a single untyped value to the parameter at the given index, according to its database type. */
+	bool SetBindingValueFromField(const int32 InBindingIndex, const FQueryResultField& InValue) const;
+
+	/* Plans for filling each type read by this statement from its columns (see FDbHydrationPlan). */
+	TMap<TWeakObjectPtr<const UStruct>, TSharedPtr<const FDbHydrationPlan>> HydrationPlans;
+
+	/* The re-prepare count of the statement the plans were built for; they are all dropped once it changes. */
+	int32 HydrationPlansReprepareCount = 0;
+
+	/* Gets (building on first use, or when the columns have changed) the plan for filling the given class or struct
+	 * from this statement's columns. Only call it once the statement has been stepped to a row. */
+	const FDbHydrationPlan& GetHydrationPlan(const UStruct* Type);
 
 	GENERATED_BODY()
 };
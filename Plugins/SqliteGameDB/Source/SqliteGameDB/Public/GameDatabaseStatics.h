@@ -75,6 +75,71 @@ public:
 	                                 const AActor* Actor,
 	                                 const FString& RotationFieldNameBase = TEXT("Rotation"));
 
+#pragma region Query Result Fields
+
+	/* The type of a query result field's value. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field Value Type"))
+	static EDbValueType GetFieldType(const FQueryResultField& Field);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Is Field Null"))
+	static bool IsFieldNull(const FQueryResultField& Field);
+
+	/* Values of a query result field. Integers and Floats are converted to each other,
+	 * any other conversion returns an empty value. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field Integer Value"))
+	static int64 GetFieldInteger(const FQueryResultField& Field);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field Bool Value"))
+	static bool GetFieldBool(const FQueryResultField& Field);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field Float Value"))
+	static double GetFieldFloat(const FQueryResultField& Field);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field String Value"))
+	static FString GetFieldString(const FQueryResultField& Field);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Query Result", meta = (DisplayName="Field Blob Value"))
+	static TArray<uint8> GetFieldBlob(const FQueryResultField& Field);
+
+#pragma endregion
+
+#pragma region Columnar Results
+
+	/* The number of rows in a columnar query result. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Row Count"))
+	static int32 GetColumnarRowCount(const FColumnarQueryResult& Result);
+
+	/* The index of the named column in a columnar query result, or -1 if there is no such column.
+	 * Look the index up once, then use it for every row. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Column Index"))
+	static int32 GetColumnarColumnIndex(const FColumnarQueryResult& Result, const FString& ColumnName);
+
+	/* The type of a value in a columnar query result (Null for an invalid row or column). */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Value Type"))
+	static EDbValueType GetColumnarValueType(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	/* Values of a columnar query result. Integers and Floats are converted to each other, and to a String. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Integer Value"))
+	static int64 GetColumnarInteger(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Bool Value"))
+	static bool GetColumnarBool(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Float Value"))
+	static double GetColumnarFloat(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar String Value"))
+	static FString GetColumnarString(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Blob Value"))
+	static TArray<uint8> GetColumnarBlob(const FColumnarQueryResult& Result, const int32 Row, const int32 Column);
+
+	/* A row of a columnar query result, in the form returned by 'Execute Resultset Query'. */
+	UFUNCTION(BlueprintPure, Category = "SQLite Database|Columnar Result", meta = (DisplayName="Columnar Row"))
+	static FQueryResultRow GetColumnarRow(const FColumnarQueryResult& Result, const int32 Row);
+
+#pragma endregion
+
 private:
 	GENERATED_BODY()
 };
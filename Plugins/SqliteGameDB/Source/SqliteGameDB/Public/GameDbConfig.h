@@ -29,6 +29,10 @@ struct SQLITEGAMEDB_API FGameDbAttachment
 
 	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File|Attachment")
 	EDbFilePurpose Purpose = EDbFilePurpose::None;
+
+	// Share of the page cache memory budget (in KiB) this attachment may hold on to, or 0 to use the SQLite default
+	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File|Attachment", meta = (ClampMin = 0))
+	int32 CacheSizeKiB = 0;
 };
 
 USTRUCT(BlueprintType, Category = "SqliteGameDB")
@@ -46,6 +50,22 @@ struct SQLITEGAMEDB_API FGameDbConfig
 
 	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File")
 	TArray<FGameDbAttachment> Attachments;
+
+	// Open the database read-only, for static content that can be cooked (compressed) into the pak rather than staged as a loose file
+	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File")
+	bool bReadOnly = false;
+
+	// Load the whole database file into memory with a single read when it is opened; changes are NOT written back to the file
+	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File")
+	bool bLoadIntoMemory = false;
+
+	// Share of the page cache memory budget (in KiB) this database may hold on to, or 0 to use the SQLite default
+	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File", meta = (ClampMin = 0))
+	int32 CacheSizeKiB = 0;
+
+	// The connection is only ever used from the game thread, so SQLite can skip locking the connection on every call
+	UPROPERTY(config, EditAnywhere, Category = "Sqlite Database File")
+	bool bGameThreadOnly = false;
 };
 
 
@@ -139,8 +139,17 @@ private:
 	/* Path to the working copy, always the same path, although the file changes. */
 	FString WorkingCopyPlayDbPath;
 
+	/* Page cache shares (in KiB) of the log and play databases, from their attachment settings. */
+	int32 LogCacheSizeKiB = 0;
+	int32 PlayCacheSizeKiB = 0;
+
+	void SetSchemaCacheSize(const FString& SchemaName, int32 CacheSizeKiB) const;
+
 	int32 CreatePlayDbFromSource(FString Source, FString Title, FString Additional, EPlayDbPurpose Purpose);
 
+	/* Reads the log entries returned by the ListLogFiles or ListLogFilesPaged statement. */
+	TArray<FLogInfo> ReadLogEntries(UDbStatement* Statement) const;
+
 	bool FindAttachmentOfType(TArray<FGameDbAttachment>& Source, EDbFilePurpose Purpose,
 	                          FGameDbAttachment& OutAttachment) const;
 
@@ -178,6 +187,10 @@ private:
 	const FString LOG_CleanLog = TEXT("CleanLog");
 	const FString PLAY_CleanPlay = TEXT("CleanPlay");
 
+	/* Journaling of the working copy playdb. */
+	const FString Q_PlayJournalModeWal = TEXT("PRAGMA PLAY.journal_mode = WAL;");
+	const FString Q_PlayWalCheckpoint = TEXT("PRAGMA PLAY.wal_checkpoint(TRUNCATE);");
+
 
 	GENERATED_BODY()
 };
@@ -113,6 +113,11 @@ public:
 		meta = (DisplayName="Execute Temporary Select Query"))
 	FQueryResult RunTempSelectQuery(const FString SqlToRun) const;
 
+	/* As RunTempSelectQuery, but returns the data stored a column at a time (see FColumnarQueryResult). */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Execute Temporary Columnar Select Query"))
+	FColumnarQueryResult RunTempSelectQueryColumnar(const FString SqlToRun) const;
+
 	/* Executes an SQL select statement and returns the value contained
 	 * in the first field of the first row in the resultset.
 	 * To do this it creates a PreparedStatement which it disposes of immediately.
@@ -140,6 +145,69 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
 		meta = (DisplayName="Rollback Transaction"))
 	void RollbackTransaction();
+
+	/* Creates an R*Tree spatial index over the location of each row of a table, held in the
+	 * columns <ColumnPrefix>X, <ColumnPrefix>Y and <ColumnPrefix>Z (e.g. LocationX/Y/Z).
+	 * The index is filled from the existing rows, and triggers keep it up to date as rows are inserted, moved and deleted.
+	 * Rows with a NULL coordinate are not indexed.
+	 * NOTE: An INSERT OR REPLACE that replaces a row with a different rowid only removes the old
+	 * row from the index when recursive triggers are enabled (PRAGMA recursive_triggers).
+	 * Returns true if the index was created (or already existed). */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Create Spatial Index"))
+	bool CreateSpatialIndex(const FString TableName, const FString ColumnPrefix = TEXT("Location")) const;
+
+	/* Removes a spatial index created by CreateSpatialIndex, along with its triggers.
+	 * Returns true if the index no longer exists. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Drop Spatial Index"))
+	bool DropSpatialIndex(const FString TableName, const FString ColumnPrefix = TEXT("Location")) const;
+
+	/* Creates a statement (in the default group) returning the rows of a table whose location lies inside a box,
+	 * searched through the table's spatial index (see CreateSpatialIndex).
+	 * Run it with UDbStatement::ExecuteSelectInBox. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Create Spatial Box Statement"))
+	UDbStatement* CreateSpatialBoxStatement(const FString StatementName, const FString TableName,
+	                                        const FString ColumnPrefix = TEXT("Location"));
+
+	/* Creates a statement (in the default group) returning the rows of a table whose location lies within a radius,
+	 * nearest first, searched through the table's spatial index (see CreateSpatialIndex).
+	 * Each row has an extra 'SpatialDistance' column, holding its distance from the center.
+	 * Run it with UDbStatement::ExecuteSelectInRadius or UDbStatement::ExecuteSelectNearest. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Create Spatial Radius Statement"))
+	UDbStatement* CreateSpatialRadiusStatement(const FString StatementName, const FString TableName,
+	                                           const FString ColumnPrefix = TEXT("Location"));
+
+	/* Creates an FTS5 full-text index over the given text columns of a table (e.g. Equipment.Description).
+	 * The index holds no copy of the text (it reads it from the table when needed), is filled from the existing rows,
+	 * and triggers keep it up to date as rows are inserted, edited and deleted.
+	 * The index is a table named <TableName>_fts, in the same schema as the table.
+	 * Returns true if the index was created (or already existed). */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Create Text Index"))
+	bool CreateTextIndex(const FString TableName, const TArray<FString>& ColumnNames,
+	                     const FString SchemaName = TEXT("main")) const;
+
+	/* Removes a full-text index created by CreateTextIndex, along with its triggers.
+	 * Returns true if the index no longer exists. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Drop Text Index"))
+	bool DropTextIndex(const FString TableName, const FString SchemaName = TEXT("main")) const;
+
+	/* Creates a statement (in the default group) returning the rows of a table that match a full-text query,
+	 * best match first, searched through the table's text index (see CreateTextIndex).
+	 * Each row has three extra columns: 'SearchRowId', 'SearchRank' (its bm25 score, lower is better),
+	 * and 'SearchSnippet' (an extract of the best matching column, with each match wrapped in the highlight markers).
+	 * Run it with UDbStatement::ExecuteTextSearch. */
+	UFUNCTION(BlueprintCallable, Category = "SQLite Database|Statement Manager",
+		meta = (DisplayName="Create Text Search Statement"))
+	UDbStatement* CreateTextSearchStatement(const FString StatementName, const FString TableName,
+	                                        const FString SchemaName = TEXT("main"),
+	                                        const FString HighlightStart = TEXT("<Highlight>"),
+	                                        const FString HighlightEnd = TEXT("</>"),
+	                                        const int32 SnippetTokens = 16);
 	
 private:
 	TWeakObjectPtr<UDbBase> Db = nullptr;
@@ -159,6 +227,23 @@ private:
 		"SELECT name FROM pragma_database_list WHERE name NOT IN ('main', 'temp') order by name");
 	const FString Q_SchemaExists = TEXT("SELECT count(*) FROM pragma_database_list WHERE name = @SchemaName");
 
+	/* Name of the R*Tree table holding the spatial index of a table's location columns. */
+	static FString GetSpatialIndexName(const FString& TableName, const FString& ColumnPrefix);
+
+	/* Returns the WHERE clause of a spatial statement, which searches the index (aliased R) for the box
+	 * bound to @MinX..@MaxZ, then filters the rows of the table (aliased T) by their exact location. */
+	static FString GetSpatialBoxCondition(const FString& ColumnPrefix);
+
+	/* Name of the FTS5 table holding the full-text index of a table. */
+	static FString GetTextIndexName(const FString& TableName);
+
+	/* Wraps a table, column, schema or trigger name in double quotes (doubling any quote inside it),
+	 * so it can be pasted into SQL whatever characters it holds. */
+	static FString QuoteIdentifier(const FString& Identifier);
+
+	/* Runs each statement in turn, inside a savepoint, so they are applied all or nothing. */
+	bool ExecuteInSavepoint(const TArray<FString>& SqlStatements) const;
+
 	const FString P_DbFileName = TEXT("@DbFileName");
 	const FString P_SchemaName = TEXT("@SchemaName");
 
@@ -12,4 +12,10 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	/* Flush the cached hydration plans (see FDbHydrationPlan) when classes are reinstanced or reloaded. */
+	FDelegateHandle ObjectsReinstancedHandle;
+	FDelegateHandle ReloadCompleteHandle;
+	FDelegateHandle ReloadReinstancingCompleteHandle;
 };
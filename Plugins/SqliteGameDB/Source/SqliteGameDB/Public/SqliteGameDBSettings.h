@@ -20,6 +20,10 @@ public:
 	UPROPERTY(config, EditAnywhere, Category = "Configuration")
 	TArray<FGameDbConfig> DatabaseConnectionClasses;
 
+	/* Memory budget (in MiB) shared by the page caches of every database; each database takes its share via its CacheSizeKiB */
+	UPROPERTY(config, EditAnywhere, Category = "Configuration", meta = (ClampMin = 1))
+	int32 PageCacheBudgetMiB = 64;
+
 private:
 		GENERATED_BODY()
 
@@ -28,8 +28,8 @@ bool UTutorialDataAccessLayer::IsLevelManaged(FString LevelName)
 	{
 		Statement->SetBindingValue(P_LevelName, LevelName);
 
-		FQueryResultField Result = Statement->ExecuteScalar();
-		return Result.BoolVal;
+		/* The query returns the count of matching levels, so there is always a row. */
+		return Statement->ExecuteScalarInt64() != 0;
 	}
 	return false;
 }
@@ -40,8 +40,7 @@ int32 UTutorialDataAccessLayer::GetLevelID(FString LevelName)
 	{
 		Statement->SetBindingValue(P_LevelName, LevelName);
 
-		FQueryResultField Result = Statement->ExecuteScalar();
-		return Result.IntVal;
+		return Statement->ExecuteScalarInt64(-1);
 	}
 	return -1;
 }
@@ -65,7 +64,7 @@ int32 UTutorialDataAccessLayer::LoadEquipmentItem(FString InstanceID, int32 Leve
 	{
 		PsLoad->SetBindingValue(P_InstanceID, InstanceID);
 		PsLoad->SetBindingValue(P_LevelID, LevelID);
-		return PsLoad->ExecuteScalar().IntVal;
+		return PsLoad->ExecuteScalarInt64(-1);
 	}
 	return -1;
 }
@@ -84,13 +83,12 @@ int32 UTutorialDataAccessLayer::TestUserLogin(FString UserName, FString Password
 		Statement->SetBindingValue(P_PasswordHash, HashPassword(Password));
 
 		/* Execute the query, and get the first column of the first row returned.
-		   The query returns the count of users matching the username,
-		   with password hashes matching the password.
-		   This should only ever be either 0 or 1. */
-		FQueryResultField Result = Statement->ExecuteScalar();
+		   The query returns the UserID of the user matching the username,
+		   with a password hash matching the password, or no row at all. */
+		const int64 UserID = Statement->ExecuteScalarInt64(-1);
 
-		/* Is there was a null value, it means the login fails*/
-		return (Result.IsNull() || Result.IntVal == 0) ? -1 : Result.IntVal;
+		/* If there was no row, or a null value, it means the login fails */
+		return UserID == 0 ? -1 : UserID;
 	}
 	return -1;
 }
@@ -117,7 +115,7 @@ int32 UTutorialDataAccessLayer::CreateUserAccount(FString UserName, FString Pass
 		   This should either a valid UserID, or null if no record was inserted. */
 		FQueryResultField Result = Statement->ExecuteScalar();
 
-		return Result.IsNull() ? -1 : Result.IntVal;
+		return Result.IsNull() ? -1 : Result.GetInteger();
 	}
 	return -1;
 }
@@ -208,7 +206,7 @@ bool UTutorialDataAccessLayer::IsUserNameInUse(FString UserName, int32 UserID)
 		   indicating the name *IS* in use (even if it isn't).
 		   This is an unlikely occurrence, but means any method relying on the result
 		   will assume the tame is taken and not try to use it. */
-		return Result.IsNull() ? true : Result.BoolVal;
+		return Result.IsNull() ? true : Result.GetBool();
 	}
 	return true;
 }